@@ -0,0 +1,364 @@
+
+// Generated by rflb::BinaryCodeGenerator - do not edit
+
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <rflb/TypeDatabase.h>
+#include <rflb/SerialiseBinary.h>
+#include <iostream>
+
+
+namespace
+{
+	// Fields and base types that use the runtime serialiser
+	const rflb::Field* g_Fields[12];
+
+
+	void SaveBinary_TestVector(std::ostream& stream, u32, const void* data);
+	void LoadBinary_TestVector(std::istream& stream, u32, void* data);
+	void SaveBinary_Values(std::ostream& stream, u32, const void* data);
+	void LoadBinary_Values(std::istream& stream, u32, void* data);
+	void SaveBinary_Arrays(std::ostream& stream, u32, const void* data);
+	void LoadBinary_Arrays(std::istream& stream, u32, void* data);
+	void SaveBinary_Vectors(std::ostream& stream, u32, const void* data);
+	void LoadBinary_Vectors(std::istream& stream, u32, void* data);
+	void SaveBinary_Maps(std::ostream& stream, u32, const void* data);
+	void LoadBinary_Maps(std::istream& stream, u32, void* data);
+	void SaveBinary_TestData(std::ostream& stream, u32, const void* data);
+	void LoadBinary_TestData(std::istream& stream, u32, void* data);
+	void SaveBinary_TestBase(std::ostream& stream, u32, const void* data);
+	void LoadBinary_TestBase(std::istream& stream, u32, void* data);
+	void SaveBinary_TestDerived(std::ostream& stream, u32, const void* data);
+	void LoadBinary_TestDerived(std::istream& stream, u32, void* data);
+
+
+	void SaveBinary_TestVector(std::ostream& stream, u32, const void* data)
+	{
+		const TestVector& object = *(const TestVector*)data;
+		(void)object;
+		stream.write((const char*)&object.x, sizeof(object.x));
+		stream.write((const char*)&object.y, sizeof(object.y));
+	}
+
+
+	void LoadBinary_TestVector(std::istream& stream, u32, void* data)
+	{
+		TestVector& object = *(TestVector*)data;
+		(void)object;
+		stream.read((char*)&object.x, sizeof(object.x));
+		stream.read((char*)&object.y, sizeof(object.y));
+	}
+
+
+	void SaveBinary_Values(std::ostream& stream, u32, const void* data)
+	{
+		const Values& object = *(const Values*)data;
+		(void)object;
+		stream.write((const char*)&object.int_value, sizeof(object.int_value));
+		stream.write((const char*)&object.char_value, sizeof(object.char_value));
+		stream.write((const char*)&object.float_value, sizeof(object.float_value));
+		stream.write((const char*)&object.short_value, sizeof(object.short_value));
+		SaveBinary_TestVector(stream, 0, &object.embedded_pod);
+		stream.write((const char*)&object.double_value, sizeof(object.double_value));
+		serialise::SaveBinaryField(stream, &object, *g_Fields[0]);
+	}
+
+
+	void LoadBinary_Values(std::istream& stream, u32, void* data)
+	{
+		Values& object = *(Values*)data;
+		(void)object;
+		stream.read((char*)&object.int_value, sizeof(object.int_value));
+		stream.read((char*)&object.char_value, sizeof(object.char_value));
+		stream.read((char*)&object.float_value, sizeof(object.float_value));
+		stream.read((char*)&object.short_value, sizeof(object.short_value));
+		LoadBinary_TestVector(stream, 0, &object.embedded_pod);
+		stream.read((char*)&object.double_value, sizeof(object.double_value));
+		serialise::LoadBinaryField(stream, &object, *g_Fields[0]);
+	}
+
+
+	void SaveBinary_Arrays(std::ostream& stream, u32, const void* data)
+	{
+		const Arrays& object = *(const Arrays*)data;
+		(void)object;
+		serialise::SaveBinaryField(stream, &object, *g_Fields[1]);
+		rflb::StreamWrite(stream, (int)(sizeof(object.int_array) / sizeof(object.int_array[0])));
+		stream.write((const char*)object.int_array, sizeof(object.int_array));
+		rflb::StreamWrite(stream, (int)(sizeof(object.char_array) / sizeof(object.char_array[0])));
+		stream.write((const char*)object.char_array, sizeof(object.char_array));
+		rflb::StreamWrite(stream, (int)(sizeof(object.float_array) / sizeof(object.float_array[0])));
+		stream.write((const char*)object.float_array, sizeof(object.float_array));
+		rflb::StreamWrite(stream, (int)(sizeof(object.short_array) / sizeof(object.short_array[0])));
+		stream.write((const char*)object.short_array, sizeof(object.short_array));
+		rflb::StreamWrite(stream, (int)(sizeof(object.double_array) / sizeof(object.double_array[0])));
+		stream.write((const char*)object.double_array, sizeof(object.double_array));
+		serialise::SaveBinaryField(stream, &object, *g_Fields[2]);
+	}
+
+
+	void LoadBinary_Arrays(std::istream& stream, u32, void* data)
+	{
+		Arrays& object = *(Arrays*)data;
+		(void)object;
+		serialise::LoadBinaryField(stream, &object, *g_Fields[1]);
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.int_array[0])))
+				return;
+			RFLB_ASSERT(count >= 0 && count * sizeof(object.int_array[0]) <= sizeof(object.int_array));
+			stream.read((char*)object.int_array, count * sizeof(object.int_array[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.char_array[0])))
+				return;
+			RFLB_ASSERT(count >= 0 && count * sizeof(object.char_array[0]) <= sizeof(object.char_array));
+			stream.read((char*)object.char_array, count * sizeof(object.char_array[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.float_array[0])))
+				return;
+			RFLB_ASSERT(count >= 0 && count * sizeof(object.float_array[0]) <= sizeof(object.float_array));
+			stream.read((char*)object.float_array, count * sizeof(object.float_array[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.short_array[0])))
+				return;
+			RFLB_ASSERT(count >= 0 && count * sizeof(object.short_array[0]) <= sizeof(object.short_array));
+			stream.read((char*)object.short_array, count * sizeof(object.short_array[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.double_array[0])))
+				return;
+			RFLB_ASSERT(count >= 0 && count * sizeof(object.double_array[0]) <= sizeof(object.double_array));
+			stream.read((char*)object.double_array, count * sizeof(object.double_array[0]));
+		}
+		serialise::LoadBinaryField(stream, &object, *g_Fields[2]);
+	}
+
+
+	void SaveBinary_Vectors(std::ostream& stream, u32, const void* data)
+	{
+		const Vectors& object = *(const Vectors*)data;
+		(void)object;
+		serialise::SaveBinaryField(stream, &object, *g_Fields[3]);
+		{
+			int count = (int)object.int_vector.size();
+			rflb::StreamWrite(stream, count);
+			if (count)
+				stream.write((const char*)&object.int_vector[0], count * sizeof(object.int_vector[0]));
+		}
+		{
+			int count = (int)object.char_vector.size();
+			rflb::StreamWrite(stream, count);
+			if (count)
+				stream.write((const char*)&object.char_vector[0], count * sizeof(object.char_vector[0]));
+		}
+		{
+			int count = (int)object.float_vector.size();
+			rflb::StreamWrite(stream, count);
+			if (count)
+				stream.write((const char*)&object.float_vector[0], count * sizeof(object.float_vector[0]));
+		}
+		{
+			int count = (int)object.short_vector.size();
+			rflb::StreamWrite(stream, count);
+			if (count)
+				stream.write((const char*)&object.short_vector[0], count * sizeof(object.short_vector[0]));
+		}
+		{
+			int count = (int)object.double_vector.size();
+			rflb::StreamWrite(stream, count);
+			if (count)
+				stream.write((const char*)&object.double_vector[0], count * sizeof(object.double_vector[0]));
+		}
+		serialise::SaveBinaryField(stream, &object, *g_Fields[4]);
+	}
+
+
+	void LoadBinary_Vectors(std::istream& stream, u32, void* data)
+	{
+		Vectors& object = *(Vectors*)data;
+		(void)object;
+		serialise::LoadBinaryField(stream, &object, *g_Fields[3]);
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.int_vector[0])))
+				return;
+			size_t start = object.int_vector.size();
+			object.int_vector.resize(start + count);
+			if (count)
+				stream.read((char*)&object.int_vector[start], count * sizeof(object.int_vector[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.char_vector[0])))
+				return;
+			size_t start = object.char_vector.size();
+			object.char_vector.resize(start + count);
+			if (count)
+				stream.read((char*)&object.char_vector[start], count * sizeof(object.char_vector[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.float_vector[0])))
+				return;
+			size_t start = object.float_vector.size();
+			object.float_vector.resize(start + count);
+			if (count)
+				stream.read((char*)&object.float_vector[start], count * sizeof(object.float_vector[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.short_vector[0])))
+				return;
+			size_t start = object.short_vector.size();
+			object.short_vector.resize(start + count);
+			if (count)
+				stream.read((char*)&object.short_vector[start], count * sizeof(object.short_vector[0]));
+		}
+		{
+			int count;
+			rflb::StreamRead(stream, count);
+			if (!serialise::CheckBound(stream, count, sizeof(object.double_vector[0])))
+				return;
+			size_t start = object.double_vector.size();
+			object.double_vector.resize(start + count);
+			if (count)
+				stream.read((char*)&object.double_vector[start], count * sizeof(object.double_vector[0]));
+		}
+		serialise::LoadBinaryField(stream, &object, *g_Fields[4]);
+	}
+
+
+	void SaveBinary_Maps(std::ostream& stream, u32, const void* data)
+	{
+		const Maps& object = *(const Maps*)data;
+		(void)object;
+		serialise::SaveBinaryField(stream, &object, *g_Fields[5]);
+		serialise::SaveBinaryField(stream, &object, *g_Fields[6]);
+		serialise::SaveBinaryField(stream, &object, *g_Fields[7]);
+		serialise::SaveBinaryField(stream, &object, *g_Fields[8]);
+		serialise::SaveBinaryField(stream, &object, *g_Fields[9]);
+		serialise::SaveBinaryField(stream, &object, *g_Fields[10]);
+		serialise::SaveBinaryField(stream, &object, *g_Fields[11]);
+	}
+
+
+	void LoadBinary_Maps(std::istream& stream, u32, void* data)
+	{
+		Maps& object = *(Maps*)data;
+		(void)object;
+		serialise::LoadBinaryField(stream, &object, *g_Fields[5]);
+		serialise::LoadBinaryField(stream, &object, *g_Fields[6]);
+		serialise::LoadBinaryField(stream, &object, *g_Fields[7]);
+		serialise::LoadBinaryField(stream, &object, *g_Fields[8]);
+		serialise::LoadBinaryField(stream, &object, *g_Fields[9]);
+		serialise::LoadBinaryField(stream, &object, *g_Fields[10]);
+		serialise::LoadBinaryField(stream, &object, *g_Fields[11]);
+	}
+
+
+	void SaveBinary_TestData(std::ostream& stream, u32, const void* data)
+	{
+		const TestData& object = *(const TestData*)data;
+		(void)object;
+		SaveBinary_Maps(stream, 0, &object.maps);
+		SaveBinary_Arrays(stream, 0, &object.arrays);
+		SaveBinary_Values(stream, 0, &object.values);
+		SaveBinary_Vectors(stream, 0, &object.vectors);
+	}
+
+
+	void LoadBinary_TestData(std::istream& stream, u32, void* data)
+	{
+		TestData& object = *(TestData*)data;
+		(void)object;
+		LoadBinary_Maps(stream, 0, &object.maps);
+		LoadBinary_Arrays(stream, 0, &object.arrays);
+		LoadBinary_Values(stream, 0, &object.values);
+		LoadBinary_Vectors(stream, 0, &object.vectors);
+	}
+
+
+	void SaveBinary_TestBase(std::ostream& stream, u32, const void* data)
+	{
+		const TestBase& object = *(const TestBase*)data;
+		(void)object;
+		SaveBinary_TestData(stream, 0, &object.data);
+	}
+
+
+	void LoadBinary_TestBase(std::istream& stream, u32, void* data)
+	{
+		TestBase& object = *(TestBase*)data;
+		(void)object;
+		LoadBinary_TestData(stream, 0, &object.data);
+	}
+
+
+	void SaveBinary_TestDerived(std::ostream& stream, u32, const void* data)
+	{
+		const TestDerived& object = *(const TestDerived*)data;
+		(void)object;
+		SaveBinary_TestData(stream, 0, &object.data2);
+		SaveBinary_TestBase(stream, 0, data);
+	}
+
+
+	void LoadBinary_TestDerived(std::istream& stream, u32, void* data)
+	{
+		TestDerived& object = *(TestDerived*)data;
+		(void)object;
+		LoadBinary_TestData(stream, 0, &object.data2);
+		LoadBinary_TestBase(stream, 0, data);
+	}
+}
+
+
+void RegisterGeneratedSerialisers(rflb::TypeDatabase& db)
+{
+	rflb::Type& type_TestVector = db.GetType<TestVector>();
+	rflb::Type& type_Values = db.GetType<Values>();
+	rflb::Type& type_Arrays = db.GetType<Arrays>();
+	rflb::Type& type_Vectors = db.GetType<Vectors>();
+	rflb::Type& type_Maps = db.GetType<Maps>();
+	rflb::Type& type_TestData = db.GetType<TestData>();
+	rflb::Type& type_TestBase = db.GetType<TestBase>();
+	rflb::Type& type_TestDerived = db.GetType<TestDerived>();
+
+	g_Fields[0] = &type_Values.GetField(rflb::Name((u32)0x496207b3));
+	g_Fields[1] = &type_Arrays.GetField(rflb::Name((u32)0x12a503c2));
+	g_Fields[2] = &type_Arrays.GetField(rflb::Name((u32)0x214a0516));
+	g_Fields[3] = &type_Vectors.GetField(rflb::Name((u32)0x16ff0436));
+	g_Fields[4] = &type_Vectors.GetField(rflb::Name((u32)0x26f8058a));
+	g_Fields[5] = &type_Maps.GetField(rflb::Name((u32)0xb9a02e1));
+	g_Fields[6] = &type_Maps.GetField(rflb::Name((u32)0xbb302e9));
+	g_Fields[7] = &type_Maps.GetField(rflb::Name((u32)0xe6d033c));
+	g_Fields[8] = &type_Maps.GetField(rflb::Name((u32)0x128703b4));
+	g_Fields[9] = &type_Maps.GetField(rflb::Name((u32)0x134203ce));
+	g_Fields[10] = &type_Maps.GetField(rflb::Name((u32)0x16a50419));
+	g_Fields[11] = &type_Maps.GetField(rflb::Name((u32)0x17970435));
+
+	type_TestVector.GeneratedBinary(LoadBinary_TestVector, SaveBinary_TestVector);
+	type_Values.GeneratedBinary(LoadBinary_Values, SaveBinary_Values);
+	type_Arrays.GeneratedBinary(LoadBinary_Arrays, SaveBinary_Arrays);
+	type_Vectors.GeneratedBinary(LoadBinary_Vectors, SaveBinary_Vectors);
+	type_Maps.GeneratedBinary(LoadBinary_Maps, SaveBinary_Maps);
+	type_TestData.GeneratedBinary(LoadBinary_TestData, SaveBinary_TestData);
+	type_TestBase.GeneratedBinary(LoadBinary_TestBase, SaveBinary_TestBase);
+	type_TestDerived.GeneratedBinary(LoadBinary_TestDerived, SaveBinary_TestDerived);
+}
@@ -11,6 +11,7 @@
 #include <rflb/ArrayContainer.h>
 #include <rflb/MapContainer.h>
 #include <rflb/SerialiseBinary.h>
+#include <rflb/Compare.h>
 
 
 #define TEST_ASSERT(condition) printf("Test (A:%s): %s\n", (condition) ? "Pass" : "FAIL", #condition);
@@ -22,6 +23,8 @@ void LoadStringBinary(std::istream& stream, u32, void* data)
 	std::string& str = *(std::string*)data;
 	int length = 0;
 	stream.read((char*)&length, sizeof(length));
+	if (!serialise::CheckBound(stream, length, 1))
+		return;
 	str.resize(length);
 	stream.read(&str[0], (int)length);
 }
@@ -36,6 +39,19 @@ void SaveStringBinary(std::ostream& stream, u32, const void* data)
 }
 
 
+bool EqualString(const void* a, const void* b)
+{
+	return *(const std::string*)a == *(const std::string*)b;
+}
+
+
+u32 HashString(const void* object, u32 seed)
+{
+	const std::string& str = *(const std::string*)object;
+	return rflb::HashBytes(str.data(), str.length(), seed);
+}
+
+
 void LoadCharStringBinary(std::istream& stream, u32, void* data)
 {
 	stream.read((char*)data, 6);
@@ -79,6 +95,7 @@ void TestArrayContainer()
 	// Add overflow and adding by key
 	TEST_EXCEPTION(w_iterator->Add(old_array));
 	TEST_EXCEPTION(w_iterator->Add(old_array, old_array));
+	TEST_EXCEPTION(w_iterator->AddSwap(old_array, old_array));
 
 	// Test iteration
 	IReadIterator* r_iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, new_array);
@@ -133,6 +150,7 @@ void TestVectorContainer()
 
 	// Adding by key
 	TEST_EXCEPTION(w_iterator->Add(old_array, old_array));
+	TEST_EXCEPTION(w_iterator->AddSwap(old_array, old_array));
 
 	// Test iteration
 	IReadIterator* r_iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, &new_vector);
@@ -154,6 +172,19 @@ void TestVectorContainer()
 	RFLB_DELETE_TEMP_ITERATOR(factory, w_iterator);
 	RFLB_DELETE_TEMP_ITERATOR(factory, r_iterator);
 	delete factory;
+
+	// Swapping values in takes what they own without copying
+	std::vector<std::string> strings;
+	std::string long_string(100, 'x');
+	const char* long_string_data = long_string.data();
+	factory = internal::CreateContainerFactory(strings, key_type, value_type);
+	w_iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, &strings);
+	w_iterator->AddSwap(&long_string);
+	TEST_ASSERT(strings.size() == 1 && strings[0].data() == long_string_data);
+	TEST_ASSERT(long_string.empty());
+	TEST_ASSERT(*(std::string*)w_iterator->AddEmpty() == "");
+	RFLB_DELETE_TEMP_ITERATOR(factory, w_iterator);
+	delete factory;
 }
 
 
@@ -188,6 +219,13 @@ void TestMapContainer()
 
 	// Adding by value
 	TEST_EXCEPTION(w_iterator->Add(old_array));
+	TEST_EXCEPTION(w_iterator->AddSwap(old_array));
+
+	// Adding an existing key resets its value
+	TEST_ASSERT(*(int*)w_iterator->AddEmpty(keys + 0) == 0);
+	int swapped = 5;
+	w_iterator->AddSwap(keys + 0, &swapped);
+	TEST_ASSERT(new_map[keys[0]] == 5 && new_map.size() == 5);
 
 	// Test iteration
 	IReadIterator* r_iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, &new_map);
@@ -223,6 +261,7 @@ int main()
 	TypeDatabase db;
 	db.GetType<std::string>().LoadSaveBinary(LoadStringBinary, SaveStringBinary);
 	db.GetType<std::string>().LoadSaveBinaryIFFv(LoadStringBinary, SaveStringBinary);
+	db.GetType<std::string>().CustomCompare(EqualString, HashString);
 
 	extern void TestSerialisation(rflb::TypeDatabase& db);
 	TestSerialisation(db);
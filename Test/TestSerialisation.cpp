@@ -1,6 +1,8 @@
 
 #include <sstream>
+#include <fstream>
 #include <cstdarg>
+#include <cmath>
 
 #include <rflb/Type.h>
 #include <rflb/Field.h>
@@ -9,6 +11,20 @@
 #include <rflb/ArrayContainer.h>
 #include <rflb/MapContainer.h>
 #include <rflb/SerialiseBinary.h>
+#include <rflb/SerialiseIncremental.h>
+#include <rflb/SerialiseImage.h>
+#include <rflb/SerialisePacked.h>
+#include <rflb/SerialiseEngine.h>
+#include <rflb/SerialiseContext.h>
+#include <rflb/Copy.h>
+#include <rflb/Compare.h>
+#include <rflb/FieldPath.h>
+#include <rflb/ReflectedTable.h>
+#include <rflb/CodeGenerator.h>
+#include <rflb/JobRunner.h>
+#include <rflb/TypePool.h>
+#include <rflb/Measure.h>
+#include <rflb/Layout.h>
 
 
 #define TEST_ASSERT(condition) printf("Test (A:%s): %s\n", (condition) ? "Pass" : "FAIL", #condition);
@@ -423,6 +439,10 @@ struct TestDerived : public TestBase
 };
 
 
+// Output of TestCodeGenerator's generator, checked in
+#include "GeneratedSerialisers.inl"
+
+
 void TestBinarySerialisation(rflb::TypeDatabase& db)
 {
 	printf("\nTestBinarySerialisation\n\n");
@@ -461,6 +481,2365 @@ void TestBinaryIFFVSerialisation(rflb::TypeDatabase& db)
 }
 
 
+void TestColumnarSerialisation(rflb::TypeDatabase& db)
+{
+	printf("\nTestColumnarSerialisation\n\n");
+
+	TestDerived src, dst;
+	src.Set();
+
+	std::stringstream binary_data;
+	serialise::SaveBinary(binary_data, &src, &db.GetType<TestDerived>(), serialise::FLAG_COLUMNAR);
+	serialise::LoadBinary(binary_data, &dst, &db.GetType<TestDerived>(), serialise::FLAG_COLUMNAR);
+
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+
+	// The x values of the vector of PODs should be next to each other
+	const int x_column[] = { 57, 90 };
+	std::string data = binary_data.str();
+	TEST_ASSERT(data.find(std::string((const char*)x_column, sizeof(x_column))) != std::string::npos);
+
+	std::stringstream row_data;
+	serialise::SaveBinary(row_data, &src, &db.GetType<TestDerived>());
+	TEST_ASSERT(row_data.str().size() == data.size());
+	TEST_ASSERT(row_data.str().find(std::string((const char*)x_column, sizeof(x_column))) == std::string::npos);
+}
+
+
+void TestIncrementalLoad(rflb::TypeDatabase& db, rflb::SerialiseMethod method)
+{
+	printf("\nTestIncrementalLoad (%s)\n\n", method == rflb::SERIALISE_METHOD_BINARY ? "Binary" : "IFFV");
+
+	TestDerived src, dst;
+	src.Set();
+
+	std::stringstream binary_data;
+	if (method == rflb::SERIALISE_METHOD_BINARY)
+		serialise::SaveBinary(binary_data, &src, &db.GetType<TestDerived>());
+	else
+		serialise::SaveBinaryIFFV(binary_data, &src, &db.GetType<TestDerived>());
+
+	// Add some trailing data that the loader should leave alone
+	std::string data = binary_data.str();
+	size_t object_size = data.size();
+	data += "TAIL";
+
+	// Feed the data in small fragments, as if it were arriving over the network
+	serialise::IncrementalLoader loader;
+	loader.Begin(&dst, &db.GetType<TestDerived>(), method);
+	serialise::LoadStatus status = serialise::LOAD_STATUS_NEED_MORE_DATA;
+	size_t position = 0;
+	int nb_feeds = 0;
+	while (status == serialise::LOAD_STATUS_NEED_MORE_DATA && position < data.size())
+	{
+		u32 size = (u32)(data.size() - position < 7 ? data.size() - position : 7);
+		u32 nb_consumed;
+		status = loader.Feed(data.data() + position, size, &nb_consumed);
+		position += nb_consumed;
+		nb_feeds++;
+	}
+
+	TEST_ASSERT(status == serialise::LOAD_STATUS_COMPLETE);
+	TEST_ASSERT(nb_feeds > 1);
+	TEST_ASSERT(position == object_size);
+	TEST_ASSERT(loader.GetPosition() == object_size);
+
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+}
+
+
+void TestFieldIndex(rflb::TypeDatabase& db)
+{
+	printf("\nTestFieldIndex\n\n");
+
+	const rflb::Type* type = &db.GetType<TestDerived>();
+	TestDerived src;
+	src.Set();
+	src.data.values.int_value = 42;
+
+	// Indexed objects should still load with the regular loader
+	{
+		std::stringstream binary_data;
+		TestDerived dst;
+		serialise::SaveBinaryIFFV(binary_data, &src, type, serialise::FLAG_FIELD_INDEX);
+		serialise::LoadBinaryIFFV(binary_data, &dst, type);
+		dst.data.TestAgainst(src.data);
+	}
+
+	// Store a few objects in an archive
+	std::stringstream archive_data;
+	archive_data << "HEADER";
+	serialise::ArchiveWriter writer(archive_data);
+	TestDerived empty;
+	writer.Save(&empty, type);
+	writer.Save(&src, type);
+	writer.Save(&empty, type);
+	writer.Finish();
+
+	serialise::ArchiveReader reader(archive_data);
+	TEST_ASSERT(reader.IsValid());
+	TEST_ASSERT(reader.GetNbObjects() == 3);
+	TEST_ASSERT(reader.GetTypeCRC(1) == type->GetName().m_CRC);
+
+	// Pick out a single field from the middle object, which belongs to the base type
+	TestDerived dst;
+	rflb::Name names[] = { rflb::Name("data") };
+	TEST_ASSERT(reader.LoadFields(1, &dst, type, names) == 1);
+	dst.data.TestAgainst(src.data);
+	TEST_ASSERT(dst.data2.values.custom_string_type.empty());
+
+	// Load an entire object
+	TestDerived dst2;
+	reader.Load(1, &dst2, type);
+	dst2.data2.TestAgainst(src.data2);
+
+	// Corrupt trailers are rejected rather than wrapping around, with 2^29 objects needing a 4GB index
+	std::string archive = archive_data.str();
+	size_t trailer = archive.size() - sizeof(u32) * 3;
+	std::string huge_count = archive;
+	u32 nb_objects = 0x20000000;
+	memcpy(&huge_count[trailer], &nb_objects, sizeof(nb_objects));
+	std::stringstream huge_count_data(huge_count);
+	TEST_ASSERT(!serialise::ArchiveReader(huge_count_data).IsValid());
+	std::string huge_offset = archive;
+	u32 footer_offset = 0xFFFFFFF0;
+	memcpy(&huge_offset[trailer + sizeof(u32)], &footer_offset, sizeof(footer_offset));
+	std::stringstream huge_offset_data(huge_offset);
+	TEST_ASSERT(!serialise::ArchiveReader(huge_offset_data).IsValid());
+
+	// Entries pointing past the objects
+	std::string bad_entry = archive;
+	u32 entry_offset = 0x7FFFFFFF;
+	memcpy(&bad_entry[trailer - sizeof(serialise::ArchiveEntry) * 2], &entry_offset, sizeof(entry_offset));
+	std::stringstream bad_entry_data(bad_entry);
+	serialise::ArchiveReader bad_entry_reader(bad_entry_data);
+	TEST_ASSERT(bad_entry_reader.IsValid());
+	TEST_EXCEPTION(bad_entry_reader.Load(1, &dst2, type));
+
+	// Partial loads of objects without an index
+	std::stringstream binary_data;
+	serialise::SaveBinaryIFFV(binary_data, &src, type);
+	binary_data << "TAIL";
+	TestDerived dst3;
+	rflb::Name unindexed_names[] = { rflb::Name("data2"), rflb::Name("missing") };
+	TEST_ASSERT(serialise::LoadFields(binary_data, &dst3, type, unindexed_names) == 1);
+	dst3.data2.TestAgainst(src.data2);
+	TEST_ASSERT(dst3.data.values.custom_string_type.empty());
+	char tail[4];
+	binary_data.read(tail, 4);
+	TEST_ASSERT(binary_data && tail[0] == 'T');
+}
+
+
+// Written as text, so the serialised size has nothing to do with the size of the field
+void LoadShortText(std::istream& stream, u32, void* data)
+{
+	int value = 0;
+	stream >> value;
+	*(short*)data = (short)value;
+}
+
+void SaveShortText(std::ostream& stream, u32, const void* data)
+{
+	stream << *(const short*)data;
+}
+
+
+// Custom serialised fields smaller than an image block
+struct TestSmallCustom
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("first", &TestSmallCustom::first).LoadSaveBinary(LoadShortText, SaveShortText),
+			FieldInfo("middle", &TestSmallCustom::middle),
+			FieldInfo("last", &TestSmallCustom::last).LoadSaveBinary(LoadShortText, SaveShortText)
+		};
+		db.SetTypeFields<TestSmallCustom>(fields);
+	}
+
+	short first;
+	int middle;
+	short last;
+};
+
+
+struct TestTransient
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("value", &TestTransient::value),
+			FieldInfo("cached", &TestTransient::cached).Attributes(FieldAttr::TRANSIENT),
+			FieldInfo("name", &TestTransient::name)
+		};
+		db.SetTypeFields<TestTransient>(fields);
+	}
+
+	int value;
+	int cached;
+	std::string name;
+};
+
+
+void TestImage(rflb::TypeDatabase& db)
+{
+	printf("\nTestImage\n\n");
+
+	const rflb::Type* type = &db.GetType<TestDerived>();
+	TestDerived src, dst;
+	src.Set();
+
+	std::stringstream image_data;
+	serialise::SaveImage(image_data, &src, type);
+	std::string data = image_data.str();
+
+	// Copy to aligned memory, as if the image had been memory-mapped
+	std::vector<double> image((data.size() + sizeof(double) - 1) / sizeof(double) + serialise::IMAGE_ALIGNMENT / sizeof(double));
+	char* aligned = (char*)(((size_t)&image[0] + serialise::IMAGE_ALIGNMENT - 1) & ~(size_t)(serialise::IMAGE_ALIGNMENT - 1));
+	memcpy(aligned, data.data(), data.size());
+
+	// Read values directly from the image without loading
+	const char* image_object = (const char*)serialise::GetImageObject(aligned, type);
+	TEST_ASSERT(image_object != 0);
+	TEST_ASSERT(serialise::GetImageObject(aligned, &db.GetType<TestBase>()) == 0);
+	const TestData& image_data2 = *(const TestData*)(image_object + offsetof(TestDerived, data2));
+	TEST_ASSERT(image_data2.values.int_value == src.data2.values.int_value);
+	TEST_ASSERT(ArraysEqual(image_data2.arrays.int_array, src.data2.arrays.int_array));
+
+	const rflb::Field& int_vector = db.GetType<Vectors>().GetField(rflb::Name("int_vector"));
+	const serialise::ImageBlock& block = serialise::GetImageBlock(&image_data2.vectors, int_vector);
+	TEST_ASSERT(block.m_Count == src.data2.vectors.int_vector.size());
+	TEST_ASSERT(((const int*)block.GetData())[1] == src.data2.vectors.int_vector[1]);
+
+	// Fix up into a live object
+	serialise::LoadImage(aligned, &dst, type);
+
+	// Values too small for a block have theirs stored in a table
+	TestSmallCustom::Register(db);
+	const rflb::Type* small_type = &db.GetType<TestSmallCustom>();
+	TestSmallCustom small_src = { 12345, 7, -3 };
+	std::stringstream small_data;
+	serialise::SaveImage(small_data, &small_src, small_type);
+	std::string small_bytes = small_data.str();
+	std::vector<double> small_image(small_bytes.size() / sizeof(double) + 1);
+	memcpy(&small_image[0], small_bytes.data(), small_bytes.size());
+	const void* small_object = serialise::GetImageObject(&small_image[0], small_type);
+	const serialise::ImageBlock& small_block = serialise::GetImageBlock(&small_image[0], small_object, small_type->GetField(rflb::Name("first")));
+	TEST_ASSERT(small_block.m_Count == 5 && memcmp(small_block.GetData(), "12345", 5) == 0);
+	TEST_ASSERT(((const TestSmallCustom*)small_object)->first == 0 && ((const TestSmallCustom*)small_object)->middle == 7);
+	TestSmallCustom small_dst = { 0, 0, 0 };
+	serialise::LoadImage(&small_image[0], &small_dst, small_type);
+	TEST_ASSERT(small_dst.first == 12345 && small_dst.middle == 7 && small_dst.last == -3);
+
+	// Transient fields are stored as zero and not loaded
+	TestTransient::Register(db);
+	const rflb::Type* transient_type = &db.GetType<TestTransient>();
+	TestTransient t0, t1;
+	t0.value = t1.value = 10;
+	t0.cached = 1;
+	t1.cached = 2;
+	t0.name = t1.name = "Nobby";
+	std::stringstream t0_data, t1_data;
+	serialise::SaveImage(t0_data, &t0, transient_type);
+	serialise::SaveImage(t1_data, &t1, transient_type);
+	TEST_ASSERT(t0_data.str() == t1_data.str());
+	std::string transient_bytes = t0_data.str();
+	std::vector<double> transient_image(transient_bytes.size() / sizeof(double) + 1);
+	memcpy(&transient_image[0], transient_bytes.data(), transient_bytes.size());
+	serialise::LoadImage(&transient_image[0], &t1, transient_type);
+	TEST_ASSERT(t1.value == 10 && t1.cached == 2 && t1.name == "Nobby");
+
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+}
+
+
+void CopySwappedVector(void* dst, const void* src)
+{
+	const TestVector& v = *(const TestVector*)src;
+	*(TestVector*)dst = TestVector(v.y, v.x);
+}
+
+
+void TestCopy(rflb::TypeDatabase& db)
+{
+	printf("\nTestCopy\n\n");
+
+	const rflb::Type* type = &db.GetType<TestDerived>();
+	TestDerived src, dst;
+	src.Set();
+	src.data.values.int_value = 42;
+	src.data2.vectors.int_vector.push_back(7);
+
+	// Containers in the destination should be replaced, not appended to
+	dst.Set();
+	rflb::CopyObject(&dst, &src, type);
+
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+
+	// Adjacent PODs are merged
+	TEST_ASSERT(db.GetType<TestVector>().GetCopyPlan().m_IsBlock);
+	TEST_ASSERT(db.GetType<Arrays>().GetCopyPlan().m_Steps.size() < db.GetType<Arrays>().GetFields().size());
+
+	// Batch copies
+	TestVector vectors_src[3] = { TestVector(1, 2), TestVector(3, 4), TestVector(5, 6) };
+	TestVector vectors_dst[3];
+	rflb::CopyObjects(vectors_dst, vectors_src, &db.GetType<TestVector>(), 3);
+	TEST_ASSERT(ArraysEqual(vectors_dst, vectors_src));
+
+	TestDerived objects_src[2], objects_dst[2];
+	objects_src[0].Set();
+	objects_src[1].Set();
+	objects_src[1].data2.values.custom_string_type = "Batch";
+	rflb::CopyObjects(objects_dst, objects_src, type, 2);
+	objects_dst[0].data2.TestAgainst(objects_src[0].data2);
+	objects_dst[1].data2.TestAgainst(objects_src[1].data2);
+
+	// Custom copies should be used wherever the type is embedded
+	db.GetType<TestVector>().CustomCopy(CopySwappedVector);
+	Values values_dst;
+	rflb::CopyObject(&values_dst, &src.data.values, &db.GetType<Values>());
+	TEST_ASSERT(values_dst.embedded_pod == TestVector(65537, 65536));
+	TEST_ASSERT(values_dst.custom_string_type == src.data.values.custom_string_type);
+	db.GetType<TestVector>().CustomCopy(0);
+}
+
+
+void TestCompare(rflb::TypeDatabase& db)
+{
+	printf("\nTestCompare\n\n");
+
+	const rflb::Type* type = &db.GetType<TestDerived>();
+	TestDerived a, b;
+	a.Set();
+	b.Set();
+	TEST_ASSERT(rflb::EqualObjects(&a, &b, type));
+	TEST_ASSERT(rflb::HashObject(&a, type) == rflb::HashObject(&b, type));
+
+	// Changes within PODs, containers and custom serialised types
+	b.data2.values.int_value++;
+	TEST_ASSERT(!rflb::EqualObjects(&a, &b, type));
+	TEST_ASSERT(rflb::HashObject(&a, type) != rflb::HashObject(&b, type));
+	b.data2.values.int_value--;
+	b.data.maps.string_map[41] = "Angua";
+	TEST_ASSERT(!rflb::EqualObjects(&a, &b, type));
+	TEST_ASSERT(rflb::HashObject(&a, type) != rflb::HashObject(&b, type));
+	rflb::CopyObject(&b, &a, type);
+	TEST_ASSERT(rflb::EqualObjects(&a, &b, type));
+	b.data.vectors.int_vector.push_back(0);
+	TEST_ASSERT(!rflb::EqualObjects(&a, &b, type));
+
+	// Transient fields are ignored
+	const rflb::Type* transient_type = &db.GetType<TestTransient>();
+	TestTransient t0, t1;
+	t0.value = t1.value = 10;
+	t0.cached = 1;
+	t1.cached = 2;
+	t0.name = t1.name = "Cheery";
+	TEST_ASSERT(rflb::EqualObjects(&t0, &t1, transient_type));
+	TEST_ASSERT(rflb::HashObject(&t0, transient_type) == rflb::HashObject(&t1, transient_type));
+	TEST_ASSERT(rflb::HashObject(&t0, transient_type) != rflb::HashObject(&t0, transient_type, 1));
+
+	// Non-POD types without fields can't be compared bitwise
+	const rflb::Type* wstring_type = &db.GetType<std::wstring>();
+	std::wstring w0, w1;
+	TEST_EXCEPTION(rflb::EqualObjects(&w0, &w1, wstring_type));
+	TEST_EXCEPTION(rflb::HashObject(&w0, wstring_type));
+}
+
+
+// Containers of pointers to objects larger than a pointer
+struct TestPathPoint
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("a", &TestPathPoint::a),
+			FieldInfo("b", &TestPathPoint::b)
+		};
+		db.SetTypeFields<TestPathPoint>(fields);
+	}
+
+	__int64 a;
+	int b;
+};
+
+
+struct TestPathPointers
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		TestPathPoint::Register(db);
+
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("vector", &TestPathPointers::vector),
+			FieldInfo("array", &TestPathPointers::array)
+		};
+		db.SetTypeFields<TestPathPointers>(fields);
+	}
+
+	std::vector<TestPathPoint*> vector;
+	TestPathPoint* array[3];
+};
+
+
+void TestFieldPath(rflb::TypeDatabase& db)
+{
+	printf("\nTestFieldPath\n\n");
+
+	TestDerived object;
+	object.Set();
+
+	// Fields of embedded objects and base types fold into a single offset
+	rflb::FieldPath x;
+	TEST_ASSERT(x.Resolve<TestDerived>(db, "data.values.embedded_pod.x"));
+	TEST_ASSERT(x.IsType<int>());
+	TEST_ASSERT(x.Get<int>(&object) == 65536);
+	x.Set(&object, 12);
+	TEST_ASSERT(object.data.values.embedded_pod.x == 12);
+	TEST_EXCEPTION(x.Get<float>(&object));
+
+	// Array and vector elements
+	rflb::FieldPath array_element, vector_element;
+	TEST_ASSERT(array_element.Resolve<TestDerived>(db, "data2.arrays.pod_array[1].y"));
+	TEST_ASSERT(array_element.Get<int>(&object) == 23);
+	TEST_ASSERT(vector_element.Resolve<TestDerived>(db, "data2.vectors.pod_vector[1].y"));
+	TEST_ASSERT(vector_element.Get<int>(&object) == 391);
+	object.data2.vectors.pod_vector.resize(1);
+	TEST_ASSERT(vector_element.GetAddress(&object) == 0);
+
+	// Paths that can't be resolved
+	rflb::FieldPath invalid;
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data.missing"));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data.arrays.pod_array[2]"));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data.vectors.pod_vector.x"));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data.maps.pod_map[0]"));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, ""));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data2.values."));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data2..values"));
+	TEST_ASSERT(!invalid.Resolve<TestDerived>(db, "data2.arrays.pod_array[1]."));
+	TEST_ASSERT(!invalid.IsValid());
+
+	// Elements of pointer containers are a pointer apart, whatever the size of the objects
+	TestPathPointers::Register(db);
+	TestPathPoint points[3] = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+	TestPathPointers pointers;
+	for (int i = 0; i < 3; i++)
+	{
+		pointers.vector.push_back(&points[2 - i]);
+		pointers.array[i] = &points[i];
+	}
+	rflb::FieldPath vector_pointer, array_pointer;
+	TEST_ASSERT(vector_pointer.Resolve<TestPathPointers>(db, "vector[1].b"));
+	TEST_ASSERT(vector_pointer.GetAddress(&pointers) == &points[1].b);
+	TEST_ASSERT(array_pointer.Resolve<TestPathPointers>(db, "array[2].b"));
+	TEST_ASSERT(array_pointer.Get<int>(&pointers) == 30);
+	TEST_ASSERT(!invalid.Resolve<TestPathPointers>(db, "array[3].b"));
+
+	// Batch access
+	TestDerived objects[3];
+	int values[3] = { 1, 2, 3 };
+	rflb::FieldPath int_value;
+	TEST_ASSERT(int_value.Resolve<TestDerived>(db, "data2.values.int_value"));
+	int_value.SetBatch(objects, 3, values);
+	TEST_ASSERT(objects[2].data2.values.int_value == 3);
+	int results[3] = { 0 };
+	int_value.GetBatch(objects, 3, results);
+	TEST_ASSERT(ArraysEqual(results, values));
+
+	// Paths through vectors are followed for each object
+	rflb::FieldPath vector_y;
+	TEST_ASSERT(vector_y.Resolve<TestDerived>(db, "data2.vectors.pod_vector[0].y"));
+	for (int i = 0; i < 3; i++)
+		objects[i].data2.vectors.pod_vector.resize(1);
+	vector_y.SetBatch(objects, 3, values);
+	TEST_ASSERT(objects[1].data2.vectors.pod_vector[0].y == 2);
+	int vector_results[3] = { 0 };
+	vector_y.GetBatch(objects, 3, vector_results);
+	TEST_ASSERT(ArraysEqual(vector_results, values));
+}
+
+
+void TestReflectedTable(rflb::TypeDatabase& db)
+{
+	printf("\nTestReflectedTable\n\n");
+
+	const rflb::Type* type = &db.GetType<TestDerived>();
+	rflb::ReflectedTable table(type);
+
+	// Add enough rows to force the columns to grow
+	TestDerived src;
+	src.Set();
+	for (int i = 0; i < 20; i++)
+	{
+		src.data2.values.int_value = i;
+		TEST_ASSERT(table.AddRow(&src) == i);
+	}
+	TEST_ASSERT(table.GetNbRows() == 20);
+
+	// Fields of embedded objects get their own columns
+	int int_column = table.FindColumn("data2.values.int_value");
+	TEST_ASSERT(int_column != -1);
+	TEST_ASSERT(table.FindColumn("data2.values") == -1);
+	TEST_ASSERT(table.FindColumn("data2.values.embedded_pod.y") != -1);
+	TEST_EXCEPTION(table.GetColumn<float>(int_column));
+	const int* int_values = table.GetColumn<int>(int_column);
+	TEST_ASSERT(int_values[7] == 7);
+
+	TestDerived dst;
+	table.GetRow(19, &dst);
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+
+	// Removal moves the last row into place
+	table.RemoveRow(0);
+	TEST_ASSERT(table.GetNbRows() == 19);
+	TEST_ASSERT(table.GetColumn<int>(int_column)[0] == 19);
+
+	// Whole column serialisation
+	std::stringstream table_data;
+	table.Save(table_data);
+	rflb::ReflectedTable loaded_table(type);
+	TEST_ASSERT(loaded_table.Load(table_data));
+	TEST_ASSERT(loaded_table.GetNbRows() == 19);
+	TestDerived loaded;
+	loaded_table.GetRow(3, &loaded);
+	table.GetRow(3, &dst);
+	TEST_ASSERT(loaded.data2.values.int_value == 3);
+	loaded.data.TestAgainst(dst.data);
+	loaded.data2.TestAgainst(dst.data2);
+
+	rflb::ReflectedTable other_table(&db.GetType<Values>());
+	table_data.seekg(0);
+	TEST_ASSERT(!other_table.Load(table_data));
+
+	// Transient columns aren't written
+	rflb::ReflectedTable t0_table(&db.GetType<TestTransient>()), t1_table(&db.GetType<TestTransient>());
+	TestTransient t;
+	t.value = 10;
+	t.name = "Nobby";
+	t.cached = 1;
+	t0_table.AddRow(&t);
+	t.cached = 2;
+	t1_table.AddRow(&t);
+	std::stringstream t0_data, t1_data;
+	t0_table.Save(t0_data);
+	t1_table.Save(t1_data);
+	TEST_ASSERT(t0_data.str() == t1_data.str());
+	TEST_ASSERT(t1_table.Load(t0_data));
+	TEST_ASSERT(t1_table.GetNbRows() == 1 && t1_table.GetColumn<int>(t1_table.FindColumn("value"))[0] == 10);
+
+	// Growing the columns takes what non-POD values own rather than copying it
+	int name_column = t0_table.FindColumn("name");
+	t.name = std::string(100, 'n');
+	t0_table.SetRow(0, &t);
+	const char* name_data = t0_table.GetColumn<std::string>(name_column)[0].data();
+	for (int i = 0; i < 40; i++)
+		t0_table.AddRow(&t);
+	TEST_ASSERT(t0_table.GetColumn<std::string>(name_column)[0].data() == name_data);
+
+	// Row counts that can't fit in the rest of the stream fail before anything is allocated
+	std::string corrupt = t0_data.str();
+	int nb_rows = 0x7FFFFFFF;
+	memcpy(&corrupt[sizeof(u32)], &nb_rows, sizeof(nb_rows));
+	std::stringstream corrupt_data(corrupt);
+	TEST_ASSERT(!t0_table.Load(corrupt_data));
+	TEST_ASSERT(t0_table.GetNbRows() == 41);
+}
+
+
+enum TestProfile
+{
+	PROFILE_DISK = 1,
+	PROFILE_NETWORK = 2,
+	PROFILE_DEBUG = 4
+};
+
+
+struct TestProfiled
+{
+	TestProfiled() : health(0), cached(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("position", &TestProfiled::position),
+			FieldInfo("health", &TestProfiled::health).Profiles(PROFILE_DISK | PROFILE_NETWORK),
+			FieldInfo("save_path", &TestProfiled::save_path).Profiles(PROFILE_DISK),
+			FieldInfo("debug_name", &TestProfiled::debug_name).Profiles(PROFILE_DEBUG),
+			FieldInfo("cached", &TestProfiled::cached).Attributes(FieldAttr::TRANSIENT)
+		};
+		db.SetTypeFields<TestProfiled>(fields);
+	}
+
+	void Set()
+	{
+		position = TestVector(10, 20);
+		health = 75;
+		save_path = "Ankh-Morpork";
+		debug_name = "Rincewind";
+		cached = 42;
+	}
+
+	TestVector position;
+	int health;
+	std::string save_path;
+	std::string debug_name;
+	int cached;
+};
+
+
+void TestProfiles(rflb::TypeDatabase& db)
+{
+	printf("\nTestProfiles\n\n");
+
+	TestProfiled::Register(db);
+	const rflb::Type* type = &db.GetType<TestProfiled>();
+	TEST_ASSERT(type->GetProfileFields(rflb::PROFILE_ALL).size() == 4);
+	TEST_ASSERT(type->GetProfileFields(PROFILE_NETWORK).size() == 2);
+	TEST_ASSERT(type->GetProfileFields(PROFILE_DISK).size() == 3);
+	TEST_ASSERT(&type->GetProfileFields(PROFILE_DISK) == &type->GetProfileFields(PROFILE_DISK));
+
+	TestProfiled src;
+	src.Set();
+
+	// Transient fields are never written
+	std::stringstream all_data;
+	serialise::SaveBinary(all_data, &src, type);
+	TestProfiled all;
+	serialise::LoadBinary(all_data, &all, type);
+	TEST_ASSERT(all.cached == 0);
+	TEST_ASSERT(all.debug_name == src.debug_name);
+
+	// Only the network fields are sent
+	std::stringstream network_data;
+	serialise::SaveBinary(network_data, &src, type, 0, PROFILE_NETWORK);
+	TEST_ASSERT(network_data.str().size() < all_data.str().size());
+	TestProfiled network;
+	serialise::LoadBinary(network_data, &network, type, 0, PROFILE_NETWORK);
+	TEST_ASSERT(network.position == src.position);
+	TEST_ASSERT(network.health == src.health);
+	TEST_ASSERT(network.save_path.empty());
+	TEST_ASSERT(network.debug_name.empty());
+	TEST_ASSERT(network_data.tellg() == (std::streampos)network_data.str().size());
+
+	// IFFV skips fields outside the loading profile
+	std::stringstream disk_data;
+	serialise::SaveBinaryIFFV(disk_data, &src, type, 0, PROFILE_DISK);
+	TestProfiled disk;
+	serialise::LoadBinaryIFFV(disk_data, &disk, type, PROFILE_NETWORK);
+	TEST_ASSERT(disk.health == src.health);
+	TEST_ASSERT(disk.save_path.empty());
+	disk_data.seekg(0);
+	serialise::LoadBinaryIFFV(disk_data, &disk, type, PROFILE_DISK);
+	TEST_ASSERT(disk.save_path == src.save_path);
+	TEST_ASSERT(disk.debug_name.empty());
+}
+
+
+struct TestSparse
+{
+	TestSparse() : id(0), scale(1.0f), flags(0), enabled(true) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("id", &TestSparse::id),
+			FieldInfo("scale", &TestSparse::scale),
+			FieldInfo("flags", &TestSparse::flags),
+			FieldInfo("enabled", &TestSparse::enabled),
+			FieldInfo("position", &TestSparse::position),
+			FieldInfo("name", &TestSparse::name),
+			FieldInfo("tags", &TestSparse::tags)
+		};
+		db.SetTypeFields<TestSparse>(fields);
+	}
+
+	int id;
+	float scale;
+	int flags;
+	bool enabled;
+	TestVector position;
+	std::string name;
+	std::vector<int> tags;
+};
+
+
+// The implicit constructor leaves the PODs uninitialised
+struct TestNoConstructor
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("count", &TestNoConstructor::count),
+			FieldInfo("scale", &TestNoConstructor::scale),
+			FieldInfo("values", &TestNoConstructor::values)
+		};
+		db.SetTypeFields<TestNoConstructor>(fields);
+	}
+
+	int count;
+	float scale;
+	std::vector<int> values;
+};
+
+
+// Pointer to a larger object, saved as a reference to a shared instance rather than the object itself
+struct TestBig
+{
+	char data[64];
+};
+
+
+TestBig g_SharedBig;
+
+
+void SaveBigReference(std::ostream& stream, u32, const void* data)
+{
+	char is_shared = *(TestBig* const*)data != 0;
+	stream.write(&is_shared, sizeof(is_shared));
+}
+
+
+void LoadBigReference(std::istream& stream, u32, void* data)
+{
+	char is_shared = 0;
+	stream.read(&is_shared, sizeof(is_shared));
+	*(TestBig**)data = is_shared ? &g_SharedBig : 0;
+}
+
+
+struct TestBigReference
+{
+	TestBigReference() : id(0), big(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		// Registered first so the type describes the pointee rather than the pointer
+		db.GetType<TestBig>();
+
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("id", &TestBigReference::id),
+			FieldInfo("big", &TestBigReference::big).LoadSaveBinary(LoadBigReference, SaveBigReference)
+		};
+		db.SetTypeFields<TestBigReference>(fields);
+	}
+
+	int id;
+	TestBig* big;
+};
+
+
+// Non-POD without fields, which only has a binary serialiser and so can't be compared
+struct TestLabel
+{
+	std::string text;
+};
+
+
+void SaveLabel(std::ostream& stream, u32, const void* data)
+{
+	const std::string& text = ((const TestLabel*)data)->text;
+	int length = (int)text.size();
+	stream.write((const char*)&length, sizeof(length));
+	stream.write(text.c_str(), length);
+}
+
+
+void LoadLabel(std::istream& stream, u32, void* data)
+{
+	int length = 0;
+	stream.read((char*)&length, sizeof(length));
+	std::string& text = ((TestLabel*)data)->text;
+	text.resize(length);
+	if (length)
+		stream.read(&text[0], length);
+}
+
+
+struct TestLabelled
+{
+	TestLabelled() : id(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		db.GetType<TestLabel>().LoadSaveBinary(LoadLabel, SaveLabel);
+
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("id", &TestLabelled::id),
+			FieldInfo("label", &TestLabelled::label),
+			FieldInfo("labels", &TestLabelled::labels)
+		};
+		db.SetTypeFields<TestLabelled>(fields);
+	}
+
+	int id;
+	TestLabel label;
+	std::vector<TestLabel> labels;
+};
+
+
+void TestSkipDefaults(rflb::TypeDatabase& db)
+{
+	printf("\nTestSkipDefaults\n\n");
+
+	TestSparse::Register(db);
+	const rflb::Type* type = &db.GetType<TestSparse>();
+
+	// Adjacent PODs, including the embedded vector, share presence bits
+	const rflb::internal::CopyPlan& plan = type->GetPresencePlan(rflb::PROFILE_ALL);
+	TEST_ASSERT(plan.m_Steps.size() < 7);
+
+	TestSparse sparse;
+	sparse.id = 17;
+	sparse.tags.push_back(3);
+	std::stringstream full_data, sparse_data;
+	serialise::SaveBinary(full_data, &sparse, type);
+	serialise::SaveBinary(sparse_data, &sparse, type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(sparse_data.str().size() < full_data.str().size());
+
+	// Missing values are reset to their defaults
+	TestSparse loaded;
+	loaded.scale = 5.0f;
+	loaded.name = "Lu-Tze";
+	serialise::LoadBinary(sparse_data, &loaded, type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(loaded.id == 17);
+	TEST_ASSERT(loaded.scale == 1.0f);
+	TEST_ASSERT(loaded.name.empty());
+	TEST_ASSERT(loaded.tags == sparse.tags);
+	TEST_ASSERT(sparse_data.tellg() == (std::streampos)sparse_data.str().size());
+
+	// Members that aren't constructed default to zero rather than whatever was on the heap
+	TestNoConstructor::Register(db);
+	const rflb::Type* no_constructor_type = &db.GetType<TestNoConstructor>();
+	const TestNoConstructor* default_object = (const TestNoConstructor*)no_constructor_type->GetDefaultObject();
+	TEST_ASSERT(default_object->count == 0 && default_object->scale == 0.0f);
+	TestNoConstructor zeroed;
+	zeroed.count = 0;
+	zeroed.scale = 0.0f;
+	zeroed.values.push_back(1);
+	std::stringstream zeroed_data;
+	serialise::SaveBinary(zeroed_data, &zeroed, no_constructor_type, serialise::FLAG_SKIP_DEFAULTS);
+	TestNoConstructor zeroed_dst;
+	zeroed_dst.count = 5;
+	zeroed_dst.scale = 2.0f;
+	serialise::LoadBinary(zeroed_data, &zeroed_dst, no_constructor_type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(zeroed_dst.count == 0 && zeroed_dst.scale == 0.0f && zeroed_dst.values == zeroed.values);
+
+	// Missing pointers are reset to the default pointer, not overwritten with a default pointee
+	TestBigReference::Register(db);
+	const rflb::Type* reference_type = &db.GetType<TestBigReference>();
+	TestBigReference shared;
+	shared.big = &g_SharedBig;
+	std::stringstream shared_data;
+	serialise::SaveBinary(shared_data, &shared, reference_type, serialise::FLAG_SKIP_DEFAULTS);
+	TestBigReference* shared_dst = new TestBigReference;
+	serialise::LoadBinary(shared_data, shared_dst, reference_type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(shared_dst->big == &g_SharedBig);
+	TestBigReference unshared;
+	unshared.id = 3;
+	std::stringstream unshared_data;
+	serialise::SaveBinary(unshared_data, &unshared, reference_type, serialise::FLAG_SKIP_DEFAULTS);
+	serialise::LoadBinary(unshared_data, shared_dst, reference_type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(shared_dst->id == 3 && shared_dst->big == 0);
+	delete shared_dst;
+
+	// Values that can't be compared with their defaults are always written
+	TestLabelled::Register(db);
+	const rflb::Type* labelled_type = &db.GetType<TestLabelled>();
+	TestLabelled labelled;
+	labelled.label.text = "Dorfl";
+	labelled.labels.resize(1);
+	std::stringstream labelled_data;
+	serialise::SaveBinary(labelled_data, &labelled, labelled_type, serialise::FLAG_SKIP_DEFAULTS);
+	TestLabelled labelled_dst;
+	serialise::LoadBinary(labelled_data, &labelled_dst, labelled_type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(labelled_dst.label.text == "Dorfl" && labelled_dst.labels.size() == 1);
+
+	// Objects far from their defaults, with nested containers of objects that get their own bitmaps
+	TestDerived src, dst;
+	src.Set();
+	std::stringstream binary_data;
+	serialise::SaveBinary(binary_data, &src, &db.GetType<TestDerived>(), serialise::FLAG_SKIP_DEFAULTS);
+	serialise::LoadBinary(binary_data, &dst, &db.GetType<TestDerived>(), serialise::FLAG_SKIP_DEFAULTS);
+
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+}
+
+
+// Objects embedded in a larger structure, to test batches with a stride
+struct TestBatchEntry
+{
+	TestSparse object;
+	int frame;
+};
+
+
+void TestBatch(rflb::TypeDatabase& db)
+{
+	printf("\nTestBatch\n\n");
+
+	const rflb::Type* type = &db.GetType<TestSparse>();
+	const int nb_objects = 5;
+	TestBatchEntry src[nb_objects];
+	for (int i = 0; i < nb_objects; i++)
+	{
+		src[i].object.id = i;
+		src[i].object.scale = i * 0.5f;
+		src[i].object.position = TestVector(i, -i);
+		src[i].object.name = std::string(i, 'x');
+		src[i].object.tags.assign(i, i);
+		src[i].frame = 100 + i;
+	}
+
+	// Only the objects are written, not the rest of each entry
+	std::stringstream batch_data;
+	serialise::SaveBinaryBatch(batch_data, &src[0].object, nb_objects, sizeof(TestBatchEntry), type);
+
+	TestBatchEntry dst[nb_objects];
+	for (int i = 0; i < nb_objects; i++)
+		dst[i].frame = 0;
+	serialise::LoadBinaryBatch(batch_data, &dst[0].object, nb_objects, sizeof(TestBatchEntry), type);
+	bool equal = true;
+	for (int i = 0; i < nb_objects; i++)
+	{
+		equal &= dst[i].object.id == i && dst[i].object.scale == src[i].object.scale;
+		equal &= dst[i].object.position == src[i].object.position;
+		equal &= dst[i].object.name == src[i].object.name && dst[i].object.tags == src[i].object.tags;
+		equal &= dst[i].frame == 0;
+	}
+	TEST_ASSERT(equal);
+	TEST_ASSERT(batch_data.tellg() == (std::streampos)batch_data.str().size());
+
+	// Skipping defaults needs a bitmap per object so the objects are written one at a time
+	std::stringstream sparse_data, single_data;
+	serialise::SaveBinaryBatch(sparse_data, &src[0].object, nb_objects, sizeof(TestBatchEntry), type, serialise::FLAG_SKIP_DEFAULTS);
+	for (int i = 0; i < nb_objects; i++)
+		serialise::SaveBinary(single_data, &src[i].object, type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(sparse_data.str() == single_data.str());
+
+	TestBatchEntry sparse_dst[nb_objects];
+	serialise::LoadBinaryBatch(sparse_data, &sparse_dst[0].object, nb_objects, sizeof(TestBatchEntry), type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(sparse_dst[4].object.name == "xxxx" && sparse_dst[4].object.tags == src[4].object.tags);
+	TEST_ASSERT(sparse_dst[0].object.scale == 0.0f && sparse_dst[0].object.enabled);
+}
+
+
+void SetJobIndex(void* data, int index)
+{
+	((int*)data)[index] += index;
+}
+
+
+void TestParallel(rflb::TypeDatabase& db)
+{
+	printf("\nTestParallel\n\n");
+
+	// Every job runs exactly once, including over repeated runs
+	rflb::ThreadPool pool(4);
+	TEST_ASSERT(pool.GetNbThreads() == 4);
+	std::vector<int> job_values(1000, 0);
+	pool.Run(SetJobIndex, &job_values[0], (int)job_values.size());
+	pool.Run(SetJobIndex, &job_values[0], 10);
+	bool all_run = true;
+	for (int i = 0; i < (int)job_values.size(); i++)
+		all_run &= job_values[i] == (i < 10 ? i * 2 : i);
+	TEST_ASSERT(all_run);
+
+	const rflb::Type* type = &db.GetType<TestSparse>();
+	std::vector<TestSparse> src(1000);
+	for (int i = 0; i < (int)src.size(); i++)
+	{
+		src[i].id = i;
+		src[i].name = std::string(i % 7, 'a' + i % 26);
+		src[i].tags.assign(i % 5, i);
+		src[i].enabled = (i & 1) != 0;
+	}
+
+	// The output doesn't depend on which threads saved which chunks
+	std::stringstream parallel_data, serial_data;
+	rflb::SerialJobRunner serial;
+	serialise::SaveBinaryParallel(parallel_data, &src[0], (int)src.size(), sizeof(TestSparse), type, pool, 64);
+	serialise::SaveBinaryParallel(serial_data, &src[0], (int)src.size(), sizeof(TestSparse), type, serial, 64);
+	TEST_ASSERT(parallel_data.str() == serial_data.str());
+
+	std::vector<TestSparse> dst(src.size());
+	serialise::LoadBinaryParallel(parallel_data, &dst[0], (int)dst.size(), sizeof(TestSparse), type, pool);
+	bool equal = true;
+	for (int i = 0; i < (int)src.size(); i++)
+	{
+		equal &= dst[i].id == src[i].id && dst[i].enabled == src[i].enabled;
+		equal &= dst[i].name == src[i].name && dst[i].tags == src[i].tags;
+	}
+	TEST_ASSERT(equal);
+	TEST_ASSERT(parallel_data.tellg() == (std::streampos)parallel_data.str().size());
+
+	// Skipping defaults builds the presence plans before the jobs start
+	std::stringstream sparse_data;
+	serialise::SaveBinaryParallel(sparse_data, &src[0], (int)src.size(), sizeof(TestSparse), type, pool, 100, serialise::FLAG_SKIP_DEFAULTS);
+	std::vector<TestSparse> sparse_dst(src.size());
+	serialise::LoadBinaryParallel(sparse_data, &sparse_dst[0], (int)sparse_dst.size(), sizeof(TestSparse), type, pool, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(sparse_dst[999].name == src[999].name && sparse_dst[999].tags == src[999].tags);
+
+	// Loading a different number of objects fails
+	std::stringstream short_data(serial_data.str());
+	serialise::LoadBinaryParallel(short_data, &dst[0], 10, sizeof(TestSparse), type, pool);
+	TEST_ASSERT(short_data.fail());
+
+	// Chunk sizes follow the chunk count and size
+	std::string bytes = serial_data.str();
+	u32* chunk_sizes = (u32*)&bytes[sizeof(int) * 2];
+
+	// Offsets that wrap around fail before anything is loaded
+	std::string wrapped = bytes;
+	((u32*)&wrapped[sizeof(int) * 2])[0] = 0xFFFFFFF0;
+	((u32*)&wrapped[sizeof(int) * 2])[1] = 0x20;
+	std::stringstream wrapped_data(wrapped);
+	serialise::LoadBinaryParallel(wrapped_data, &dst[0], (int)dst.size(), sizeof(TestSparse), type, pool);
+	TEST_ASSERT(wrapped_data.fail());
+
+	// Sizes larger than the stream fail once it runs out
+	std::string oversized = bytes;
+	((u32*)&oversized[sizeof(int) * 2])[15] = 0x7FFFFFFF;
+	std::stringstream oversized_data(oversized);
+	serialise::LoadBinaryParallel(oversized_data, &dst[0], (int)dst.size(), sizeof(TestSparse), type, pool);
+	TEST_ASSERT(oversized_data.fail());
+
+	// A chunk that fails to load fails the stream
+	std::string moved = bytes;
+	((u32*)&moved[sizeof(int) * 2])[0] = chunk_sizes[0] - 1;
+	((u32*)&moved[sizeof(int) * 2])[1] = chunk_sizes[1] + 1;
+	std::stringstream moved_data(moved);
+	serialise::LoadBinaryParallel(moved_data, &dst[0], (int)dst.size(), sizeof(TestSparse), type, pool);
+	TEST_ASSERT(moved_data.fail());
+}
+
+
+struct TestLargeFields
+{
+	TestLargeFields() : small(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("small", &TestLargeFields::small),
+			FieldInfo("values", &TestLargeFields::values),
+			FieldInfo("objects", &TestLargeFields::objects),
+			FieldInfo("names", &TestLargeFields::names),
+			FieldInfo("name", &TestLargeFields::name)
+		};
+		db.SetTypeFields<TestLargeFields>(fields);
+	}
+
+	int small;
+	std::vector<int> values;
+	std::vector<TestSparse> objects;
+	std::map<int, std::string> names;
+	std::string name;
+};
+
+
+void TestParallelFields(rflb::TypeDatabase& db)
+{
+	printf("\nTestParallelFields\n\n");
+
+	TestLargeFields::Register(db);
+	const rflb::Type* type = &db.GetType<TestLargeFields>();
+
+	TestLargeFields src;
+	src.small = 42;
+	src.name = "Mort";
+	for (int i = 0; i < 2000; i++)
+	{
+		src.values.push_back(i * 3);
+		src.names[i] = std::string(i % 9, 'n');
+	}
+	src.objects.resize(300);
+	for (int i = 0; i < (int)src.objects.size(); i++)
+	{
+		src.objects[i].id = i;
+		src.objects[i].tags.assign(i % 4, i);
+	}
+
+	// A second object follows to check the stream is left at the end of the first
+	std::stringstream data;
+	serialise::SaveBinaryIFFV(data, &src, type);
+	serialise::SaveBinaryIFFV(data, &src, type, serialise::FLAG_FIELD_INDEX);
+
+	rflb::ThreadPool pool(3);
+	TestLargeFields dst, dst2;
+	serialise::LoadBinaryIFFVParallel(data, &dst, type, pool, 1024);
+	serialise::LoadBinaryIFFVParallel(data, &dst2, type, pool, 1024);
+	TEST_ASSERT(!data.fail());
+	TEST_ASSERT(data.tellg() == (std::streampos)data.str().size());
+
+	bool objects_equal = dst.objects.size() == src.objects.size();
+	for (int i = 0; objects_equal && i < (int)src.objects.size(); i++)
+		objects_equal = dst.objects[i].id == i && dst.objects[i].tags == src.objects[i].tags;
+	TEST_ASSERT(objects_equal);
+	TEST_ASSERT(dst.small == 42 && dst.name == "Mort");
+	TEST_ASSERT(dst.values == src.values);
+	TEST_ASSERT(dst.names == src.names);
+	TEST_ASSERT(dst2.values == src.values && dst2.names == src.names && dst2.objects.size() == src.objects.size());
+
+	// Field sizes past the end of truncated data fail the stream without loading anything deferred
+	std::string first = data.str().substr(0, data.str().size() / 2);
+	std::stringstream truncated(first.substr(0, first.size() / 2));
+	TestLargeFields dst3;
+	serialise::LoadBinaryIFFVParallel(truncated, &dst3, type, pool, 0);
+	TEST_ASSERT(truncated.fail());
+	TEST_ASSERT(dst3.objects.empty() && dst3.names.empty());
+}
+
+
+struct TestTreeNode
+{
+	TestTreeNode() : value(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("value", &TestTreeNode::value),
+			FieldInfo("children", &TestTreeNode::children),
+			FieldInfo("points", &TestTreeNode::points)
+		};
+		db.SetTypeFields<TestTreeNode>(fields);
+	}
+
+	int value;
+	std::vector<TestTreeNode> children;
+	std::map<std::string, TestVector> points;
+};
+
+
+void TestBinaryEngine(rflb::TypeDatabase& db)
+{
+	printf("\nTestBinaryEngine\n\n");
+
+	TestTreeNode::Register(db);
+	const rflb::Type* type = &db.GetType<TestTreeNode>();
+
+	// A deep chain of nodes, with a few siblings and map entries along the way
+	const int depth = 1000;
+	TestTreeNode root;
+	TestTreeNode* node = &root;
+	for (int i = 0; i < depth; i++)
+	{
+		node->value = i;
+		if (i % 100 == 0)
+			node->points["corner"] = TestVector(i, -i);
+		node->children.resize(i % 10 == 0 ? 2 : 1);
+		node->children.back().value = -i;
+		node = &node->children[0];
+	}
+
+	std::stringstream engine_data, recursive_data;
+	serialise::BinaryEngine engine;
+	engine.Save(engine_data, &root, type);
+	serialise::SaveBinary(recursive_data, &root, type);
+	TEST_ASSERT(engine_data.str() == recursive_data.str());
+
+	TestTreeNode loaded;
+	engine.Load(engine_data, &loaded, type);
+	TEST_ASSERT(engine_data.tellg() == (std::streampos)engine_data.str().size());
+
+	bool equal = true;
+	const TestTreeNode* a = &root;
+	const TestTreeNode* b = &loaded;
+	for (int i = 0; i < depth && equal; i++)
+	{
+		equal = a->value == b->value && a->points == b->points && a->children.size() == b->children.size();
+		equal = equal && a->children.back().value == b->children.back().value;
+		a = &a->children[0];
+		b = &b->children[0];
+	}
+	TEST_ASSERT(equal);
+
+	// The same engine can be reused, with custom serialisers and base types
+	TestDerived derived_src, derived_dst;
+	derived_src.Set();
+	std::stringstream derived_data, derived_recursive_data;
+	engine.Save(derived_data, &derived_src, &db.GetType<TestDerived>());
+	serialise::SaveBinary(derived_recursive_data, &derived_src, &db.GetType<TestDerived>());
+	TEST_ASSERT(derived_data.str() == derived_recursive_data.str());
+	engine.Load(derived_data, &derived_dst, &db.GetType<TestDerived>());
+
+	printf("= BASE ====================================================\n");
+	derived_dst.data.TestAgainst(derived_src.data);
+	printf("= DERIVED =================================================\n");
+	derived_dst.data2.TestAgainst(derived_src.data2);
+	printf("===========================================================\n");
+
+	serialise::ScratchStack scratch;
+	serialise::ScratchStack::Marker marker = scratch.GetMarker();
+	void* small = scratch.Push(10);
+	void* large = scratch.Push(10000);
+	TEST_ASSERT(((size_t)small & 15) == 0 && large != small);
+	scratch.Release(marker);
+	TEST_ASSERT(scratch.Push(10) == small);
+}
+
+
+// Fixed size name that's written without its unused characters, staged through the context's string buffer
+void SaveMessageName(std::ostream& stream, u32, const void* data)
+{
+	int length = (int)strlen((const char*)data);
+	stream.write((const char*)&length, sizeof(length));
+	stream.write((const char*)data, length);
+}
+
+
+void LoadMessageName(std::istream& stream, u32, void* data)
+{
+	std::string& buffer = serialise::GetContext(stream)->GetStringBuffer();
+	int length = 0;
+	stream.read((char*)&length, sizeof(length));
+	buffer.resize(length);
+	stream.read(&buffer[0], length);
+	strcpy((char*)data, buffer.c_str());
+}
+
+
+struct TestMessage
+{
+	TestMessage() : id(0)
+	{
+		name[0] = 0;
+	}
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("id", &TestMessage::id),
+			FieldInfo("name", &TestMessage::name).LoadSaveBinary(LoadMessageName, SaveMessageName),
+			FieldInfo("values", &TestMessage::values),
+			FieldInfo("positions", &TestMessage::positions)
+		};
+		db.SetTypeFields<TestMessage>(fields);
+	}
+
+	int id;
+	char name[16];
+	std::vector<int> values;
+	std::map<int, TestVector> positions;
+};
+
+
+void TestSerialiseContext(rflb::TypeDatabase& db)
+{
+	printf("\nTestSerialiseContext\n\n");
+
+	TestMessage::Register(db);
+	const rflb::Type* type = &db.GetType<TestMessage>();
+
+	// A stream of messages, saved without a context
+	std::stringstream data;
+	for (int i = 0; i < 20; i++)
+	{
+		TestMessage message;
+		message.id = i;
+		sprintf(message.name, "message%d", i);
+		message.values.assign(i, i);
+		message.positions[i] = TestVector(i, i);
+		serialise::SaveBinary(data, &message, type);
+	}
+
+	serialise::SerialiseContext context;
+	TEST_ASSERT(serialise::GetContext(data) == 0);
+	context.Attach(data);
+	TEST_ASSERT(serialise::GetContext(data) == &context);
+
+	// Each message is loaded into the same object, with the custom loader finding the context
+	bool all_loaded = true;
+	for (int i = 0; i < 20; i++)
+	{
+		TestMessage message;
+		serialise::LoadBinary(data, &message, type);
+		char name[16];
+		sprintf(name, "message%d", i);
+		all_loaded &= message.id == i && strcmp(message.name, name) == 0;
+		all_loaded &= (int)message.values.size() == i && message.positions[i] == TestVector(i, i);
+	}
+	TEST_ASSERT(all_loaded);
+	TEST_ASSERT(data.tellg() == (std::streampos)data.str().size());
+
+	// Saving through the context's engine writes the same bytes
+	TestDerived derived;
+	derived.Set();
+	std::stringstream context_data, plain_data;
+	context.Attach(context_data);
+	serialise::SaveBinary(context_data, &derived, &db.GetType<TestDerived>());
+	serialise::SaveBinary(plain_data, &derived, &db.GetType<TestDerived>());
+	TEST_ASSERT(context_data.str() == plain_data.str());
+
+	TEST_ASSERT(context.AddObject(&derived) == 0);
+	TEST_ASSERT(context.GetObject(0) == &derived && context.GetObject(1) == 0);
+
+	serialise::SerialiseContext::Detach(data);
+	serialise::SerialiseContext::Detach(context_data);
+	TEST_ASSERT(serialise::GetContext(data) == 0);
+}
+
+
+void TestReload(rflb::TypeDatabase& db)
+{
+	printf("\nTestReload\n\n");
+
+	const rflb::Type* type = &db.GetType<TestMessage>();
+
+	TestMessage src;
+	src.id = 1;
+	strcpy(src.name, "reloaded");
+	src.values.assign(5, 7);
+	src.positions[1] = TestVector(1, 1);
+	src.positions[3] = TestVector(3, 3);
+	std::stringstream data;
+	serialise::SaveBinary(data, &src, type);
+
+	// The name loader stages through the context
+	serialise::SerialiseContext context;
+	context.Attach(data);
+
+	// Existing contents that are larger than the data, with some keys in common
+	TestMessage dst;
+	dst.values.assign(100, 1);
+	dst.positions[0] = TestVector(0, 0);
+	dst.positions[1] = TestVector(-1, -1);
+	dst.positions[2] = TestVector(-2, -2);
+	dst.positions[4] = TestVector(-4, -4);
+	const int* values = &dst.values[0];
+	const TestVector* position = &dst.positions[1];
+
+	serialise::LoadBinary(data, &dst, type, serialise::FLAG_RELOAD);
+	TEST_ASSERT(dst.id == src.id && strcmp(dst.name, src.name) == 0);
+	TEST_ASSERT(dst.values == src.values && dst.positions == src.positions);
+	TEST_ASSERT(&dst.values[0] == values && dst.values.capacity() == 100);
+	TEST_ASSERT(&dst.positions[1] == position);
+
+	// Growing past the existing contents
+	TestMessage small;
+	small.values.assign(2, 3);
+	data.seekg(0);
+	serialise::LoadBinary(data, &small, type, serialise::FLAG_RELOAD);
+	TEST_ASSERT(small.values == src.values && small.positions == src.positions);
+	serialise::SerialiseContext::Detach(data);
+
+	// Nested containers reuse their memory too, with or without columns
+	TestTreeNode tree_src;
+	tree_src.children.resize(2);
+	tree_src.children[1].children.resize(3);
+	tree_src.children[1].points["a"] = TestVector(1, 2);
+	TestTreeNode tree_dst;
+	tree_dst.children.resize(4);
+	tree_dst.children[1].children.resize(10);
+	tree_dst.children[1].points["b"] = TestVector(3, 4);
+	const TestTreeNode* grandchildren = &tree_dst.children[1].children[0];
+
+	std::stringstream tree_data;
+	serialise::SaveBinary(tree_data, &tree_src, &db.GetType<TestTreeNode>());
+	serialise::LoadBinary(tree_data, &tree_dst, &db.GetType<TestTreeNode>(), serialise::FLAG_RELOAD);
+	TEST_ASSERT(tree_dst.children.size() == 2 && tree_dst.children[1].children.size() == 3);
+	TEST_ASSERT(&tree_dst.children[1].children[0] == grandchildren);
+	TEST_ASSERT(tree_dst.children[1].points == tree_src.children[1].points);
+
+	Vectors vectors_src, vectors_dst;
+	vectors_src.Set();
+	vectors_dst.Set();
+	vectors_dst.pod_vector.resize(50);
+	const TestVector* pods = &vectors_dst.pod_vector[0];
+	std::stringstream columnar_data;
+	serialise::SaveBinary(columnar_data, &vectors_src, &db.GetType<Vectors>(), serialise::FLAG_COLUMNAR);
+	serialise::LoadBinary(columnar_data, &vectors_dst, &db.GetType<Vectors>(), serialise::FLAG_COLUMNAR | serialise::FLAG_RELOAD);
+	TEST_ASSERT(vectors_dst.pod_vector == vectors_src.pod_vector && &vectors_dst.pod_vector[0] == pods);
+	TEST_ASSERT(vectors_dst.string_vector == vectors_src.string_vector);
+}
+
+
+void TestTypePool(rflb::TypeDatabase& db)
+{
+	printf("\nTestTypePool\n\n");
+
+	const rflb::Type* type = &db.GetType<TestMessage>();
+	TEST_ASSERT(db.GetType<char>().GetAlignment() == 1);
+	TEST_ASSERT(type->GetAlignment() == sizeof(void*));
+
+	// Arrays are constructed and destructed with one call
+	std::vector<char> memory(type->GetSize() * 10);
+	type->ConstructArray(&memory[0], 10);
+	TestMessage* messages = (TestMessage*)&memory[0];
+	messages[9].values.assign(100, 1);
+	TEST_ASSERT(messages[0].id == 0 && messages[9].name[0] == 0);
+	type->DestructArray(&memory[0], 10);
+
+	rflb::TypePool pool(type, 16);
+	TEST_ASSERT(pool.GetType() == type);
+
+	// Objects span several slabs and are default constructed
+	std::vector<TestMessage*> objects;
+	bool all_default = true;
+	for (int i = 0; i < 100; i++)
+	{
+		TestMessage* object = (TestMessage*)pool.New();
+		all_default &= object->id == 0 && object->values.empty() && ((size_t)object & (sizeof(void*) - 1)) == 0;
+		object->id = i;
+		object->values.assign(i, i);
+		objects.push_back(object);
+	}
+	TEST_ASSERT(all_default);
+	TEST_ASSERT(objects[14] + 1 == objects[15] && objects[99]->id == 99);
+
+	// Freed objects are reused
+	pool.Delete(objects[50]);
+	TEST_ASSERT(pool.New() == objects[50]);
+	for (size_t i = 0; i < objects.size(); i++)
+		pool.Delete(objects[i]);
+
+	// Arrays are adjacent, even when larger than a slab
+	TestMessage* array = (TestMessage*)pool.NewArray(40);
+	array[39].values.assign(10, 1);
+	TEST_ASSERT(array[0].id == 0 && array[39].positions.empty());
+	pool.DeleteArray(array, 40);
+
+	// Types smaller than a pointer are packed in arrays
+	rflb::TypePool short_pool(&db.GetType<short>());
+	short* shorts = (short*)short_pool.NewArray(5);
+	shorts[4] = 4;
+	short* single = (short*)short_pool.New();
+	TEST_ASSERT((char*)single >= (char*)(shorts + 5));
+	short_pool.DeleteArray(shorts, 5);
+	short_pool.Delete(single);
+}
+
+
+struct TestUntrusted
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("names", &TestUntrusted::names)
+		};
+		db.SetTypeFields<TestUntrusted>(fields);
+	}
+
+	std::vector<std::string> names;
+};
+
+
+const rflb::Type* g_UntrustedType = 0;
+
+void LoadNestedUntrusted(std::istream& stream, u32, void* data)
+{
+	serialise::LoadBinary(stream, data, g_UntrustedType);
+}
+
+void SaveNestedUntrusted(std::ostream& stream, u32, const void* data)
+{
+	serialise::SaveBinary(stream, data, g_UntrustedType);
+}
+
+
+// Loaded through a custom serialiser that makes a nested load
+struct TestNestedUntrusted
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("inner", &TestNestedUntrusted::inner).LoadSaveBinary(LoadNestedUntrusted, SaveNestedUntrusted)
+		};
+		db.SetTypeFields<TestNestedUntrusted>(fields);
+	}
+
+	TestUntrusted inner;
+};
+
+
+void TestBoundedLoad(rflb::TypeDatabase& db)
+{
+	printf("\nTestBoundedLoad\n\n");
+
+	TestUntrusted::Register(db);
+	const rflb::Type* type = &db.GetType<TestUntrusted>();
+
+	TestUntrusted src;
+	src.names.push_back("first");
+	src.names.push_back("second");
+	std::stringstream data;
+	serialise::SaveBinary(data, &src, type);
+	std::string bytes = data.str();
+
+	// Intact data loads the same as without a bound
+	TestUntrusted dst;
+	TEST_ASSERT(serialise::LoadBinaryBounded(data, &dst, type, (u32)bytes.size()) == serialise::LOAD_STATUS_COMPLETE);
+	TEST_ASSERT(dst.names == src.names);
+
+	// Truncated data
+	std::stringstream truncated(bytes.substr(0, bytes.size() - 2));
+	TestUntrusted truncated_dst;
+	TEST_ASSERT(serialise::LoadBinaryBounded(truncated, &truncated_dst, type, (u32)bytes.size()) == serialise::LOAD_STATUS_NEED_MORE_DATA);
+
+	// A container count that couldn't fit in what's left is rejected before anything is added
+	std::string corrupt_count = bytes;
+	*(int*)&corrupt_count[0] = 0x7fffffff;
+	std::stringstream count_data(corrupt_count);
+	TestUntrusted count_dst;
+	TEST_ASSERT(serialise::LoadBinaryBounded(count_data, &count_dst, type, (u32)bytes.size()) == serialise::LOAD_STATUS_ERROR);
+	TEST_ASSERT(count_dst.names.empty() && count_data.fail());
+
+	*(int*)&corrupt_count[0] = -1;
+	std::stringstream negative_data(corrupt_count);
+	TEST_ASSERT(serialise::LoadBinaryBounded(negative_data, &count_dst, type, (u32)bytes.size()) == serialise::LOAD_STATUS_ERROR);
+
+	// Custom loaders check their own counts, such as the string length
+	std::string corrupt_length = bytes;
+	*(int*)&corrupt_length[sizeof(int)] = 1000000;
+	std::stringstream length_data(corrupt_length);
+	TestUntrusted length_dst;
+	TEST_ASSERT(serialise::LoadBinaryBounded(length_data, &length_dst, type, (u32)bytes.size()) == serialise::LOAD_STATUS_ERROR);
+	TEST_ASSERT(length_dst.names.size() == 2 && length_dst.names[0].empty());
+
+	// The bound applies even when the stream has more data
+	std::stringstream short_bound(bytes);
+	TEST_ASSERT(serialise::LoadBinaryBounded(short_bound, &dst, type, 10) == serialise::LOAD_STATUS_ERROR);
+
+	// Nested loads run on the engine of an attached context, which checks counts the same way
+	g_UntrustedType = type;
+	TestNestedUntrusted::Register(db);
+	*(int*)&corrupt_count[0] = 0x7fffffff;
+	std::stringstream nested_data(corrupt_count);
+	serialise::SerialiseContext context;
+	context.Attach(nested_data);
+	TestNestedUntrusted nested_dst;
+	TEST_ASSERT(serialise::LoadBinaryBounded(nested_data, &nested_dst, &db.GetType<TestNestedUntrusted>(), (u32)bytes.size()) == serialise::LOAD_STATUS_ERROR);
+	TEST_ASSERT(nested_dst.inner.names.empty());
+	serialise::SerialiseContext::Detach(nested_data);
+
+	// Custom serialisers could write nothing
+	TEST_ASSERT(db.GetType<TestVector>().GetMinBinarySize(rflb::PROFILE_ALL) == sizeof(int) * 2);
+	TEST_ASSERT(type->GetMinBinarySize(rflb::PROFILE_ALL) == sizeof(int));
+	TEST_ASSERT(db.GetType<TestNestedUntrusted>().GetMinBinarySize(rflb::PROFILE_ALL) == 0);
+
+	// Outside of bounded loads nothing is checked
+	std::stringstream unbounded(bytes);
+	TEST_ASSERT(serialise::CheckBound(unbounded, 0x7fffffff, 100));
+
+	// Negative counts in unbounded loads add nothing, with or without the engine
+	*(int*)&corrupt_count[0] = -1;
+	std::stringstream unbounded_negative(corrupt_count);
+	TestUntrusted unbounded_dst;
+	serialise::LoadBinary(unbounded_negative, &unbounded_dst, type);
+	TEST_ASSERT(unbounded_dst.names.empty());
+	std::stringstream reload_negative(corrupt_count);
+	unbounded_dst.names = src.names;
+	serialise::LoadBinary(reload_negative, &unbounded_dst, type, serialise::FLAG_RELOAD);
+	TEST_ASSERT(unbounded_dst.names.empty());
+	std::stringstream engine_negative(corrupt_count);
+	context.Attach(engine_negative);
+	TestNestedUntrusted engine_dst;
+	serialise::LoadBinary(engine_negative, &engine_dst, &db.GetType<TestNestedUntrusted>());
+	TEST_ASSERT(engine_dst.inner.names.empty());
+	serialise::SerialiseContext::Detach(engine_negative);
+}
+
+
+struct TestSecondBase
+{
+	TestSecondBase() : weight(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("weight", &TestSecondBase::weight),
+			FieldInfo("tags", &TestSecondBase::tags)
+		};
+		db.SetTypeFields<TestSecondBase>(fields);
+	}
+
+	float weight;
+	std::vector<int> tags;
+};
+
+
+struct TestMultipleBases : public TestVector, public TestSecondBase
+{
+	TestMultipleBases() : id(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("id", &TestMultipleBases::id),
+			FieldInfo("name", &TestMultipleBases::name)
+		};
+		db.SetTypeFields<TestMultipleBases>(fields);
+		db.SetTypeBase<TestMultipleBases, TestVector>();
+		db.SetTypeBase<TestMultipleBases, TestSecondBase>();
+	}
+
+	void Set()
+	{
+		x = 1;
+		y = 2;
+		weight = 3.5f;
+		tags.push_back(4);
+		tags.push_back(5);
+		id = 6;
+		name = "seven";
+	}
+
+	bool operator == (const TestMultipleBases& rhs) const
+	{
+		return x == rhs.x && y == rhs.y && weight == rhs.weight && tags == rhs.tags && id == rhs.id && name == rhs.name;
+	}
+
+	int id;
+	std::string name;
+};
+
+
+void TestInheritance(rflb::TypeDatabase& db)
+{
+	printf("\nTestInheritance\n\n");
+
+	TestSecondBase::Register(db);
+	TestMultipleBases::Register(db);
+	const rflb::Type* type = &db.GetType<TestMultipleBases>();
+
+	TestMultipleBases src;
+	src.Set();
+	u32 second_offset = (u32)((char*)static_cast<TestSecondBase*>(&src) - (char*)&src);
+	TEST_ASSERT(type->GetNbBaseTypes() == 2 && type->GetBaseOffset(0) == 0);
+	TEST_ASSERT(type->GetBaseOffset(1) == second_offset && second_offset != 0);
+
+	// The flattened fields of the whole hierarchy have offsets from the start of the derived type
+	const rflb::FieldList& fields = type->GetFlattenedFields(rflb::PROFILE_ALL);
+	TEST_ASSERT(fields.size() == 6);
+	bool found_weight = false;
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		if (fields[i]->m_Name == rflb::Name("weight"))
+			found_weight = (char*)&src + fields[i]->m_Offset == (char*)&src.weight;
+	}
+	TEST_ASSERT(found_weight);
+
+	// Every walk of the object finds the fields of the second base where they are
+	std::stringstream binary_data, engine_data;
+	serialise::SaveBinary(binary_data, &src, type);
+	serialise::BinaryEngine engine;
+	engine.Save(engine_data, &src, type);
+	TEST_ASSERT(binary_data.str() == engine_data.str());
+	TestMultipleBases binary_dst, engine_dst;
+	serialise::LoadBinary(binary_data, &binary_dst, type);
+	engine.Load(engine_data, &engine_dst, type);
+	TEST_ASSERT(binary_dst == src && engine_dst == src);
+
+	std::stringstream iffv_data;
+	serialise::SaveBinaryIFFV(iffv_data, &src, type);
+	TestMultipleBases iffv_dst;
+	serialise::LoadBinaryIFFV(iffv_data, &iffv_dst, type);
+	TEST_ASSERT(iffv_dst == src);
+
+	std::stringstream sparse_data;
+	serialise::SaveBinary(sparse_data, &src, type, serialise::FLAG_SKIP_DEFAULTS);
+	TestMultipleBases sparse_dst;
+	serialise::LoadBinary(sparse_data, &sparse_dst, type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(sparse_dst == src);
+
+	std::stringstream packed_data;
+	serialise::SavePacked(packed_data, &src, type);
+	TestMultipleBases packed_dst;
+	serialise::LoadPacked(packed_data, &packed_dst, type);
+	TEST_ASSERT(packed_dst == src);
+
+	TestMultipleBases copy;
+	rflb::CopyObject(&copy, &src, type);
+	TEST_ASSERT(copy == src && rflb::EqualObjects(&copy, &src, type));
+	copy.tags[1] = 0;
+	TEST_ASSERT(!rflb::EqualObjects(&copy, &src, type));
+
+	rflb::FieldPath tag;
+	TEST_ASSERT(tag.Resolve<TestMultipleBases>(db, "tags[1]"));
+	TEST_ASSERT(tag.Get<int>(&src) == 5);
+
+	rflb::ReflectedTable table(type);
+	TestMultipleBases row;
+	table.GetRow(table.AddRow(&src), &row);
+	TEST_ASSERT(row == src);
+}
+
+
+size_t MeasureString(const void* object)
+{
+	// Short strings can be stored inside the object
+	const std::string& string = *(const std::string*)object;
+	const char* data = string.data();
+	if (data >= (const char*)object && data < (const char*)object + sizeof(std::string))
+		return 0;
+	return string.capacity() + 1;
+}
+
+
+void TestMeasure(rflb::TypeDatabase& db)
+{
+	printf("\nTestMeasure\n\n");
+
+	const rflb::Type* string_type = &db.GetType<std::string>();
+	const rflb::Type* int_type = &db.GetType<int>();
+	db.GetType<std::string>().CustomMeasure(MeasureString);
+
+	TestLargeFields object;
+	object.values.reserve(100);
+	object.values.assign(10, 1);
+	object.objects.resize(1000);
+	for (int i = 0; i < 1000; i++)
+		object.objects[i].tags.assign(3, i);
+	object.names[1] = "x";
+	object.names[2] = std::string(64, 'x');
+	object.name = std::string(100, 'y');
+	size_t string_size = MeasureString(&object.names[1]) + MeasureString(&object.names[2]) + MeasureString(&object.name);
+
+	rflb::MemoryFootprint footprint = rflb::MeasureObject(&object, &db.GetType<TestLargeFields>());
+	TEST_ASSERT(!footprint.m_IsEstimate);
+	TEST_ASSERT(footprint.m_InlineSize == sizeof(TestLargeFields));
+	TEST_ASSERT(footprint.m_Types[int_type].m_NbObjects == 3010);
+	TEST_ASSERT(footprint.m_Types[int_type].m_HeapSize == 100 * sizeof(int) + 3000 * sizeof(int));
+	TEST_ASSERT(footprint.m_Types[&db.GetType<TestSparse>()].m_NbObjects == 1000);
+	TEST_ASSERT(footprint.m_Types[&db.GetType<TestSparse>()].m_HeapSize == object.objects.capacity() * sizeof(TestSparse));
+
+	// Map nodes are counted against the value type along with what the strings own
+	size_t map_size = footprint.m_Types[string_type].m_HeapSize - string_size;
+	TEST_ASSERT(footprint.m_Types[string_type].m_NbObjects == 2);
+	TEST_ASSERT(map_size >= 2 * sizeof(std::pair<const int, std::string>));
+	TEST_ASSERT(footprint.m_OverheadSize == map_size - 2 * sizeof(std::pair<const int, std::string>));
+	TEST_ASSERT(footprint.m_OverheadSize > 0);
+	TEST_ASSERT(footprint.m_UnusedSize == 90 * sizeof(int) + (object.objects.capacity() - 1000) * sizeof(TestSparse));
+	TEST_ASSERT(footprint.m_HeapSize == 3100 * sizeof(int) + object.objects.capacity() * sizeof(TestSparse) + map_size + string_size);
+
+	// Sampling values that all own the same amount gives the same result
+	rflb::MemoryFootprint sampled = rflb::MeasureObject(&object, &db.GetType<TestLargeFields>(), 10);
+	TEST_ASSERT(sampled.m_IsEstimate);
+	TEST_ASSERT(sampled.m_HeapSize == footprint.m_HeapSize);
+	TEST_ASSERT(sampled.m_Types[int_type].m_NbObjects == 3010);
+
+	// Samples cover the whole container when the count isn't a multiple of them
+	TestLargeFields uneven;
+	uneven.objects.resize(1000);
+	for (int i = 500; i < 1000; i++)
+		uneven.objects[i].tags.assign(4, i);
+	size_t exact_size = rflb::MeasureObject(&uneven, &db.GetType<TestLargeFields>()).m_Types[int_type].m_HeapSize;
+	size_t sampled_size = rflb::MeasureObject(&uneven, &db.GetType<TestLargeFields>(), 600).m_Types[int_type].m_HeapSize;
+	TEST_ASSERT(sampled_size > exact_size * 95 / 100 && sampled_size < exact_size * 105 / 100);
+
+	// Types without fields or a measure function own nothing
+	db.GetType<std::string>().CustomMeasure(0);
+	footprint = rflb::MeasureObject(&object, &db.GetType<TestLargeFields>());
+	TEST_ASSERT(footprint.m_Types[string_type].m_HeapSize == map_size);
+}
+
+
+struct TestLayout
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("a", &TestLayout::a).Profiles(2),
+			FieldInfo("b", &TestLayout::b).Profiles(1),
+			FieldInfo("values", &TestLayout::values).Profiles(1),
+			FieldInfo("c", &TestLayout::c).Profiles(1),
+			FieldInfo("d", &TestLayout::d).Profiles(1),
+			FieldInfo("e", &TestLayout::e).Profiles(2)
+		};
+		db.SetTypeFields<TestLayout>(fields);
+	}
+
+	char a;
+	double b;
+	int values[16];
+	char c;
+	int d;
+	short e;
+};
+
+
+struct TestPadded
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("a", &TestPadded::a),
+			FieldInfo("b", &TestPadded::b)
+		};
+		db.SetTypeFields<TestPadded>(fields);
+	}
+
+	char a;
+	int b;
+};
+
+
+void TestLayoutAnalysis(rflb::TypeDatabase& db)
+{
+	printf("\nTestLayoutAnalysis\n\n");
+
+	TestLayout::Register(db);
+	TestPadded::Register(db);
+
+	// Holes after a, c and at the end
+	rflb::LayoutReport report = rflb::AnalyseLayout(&db.GetType<TestLayout>(), 2);
+	TEST_ASSERT(report.m_Holes.size() == 3);
+	TEST_ASSERT(report.m_Holes[0].m_Offset == 1 && report.m_Holes[0].m_Size == 7);
+	TEST_ASSERT(report.m_Holes[1].m_Offset == 81 && report.m_Holes[1].m_Size == 3);
+	TEST_ASSERT(report.m_Holes[2].m_Offset == 90 && report.m_Holes[2].m_Size == 6);
+	TEST_ASSERT(report.m_PaddingSize == 16);
+	TEST_ASSERT(report.m_NbCacheLines == 2);
+	TEST_ASSERT(report.m_NbHotCacheLines == 2);
+
+	// Hot fields move to the front and the rest are packed by alignment
+	TEST_ASSERT(report.m_SuggestedSize == 88);
+	TEST_ASSERT(report.m_SuggestedNbCacheLines == 2);
+	TEST_ASSERT(report.m_SuggestedNbHotCacheLines == 1);
+	TEST_ASSERT(report.m_SuggestedOrder.size() == 6);
+	const char* order[] = { "e", "a", "b", "values", "d", "c" };
+	bool in_order = true;
+	for (int i = 0; i < 6; i++)
+		in_order &= report.m_SuggestedOrder[i]->m_Name == rflb::Name(order[i]);
+	TEST_ASSERT(in_order);
+
+	// Without hot fields, only size matters
+	report = rflb::AnalyseLayout(&db.GetType<TestLayout>());
+	TEST_ASSERT(report.m_NbHotCacheLines == 0);
+	TEST_ASSERT(report.m_SuggestedSize == 80);
+	TEST_ASSERT(report.m_SuggestedOrder[0]->m_Name == rflb::Name("b"));
+
+	report = rflb::AnalyseLayout(&db.GetType<TestPadded>());
+	TEST_ASSERT(report.m_PaddingSize == 3);
+	TEST_ASSERT(report.m_IsBlockWithoutPadding);
+	TEST_ASSERT(report.m_SuggestedSize == sizeof(TestPadded));
+
+	// Nothing to improve
+	report = rflb::AnalyseLayout(&db.GetType<TestVector>());
+	TEST_ASSERT(report.m_Holes.empty() && report.m_PaddingSize == 0);
+	TEST_ASSERT(!report.m_IsBlockWithoutPadding);
+	TEST_ASSERT(report.m_SuggestedSize == sizeof(TestVector));
+	TEST_ASSERT(report.m_SuggestedOrder[0]->m_Name == rflb::Name("x"));
+
+	// Base types are a single block
+	report = rflb::AnalyseLayout(&db.GetType<TestMultipleBases>());
+	TEST_ASSERT(report.m_PaddingSize == sizeof(TestMultipleBases) - sizeof(TestSecondBase) - sizeof(TestVector) - sizeof(int) - sizeof(std::string));
+
+	std::vector<rflb::LayoutReport> reports;
+	rflb::AnalyseLayouts(db, reports);
+	bool sorted = true;
+	bool found = false;
+	for (size_t i = 0; i < reports.size(); i++)
+	{
+		sorted &= i == 0 || reports[i - 1].m_PaddingSize >= reports[i].m_PaddingSize;
+		found |= reports[i].m_Type == &db.GetType<TestLayout>();
+	}
+	TEST_ASSERT(sorted && found);
+
+	std::stringstream stream;
+	rflb::PrintLayout(stream, rflb::AnalyseLayout(&db.GetType<TestLayout>()));
+	TEST_ASSERT(stream.str().find("\t81\t3\tpadding\n") != std::string::npos);
+	TEST_ASSERT(stream.str().find("suggested order, 80 bytes, 2 cache lines: b, values, d, e, a, c\n") != std::string::npos);
+}
+
+
+int g_NbCheckedLoads = 0;
+
+// Appends whatever it reads, so a retry on an object that wasn't reset would repeat text
+void LoadCheckedText(std::istream& stream, u32, void* data)
+{
+	g_NbCheckedLoads++;
+	std::string& text = *(std::string*)data;
+	int length = 0;
+	stream.read((char*)&length, sizeof(length));
+	if (!stream)
+		return;
+	if (length < 0)
+	{
+		stream.setstate(std::ios_base::failbit);
+		return;
+	}
+	std::vector<char> buffer(length);
+	stream.read(&buffer[0], length);
+	text.append(&buffer[0], (size_t)stream.gcount());
+}
+
+void SaveCheckedText(std::ostream& stream, u32, const void* data)
+{
+	const std::string& text = *(const std::string*)data;
+	int length = (int)text.size();
+	stream.write((const char*)&length, sizeof(length));
+	stream.write(text.data(), length);
+}
+
+
+struct TestChecked
+{
+	TestChecked() : after(0) { }
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("text", &TestChecked::text).LoadSaveBinary(LoadCheckedText, SaveCheckedText),
+			FieldInfo("after", &TestChecked::after)
+		};
+		db.SetTypeFields<TestChecked>(fields);
+	}
+
+	std::string text;
+	int after;
+};
+
+
+serialise::LoadStatus FeedBytes(serialise::IncrementalLoader& loader, const std::string& data, u32 fragment_size)
+{
+	serialise::LoadStatus status = serialise::LOAD_STATUS_NEED_MORE_DATA;
+	for (size_t position = 0; status == serialise::LOAD_STATUS_NEED_MORE_DATA && position < data.size(); position += fragment_size)
+	{
+		u32 size = (u32)(data.size() - position < fragment_size ? data.size() - position : fragment_size);
+		status = loader.Feed(data.data() + position, size);
+	}
+	return status;
+}
+
+
+void TestIncrementalUntrusted(rflb::TypeDatabase& db)
+{
+	printf("\nTestIncrementalUntrusted\n\n");
+
+	const rflb::Type* type = &db.GetType<TestUntrusted>();
+	TestUntrusted src;
+	src.names.push_back("first");
+	src.names.push_back("second");
+	std::stringstream data;
+	serialise::SaveBinary(data, &src, type);
+	std::string bytes = data.str();
+
+	serialise::IncrementalLoader loader;
+	TestUntrusted dst;
+	loader.Begin(&dst, type, rflb::SERIALISE_METHOD_BINARY, rflb::PROFILE_ALL, (u32)bytes.size());
+	TEST_ASSERT(FeedBytes(loader, bytes, 3) == serialise::LOAD_STATUS_COMPLETE);
+	TEST_ASSERT(dst.names == src.names);
+
+	// Negative counts always fail
+	std::string corrupt_count = bytes;
+	*(int*)&corrupt_count[0] = -1;
+	TestUntrusted negative_dst;
+	loader.Begin(&negative_dst, type);
+	TEST_ASSERT(FeedBytes(loader, corrupt_count, 3) == serialise::LOAD_STATUS_ERROR);
+	TEST_ASSERT(negative_dst.names.empty());
+
+	// Counts that can't fit in the object are rejected when its size is known
+	*(int*)&corrupt_count[0] = 0x7fffffff;
+	TestUntrusted count_dst;
+	loader.Begin(&count_dst, type, rflb::SERIALISE_METHOD_BINARY, rflb::PROFILE_ALL, (u32)bytes.size());
+	TEST_ASSERT(FeedBytes(loader, corrupt_count, 3) == serialise::LOAD_STATUS_ERROR);
+	TEST_ASSERT(count_dst.names.empty());
+
+	// Otherwise only as many values are added as there's data for
+	loader.Begin(&count_dst, type);
+	TEST_ASSERT(FeedBytes(loader, corrupt_count, 3) == serialise::LOAD_STATUS_NEED_MORE_DATA);
+	TEST_ASSERT(count_dst.names.size() <= 3);
+
+	TestChecked::Register(db);
+	const rflb::Type* checked_type = &db.GetType<TestChecked>();
+	TestChecked checked_src;
+	checked_src.text = std::string(100, 'a');
+	checked_src.after = 7;
+	std::stringstream checked_data;
+	serialise::SaveBinary(checked_data, &checked_src, checked_type);
+
+	// Custom loads are only retried once there's as much data as the last attempt wanted, on a
+	// freshly constructed object
+	g_NbCheckedLoads = 0;
+	TestChecked checked_dst;
+	loader.Begin(&checked_dst, checked_type);
+	TEST_ASSERT(FeedBytes(loader, checked_data.str(), 1) == serialise::LOAD_STATUS_COMPLETE);
+	TEST_ASSERT(g_NbCheckedLoads == 3);
+	TEST_ASSERT(checked_dst.text == checked_src.text && checked_dst.after == 7);
+
+	// Failing before the end of the data is an error rather than a wait for more
+	std::string corrupt_text = checked_data.str();
+	*(int*)&corrupt_text[0] = -1;
+	TestChecked corrupt_dst;
+	loader.Begin(&corrupt_dst, checked_type);
+	TEST_ASSERT(FeedBytes(loader, corrupt_text, 1000) == serialise::LOAD_STATUS_ERROR);
+}
+
+
+struct TestPacked
+{
+	TestPacked() : health(100), state(0), heading(0), altitude(0), visible(false), big(0)
+	{
+		for (int i = 0; i < 4; i++)
+			cells[i] = 0;
+	}
+
+	static void Register(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("health", &TestPacked::health).PackRange(0, 100),
+			FieldInfo("state", &TestPacked::state).PackBits(3),
+			FieldInfo("heading", &TestPacked::heading).Quantise(-180, 180, 0.01),
+			FieldInfo("altitude", &TestPacked::altitude).Quantise(-1000, 10000, 0.5),
+			FieldInfo("visible", &TestPacked::visible).PackBits(1),
+			FieldInfo("big", &TestPacked::big).PackBits(40),
+			FieldInfo("cells", &TestPacked::cells).PackBits(4),
+			FieldInfo("samples", &TestPacked::samples).PackRange(-512, 511),
+			FieldInfo("position", &TestPacked::position),
+			FieldInfo("name", &TestPacked::name),
+			FieldInfo("points", &TestPacked::points)
+		};
+		db.SetTypeFields<TestPacked>(fields);
+	}
+
+	int health;
+	char state;
+	float heading;
+	double altitude;
+	bool visible;
+	__int64 big;
+	int cells[4];
+	std::vector<short> samples;
+	TestVector position;
+	std::string name;
+	std::vector<TestVector> points;
+};
+
+
+struct TestPackedRange
+{
+	__int64 id;
+};
+
+
+void TestPackedSerialisation(rflb::TypeDatabase& db)
+{
+	printf("\nTestPackedSerialisation\n\n");
+
+	TestPacked::Register(db);
+	const rflb::Type* type = &db.GetType<TestPacked>();
+
+	TestPacked src;
+	src.health = 150;
+	src.state = -3;
+	src.heading = 123.456f;
+	src.altitude = 2500.3;
+	src.visible = true;
+	src.big = -123456789;
+	src.cells[0] = 7;
+	src.cells[3] = -8;
+	for (int i = -512; i < 512; i += 100)
+		src.samples.push_back((short)i);
+	src.position = TestVector(1, 2);
+	src.name = "Rincewind";
+	src.points.push_back(src.position);
+
+	// A second object follows to check that each object ends on a byte boundary
+	std::stringstream packed_data, binary_data;
+	serialise::SavePacked(packed_data, &src, type);
+	serialise::SaveBinary(binary_data, &src, type);
+	TEST_ASSERT(packed_data.str().size() < binary_data.str().size());
+	serialise::SavePacked(packed_data, &src, type);
+
+	TestPacked dst, dst2;
+	serialise::LoadPacked(packed_data, &dst, type);
+	serialise::LoadPacked(packed_data, &dst2, type);
+	TEST_ASSERT(packed_data.tellg() == (std::streampos)packed_data.str().size());
+
+	// Out of range values are clamped and floats are within half a step
+	TEST_ASSERT(dst.health == 100);
+	TEST_ASSERT(dst.state == -3);
+	TEST_ASSERT(fabs(dst.heading - src.heading) <= 0.005f);
+	TEST_ASSERT(fabs(dst.altitude - src.altitude) <= 0.25);
+	TEST_ASSERT(dst.visible == true);
+	TEST_ASSERT(dst.big == -123456789);
+	TEST_ASSERT(ArraysEqual(dst.cells, src.cells));
+	TEST_ASSERT(dst.samples == src.samples);
+	TEST_ASSERT(dst.position == src.position);
+	TEST_ASSERT(dst.name == src.name);
+	TEST_ASSERT(dst.points == src.points);
+	TEST_ASSERT(dst2.name == src.name && dst2.samples == src.samples && dst2.big == src.big);
+
+	// Packing that doesn't suit the field's type is rejected when it's registered
+	TEST_EXCEPTION(rflb::FieldInfo("heading", &TestPacked::heading).PackBits(3));
+	TEST_EXCEPTION(rflb::FieldInfo("health", &TestPacked::health).Quantise(0, 100, 1));
+	TEST_EXCEPTION(rflb::FieldInfo("name", &TestPacked::name).PackRange(0, 100));
+	TEST_EXCEPTION(rflb::FieldInfo("position", &TestPacked::position).PackBits(8));
+
+	// 64-bit range bounds aren't rounded
+	rflb::FieldInfo range_fields[] =
+	{
+		rflb::FieldInfo("id", &TestPackedRange::id).PackRange(0x7FFFFFFFFFFFFF00LL, 0x7FFFFFFFFFFFFFFFLL)
+	};
+	db.SetTypeFields<TestPackedRange>(range_fields);
+	TestPackedRange range_src = { 0x7FFFFFFFFFFFFF42LL }, range_dst = { 0 };
+	std::stringstream range_data;
+	serialise::SavePacked(range_data, &range_src, &db.GetType<TestPackedRange>());
+	TEST_ASSERT(range_data.str().size() == 1);
+	serialise::LoadPacked(range_data, &range_dst, &db.GetType<TestPackedRange>());
+	TEST_ASSERT(range_dst.id == range_src.id);
+
+	// Objects without packed fields round-trip exactly
+	TestDerived derived_src, derived_dst;
+	derived_src.Set();
+	std::stringstream derived_data;
+	serialise::SavePacked(derived_data, &derived_src, &db.GetType<TestDerived>());
+	serialise::LoadPacked(derived_data, &derived_dst, &db.GetType<TestDerived>());
+
+	printf("= BASE ====================================================\n");
+	derived_dst.data.TestAgainst(derived_src.data);
+	printf("= DERIVED =================================================\n");
+	derived_dst.data2.TestAgainst(derived_src.data2);
+	printf("===========================================================\n");
+}
+
+
+struct StaticFields
+{
+	static void Register(rflb::TypeDatabase& db)
+	{
+		static const rflb::StaticFieldInfo fields[] =
+		{
+			RFLB_STATIC_FIELD(StaticFields, int_value),
+			RFLB_STATIC_FIELD_ATTR(StaticFields, cached, rflb::FieldAttr::TRANSIENT),
+			RFLB_STATIC_FIELD(StaticFields, name),
+			RFLB_STATIC_FIELD(StaticFields, position),
+			RFLB_STATIC_FIELD(StaticFields, int_array),
+			RFLB_STATIC_FIELD(StaticFields, int_vector),
+			RFLB_STATIC_FIELD(StaticFields, other_int_vector),
+			RFLB_STATIC_FIELD(StaticFields, string_map)
+		};
+		db.SetTypeFields<StaticFields>(fields);
+	}
+
+	// The same fields registered the usual way
+	static void RegisterFieldInfo(rflb::TypeDatabase& db)
+	{
+		using namespace rflb;
+		FieldInfo fields[] =
+		{
+			FieldInfo("int_value", &StaticFields::int_value),
+			FieldInfo("cached", &StaticFields::cached).Attributes(FieldAttr::TRANSIENT),
+			FieldInfo("name", &StaticFields::name),
+			FieldInfo("position", &StaticFields::position),
+			FieldInfo("int_array", &StaticFields::int_array),
+			FieldInfo("int_vector", &StaticFields::int_vector),
+			FieldInfo("other_int_vector", &StaticFields::other_int_vector),
+			FieldInfo("string_map", &StaticFields::string_map)
+		};
+		db.SetTypeFields<StaticFields>(fields);
+	}
+
+	void Set()
+	{
+		int_value = 1234;
+		cached = 99;
+		name = "Leonard";
+		position = TestVector(3, 4);
+		for (int i = 0; i < 3; i++)
+			int_array[i] = i * 10;
+		int_vector.push_back(5);
+		int_vector.push_back(6);
+		other_int_vector.push_back(7);
+		string_map[1] = "Quirm";
+	}
+
+	int int_value;
+	int cached;
+	std::string name;
+	TestVector position;
+	int int_array[3];
+	std::vector<int> int_vector;
+	std::vector<int> other_int_vector;
+	std::map<int, std::string> string_map;
+};
+
+
+void TestStaticFields(rflb::TypeDatabase& db)
+{
+	printf("\nTestStaticFields\n\n");
+
+	StaticFields::Register(db);
+	const rflb::Type* type = &db.GetType<StaticFields>();
+	TEST_ASSERT(type->GetFields().size() == 8);
+	TEST_ASSERT(type->FindField(rflb::Name("missing")) == 0);
+
+	const rflb::Field& position = type->GetField(rflb::Name("position"));
+	TEST_ASSERT(position.m_Type == &db.GetType<TestVector>());
+	TEST_ASSERT(position.m_Offset == offsetof(StaticFields, position));
+	TEST_ASSERT(position.m_ContainerFactory == 0);
+	TEST_ASSERT(type->GetField(rflb::Name("cached")).m_Attributes.transient);
+
+	// Fields of the same container type share a factory
+	const rflb::Field& int_vector = type->GetField(rflb::Name("int_vector"));
+	TEST_ASSERT(int_vector.m_ContainerFactory != 0);
+	TEST_ASSERT(int_vector.m_ContainerFactory == type->GetField(rflb::Name("other_int_vector")).m_ContainerFactory);
+	TEST_ASSERT(int_vector.m_ContainerFactory->m_ValueType == &db.GetType<int>());
+	TEST_ASSERT(type->GetField(rflb::Name("int_array")).m_ContainerFactory->m_IsInline);
+	TEST_ASSERT(type->GetField(rflb::Name("string_map")).m_ContainerFactory->m_KeyType == &db.GetType<int>());
+
+	// Serialises the same as fields registered with FieldInfo
+	StaticFields src, dst;
+	src.Set();
+	std::stringstream static_data;
+	serialise::SaveBinary(static_data, &src, type);
+
+	rflb::TypeDatabase field_info_db;
+	const rflb::Serialisers& string_serialisers = db.GetType<std::string>().GetSerialisers();
+	field_info_db.GetType<std::string>().LoadSaveBinary(
+		string_serialisers.m_LoadFuncs[rflb::SERIALISE_METHOD_BINARY],
+		string_serialisers.m_SaveFuncs[rflb::SERIALISE_METHOD_BINARY]);
+	TestVector::Register(field_info_db);
+	StaticFields::RegisterFieldInfo(field_info_db);
+	std::stringstream field_info_data;
+	serialise::SaveBinary(field_info_data, &src, &field_info_db.GetType<StaticFields>());
+	TEST_ASSERT(static_data.str() == field_info_data.str());
+
+	serialise::LoadBinary(static_data, &dst, type);
+	TEST_ASSERT(dst.int_value == src.int_value);
+	TEST_ASSERT(dst.name == src.name);
+	TEST_ASSERT(dst.position == src.position);
+	TEST_ASSERT(ArraysEqual(dst.int_array, src.int_array));
+	TEST_ASSERT(dst.int_vector == src.int_vector);
+	TEST_ASSERT(dst.other_int_vector == src.other_int_vector);
+	TEST_ASSERT(dst.string_map == src.string_map);
+}
+
+
+void TestCodeGenerator(rflb::TypeDatabase& db)
+{
+	printf("\nTestCodeGenerator\n\n");
+
+	// Regenerate the checked in serialisers
+	rflb::BinaryCodeGenerator generator("RegisterGeneratedSerialisers");
+	generator.AddType<TestVector>(db, "TestVector");
+	generator.AddType<Values>(db, "Values");
+	generator.AddType<Arrays>(db, "Arrays");
+	generator.AddType<Vectors>(db, "Vectors");
+	generator.AddType<Maps>(db, "Maps");
+	generator.AddType<TestData>(db, "TestData");
+	generator.AddType<TestBase>(db, "TestBase");
+	generator.AddType<TestDerived>(db, "TestDerived");
+	std::stringstream source;
+	generator.Generate(source);
+	TEST_ASSERT(source.str().find("void RegisterGeneratedSerialisers(rflb::TypeDatabase& db)") != std::string::npos);
+	TEST_ASSERT(source.str().find("SaveBinary_TestVector(stream, 0, &object.embedded_pod);") != std::string::npos);
+
+	// The checked in file must be up to date, which is found next to this one
+	std::string filename = __FILE__;
+	filename = filename.substr(0, filename.find_last_of("/\\") + 1) + "GeneratedSerialisers.inl";
+	std::ifstream checked_in(filename.c_str(), std::ios_base::binary);
+	std::stringstream checked_in_source;
+	checked_in_source << checked_in.rdbuf();
+	TEST_ASSERT(checked_in.is_open());
+	TEST_ASSERT(checked_in_source.str() == source.str());
+
+	TestDerived src, dst;
+	src.Set();
+	const rflb::Type* type = &db.GetType<TestDerived>();
+	std::stringstream runtime_data, runtime_columnar, runtime_skip_defaults;
+	serialise::SaveBinary(runtime_data, &src, type);
+	serialise::SaveBinary(runtime_columnar, &src, type, serialise::FLAG_COLUMNAR);
+	serialise::SaveBinary(runtime_skip_defaults, &src, type, serialise::FLAG_SKIP_DEFAULTS);
+
+	// The generated serialisers must write exactly the same bytes
+	RegisterGeneratedSerialisers(db);
+	std::stringstream generated_data;
+	type->GetGeneratedSave()(generated_data, 0, &src);
+	TEST_ASSERT(generated_data.str() == runtime_data.str());
+
+	type->GetGeneratedLoad()(runtime_data, 0, &dst);
+	printf("= BASE ====================================================\n");
+	dst.data.TestAgainst(src.data);
+	printf("= DERIVED =================================================\n");
+	dst.data2.TestAgainst(src.data2);
+	printf("===========================================================\n");
+
+	// Nested objects use the generated functions without flags and walk their fields with them
+	std::stringstream nested_data, columnar_data, skip_defaults_data;
+	serialise::SaveBinary(nested_data, &src, type);
+	serialise::SaveBinary(columnar_data, &src, type, serialise::FLAG_COLUMNAR);
+	serialise::SaveBinary(skip_defaults_data, &src, type, serialise::FLAG_SKIP_DEFAULTS);
+	TEST_ASSERT(nested_data.str() == generated_data.str());
+	TEST_ASSERT(columnar_data.str() == runtime_columnar.str());
+	TEST_ASSERT(skip_defaults_data.str() == runtime_skip_defaults.str());
+
+	// Restore the field walk for any later tests
+	db.GetType<TestVector>().GeneratedBinary(0, 0);
+	db.GetType<Values>().GeneratedBinary(0, 0);
+	db.GetType<Arrays>().GeneratedBinary(0, 0);
+	db.GetType<Vectors>().GeneratedBinary(0, 0);
+	db.GetType<Maps>().GeneratedBinary(0, 0);
+	db.GetType<TestData>().GeneratedBinary(0, 0);
+	db.GetType<TestBase>().GeneratedBinary(0, 0);
+	db.GetType<TestDerived>().GeneratedBinary(0, 0);
+}
+
+
 void TestSerialisation(rflb::TypeDatabase& db)
 {
 	// Register backwards to ensure out-of-order registration is supported
@@ -475,4 +2854,30 @@ void TestSerialisation(rflb::TypeDatabase& db)
 
 	TestBinarySerialisation(db);
 	TestBinaryIFFVSerialisation(db);
+	TestColumnarSerialisation(db);
+	TestIncrementalLoad(db, rflb::SERIALISE_METHOD_BINARY);
+	TestIncrementalLoad(db, rflb::SERIALISE_METHOD_BINARY_IFFV);
+	TestFieldIndex(db);
+	TestImage(db);
+	TestCopy(db);
+	TestCompare(db);
+	TestFieldPath(db);
+	TestReflectedTable(db);
+	TestStaticFields(db);
+	TestProfiles(db);
+	TestSkipDefaults(db);
+	TestBatch(db);
+	TestParallel(db);
+	TestParallelFields(db);
+	TestBinaryEngine(db);
+	TestSerialiseContext(db);
+	TestReload(db);
+	TestTypePool(db);
+	TestBoundedLoad(db);
+	TestInheritance(db);
+	TestMeasure(db);
+	TestLayoutAnalysis(db);
+	TestIncrementalUntrusted(db);
+	TestPackedSerialisation(db);
+	TestCodeGenerator(db);
 }
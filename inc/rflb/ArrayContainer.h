@@ -4,6 +4,8 @@
 
 #include <rflb/Container.h>
 #include <rflb/Utils.h>
+#include <algorithm>
+#include <new>
 
 
 namespace rflb
@@ -77,9 +79,11 @@ namespace rflb
 
 			void* AddEmpty()
 			{
+				// Reconstruct in place rather than assigning from a temporary
 				RFLB_ASSERT(m_Position < LENGTH);
-				m_Container[m_Position] = TYPE();
-				return &m_Container[m_Position++];
+				TYPE* value = &m_Container[m_Position++];
+				value->~TYPE();
+				return new (value) TYPE();
 			}
 
 			void* AddEmpty(void*)
@@ -88,6 +92,40 @@ namespace rflb
 				return 0;
 			}
 
+			void AddSwap(void* object)
+			{
+				using std::swap;
+				swap(*(TYPE*)AddEmpty(), *(TYPE*)object);
+			}
+
+			void AddSwap(void*, void*)
+			{
+				RFLB_ASSERT(false);
+			}
+
+			void Clear()
+			{
+				// Fixed size so just start writing from the beginning again
+				m_Position = 0;
+			}
+
+			void Reserve(int count)
+			{
+				RFLB_ASSERT(m_Position + count <= LENGTH);
+			}
+
+			void BeginOverwrite(int count)
+			{
+				m_Position = 0;
+				Reserve(count);
+			}
+
+			void* Overwrite()
+			{
+				RFLB_ASSERT(m_Position < LENGTH);
+				return &m_Container[m_Position++];
+			}
+
 		private:
 			TYPE* m_Container;
 			int m_Position;
@@ -99,10 +137,13 @@ namespace rflb
 		{
 			value_type = TypeInfo::Create<TYPE>();
 
-			return new internal::ContainerFactory<
+			IContainerFactory* factory = new internal::ContainerFactory<
 				TYPE,
 				ArrayReadIterator<TYPE, LENGTH>,
 				ArrayWriteIterator<TYPE, LENGTH> >();
+			factory->m_IsInline = true;
+			factory->m_IsContiguous = true;
+			return factory;
 		}
 	}
 }
\ No newline at end of file
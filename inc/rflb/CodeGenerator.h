@@ -0,0 +1,70 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <rflb/Type.h>
+#include <rflb/TypeDatabase.h>
+
+
+namespace rflb
+{
+	//
+	// Generates C++ source with straight-line binary load/save functions for a set of
+	// reflected types, producing exactly the same bytes as SERIALISE_METHOD_BINARY.
+	// The generated source defines a registration function that sets the functions as
+	// the generated serialisers of each type, which the runtime only calls for binary data
+	// with no flags and all profiles. Anything else still walks the fields. Generated loads
+	// check their counts with serialise::CheckBound so they can be part of bounded loads.
+	//
+	// PODs, embedded objects of other generated types and arrays/vectors of PODs are
+	// read and written directly. Anything else, including fields with custom serialisers,
+	// maps and base types that aren't generated, goes through the runtime serialiser.
+	//
+	// Types are named in the generated code using the names given here, as the type
+	// database only knows their compiler-specific type_info names. Fields are accessed
+	// by their registered names, so these must match the C++ member names of any field
+	// that's read or written directly.
+	//
+	class BinaryCodeGenerator
+	{
+	public:
+		BinaryCodeGenerator(const char* register_function_name);
+
+		void AddInclude(const char* filename);
+		void AddType(const Type* type, const char* cpp_name);
+
+		template <typename TYPE> void AddType(TypeDatabase& db, const char* cpp_name)
+		{
+			AddType(&db.GetType<TYPE>(), cpp_name);
+		}
+
+		void Generate(std::ostream& stream) const;
+
+	private:
+		struct GeneratedType
+		{
+			const Type* m_Type;
+			std::string m_CppName;
+			std::string m_FunctionSuffix;
+		};
+
+		// Runtime fallback for a field or base type
+		struct Fallback
+		{
+			int m_TypeIndex;
+			u32 m_FieldCRC;
+			int m_BaseIndex;
+		};
+
+		const GeneratedType* FindType(const Type* type) const;
+		void GenerateSave(std::ostream& stream, const GeneratedType& type, std::vector<Fallback>& field_fallbacks, std::vector<Fallback>& base_fallbacks) const;
+		void GenerateLoad(std::ostream& stream, const GeneratedType& type, std::vector<Fallback>& field_fallbacks, std::vector<Fallback>& base_fallbacks) const;
+
+		std::string m_RegisterFunctionName;
+		std::vector<std::string> m_Includes;
+		std::vector<GeneratedType> m_Types;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+
+#pragma once
+
+
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	class Type;
+	struct Field;
+
+
+	//
+	// Equality and hashing of objects by walking their reflected fields, using the same
+	// flattened plans as CopyObject so that runs of adjacent PODs are compared and hashed
+	// as single blocks. Transient fields are ignored.
+	//
+	//    * PODs are compared bitwise, so 0.0f and -0.0f differ and NaNs can be equal.
+	//    * Containers are compared/hashed element by element, in iteration order.
+	//    * Types with custom equal/hash functions use them instead.
+	//    * Other types without fields must be PODs, as non-PODs such as strings can't be
+	//      compared bitwise and need custom equal/hash functions.
+	//
+	// Objects that are equal always have the same hash.
+	//
+	bool EqualObjects(const void* a, const void* b, const Type* object_type);
+	u32 HashObject(const void* object, const Type* object_type, u32 seed = 0);
+
+	// Equality of a single field, given the addresses of its data in two objects
+	bool EqualFieldData(const void* a, const void* b, const Field& field);
+
+	// Whether EqualFieldData can be used on a field, which isn't the case when it holds non-PODs
+	// without custom equal functions, directly or within its containers and fields
+	bool CanCompareFieldData(const Field& field);
+
+	// Word-at-a-time hash of a block of memory, for use in custom hash functions
+	u32 HashBytes(const void* data, size_t size, u32 seed);
+}
\ No newline at end of file
@@ -2,12 +2,27 @@
 #pragma once
 
 
+#include <rflb/Utils.h>
+#include <cstddef>
+
+
 namespace rflb
 {
 	struct TypeInfo;
 	class Type;
 
 
+	// Heap memory a container allocates to store its values, not including anything the values
+	// themselves own. Unused capacity and bookkeeping, such as tree node links, are part of
+	// the allocated size.
+	struct ContainerMemory
+	{
+		size_t m_Allocated;
+		size_t m_Unused;
+		size_t m_Overhead;
+	};
+
+
 	// Read-only iteration over a container
 	struct IReadIterator
 	{
@@ -17,6 +32,13 @@ namespace rflb
 		virtual int GetCount() const = 0;
 		virtual void MoveNext() = 0;
 		virtual bool IsValid() const = 0;
+
+		// Containers stored inline, such as arrays, allocate nothing
+		virtual ContainerMemory GetMemory() const
+		{
+			ContainerMemory memory = { 0, 0, 0 };
+			return memory;
+		}
 	};
 
 
@@ -28,6 +50,27 @@ namespace rflb
 		virtual void Add(void* key, void* object) = 0;
 		virtual void* AddEmpty() = 0;
 		virtual void* AddEmpty(void* key) = 0;
+
+		// Add by swapping the object with a default constructed value in the container, rather than
+		// copying it, and leave it empty. Strings and standard containers swap what they own while
+		// other types swap through a copy, unless they provide their own swap.
+		virtual void AddSwap(void* object) { Add(object); }
+		virtual void AddSwap(void* key, void* object) { Add(key, object); }
+
+		// Empty the container before adding to it, which copying and reloading into a container rely
+		// on. Containers that can't be emptied assert if they're ever the destination of either.
+		virtual void Clear() { RFLB_ASSERT(false); }
+
+		// Hint at how many objects will be added, which containers are free to ignore
+		virtual void Reserve(int) { }
+
+		// Replace the contents by overwriting existing values in place, in order or by key, so that
+		// they keep their memory. Values that weren't overwritten are removed by EndOverwrite.
+		// Containers that can't reuse their values are cleared and added to instead.
+		virtual void BeginOverwrite(int count) { Clear(); Reserve(count); }
+		virtual void* Overwrite() { return AddEmpty(); }
+		virtual void* Overwrite(void* key) { return AddEmpty(key); }
+		virtual void EndOverwrite() { }
 	};
 
 
@@ -38,7 +81,9 @@ namespace rflb
 			m_KeyType(0),
 			m_ValueType(0),
 			m_KeyIsPointer(false),
-			m_ValueIsPointer(false)
+			m_ValueIsPointer(false),
+			m_IsInline(false),
+			m_IsContiguous(false)
 		{
 		}
 
@@ -50,6 +95,13 @@ namespace rflb
 		bool m_KeyIsPointer;
 		bool m_ValueIsPointer;
 
+		// Set when the values are stored within the container object itself (e.g. C arrays),
+		// with the container memory laid out as consecutive values
+		bool m_IsInline;
+
+		// Set when the values are stored consecutively in memory, wherever that may be
+		bool m_IsContiguous;
+
 		// Support for finding out how much memory an iterator/container consumes
 		// before constructing it, allowing custom memory allocation -- even from the
 		// runtime stack.
@@ -0,0 +1,76 @@
+
+#pragma once
+
+
+#include <vector>
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	class Type;
+	struct Field;
+
+
+	//
+	// Deep copy of an object by walking its reflected fields, rather than round-tripping
+	// it through a serialiser. Only reflected fields are copied and the destination must
+	// already be constructed.
+	//
+	//    * Adjacent POD fields, including those in embedded objects and base types, are
+	//      merged into single block copies.
+	//    * Containers are cleared, reserved and refilled through their factories.
+	//    * Custom copy functions on fields and types replace the default copy.
+	//    * Other types without fields are copied with their assignment operator.
+	//    * Pointers are copied as-is, without copying what they point to.
+	//
+	void CopyObject(void* dst, const void* src, const Type* object_type);
+
+	// Copy arrays of objects, with a single block copy if the objects are entirely POD
+	void CopyObjects(void* dst, const void* src, const Type* object_type, int count);
+
+
+	namespace internal
+	{
+		enum PlanUse
+		{
+			// All fields, with types that have custom copies copied individually
+			PLAN_USE_COPY,
+
+			// Non-transient fields, with types that have custom equality copied individually
+			PLAN_USE_COMPARE,
+
+			// Binary serialised fields of a profile, with containers and types that have binary
+			// serialisers kept whole. Pointers are left out.
+			PLAN_USE_PRESENCE
+		};
+
+
+		// Either a block copy of adjacent PODs or a field that needs copying individually
+		struct CopyStep
+		{
+			u32 m_Offset;
+			u32 m_Size;
+			const Field* m_Field;
+
+			// Cleared in presence plans for fields that can't be compared with their defaults
+			bool m_IsComparable;
+		};
+
+
+		// Copy steps for the fields of a type, its embedded objects and its base types, in offset order
+		struct CopyPlan
+		{
+			std::vector<CopyStep> m_Steps;
+
+			// Set when the entire object can be copied in one block
+			bool m_IsBlock;
+
+			// Plans are rebuilt whenever any type changes
+			u32 m_Generation;
+		};
+
+
+		void BuildCopyPlan(CopyPlan& plan, const Type& type, PlanUse use, u32 profile = PROFILE_ALL);
+	}
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <typeinfo>
 #include <rflb/Type.h>
+#include <rflb/TypeDatabase.h>
 #include <rflb/Utils.h>
 #include <rflb/Container.h>
 
@@ -40,13 +41,39 @@ namespace rflb
 	};
 
 
+	// Bit-packing of a numeric field, or the values of an array/vector of them, for the packed serialiser
+	struct FieldPacking
+	{
+		FieldPacking() : m_NbBits(0), m_RangeMin(0), m_RangeMax(0), m_Min(0), m_Max(0), m_Step(0)
+		{
+		}
+
+		// Zero leaves the field unpacked
+		u32 m_NbBits;
+
+		// Integers with a zero step keep only their low bits, otherwise they're clamped to the
+		// range and written relative to its minimum. The range is kept as integers so that
+		// 64-bit bounds aren't rounded.
+		__int64 m_RangeMin;
+		__int64 m_RangeMax;
+
+		// Floating point values are clamped to the range and written as the number of steps
+		// above the minimum
+		double m_Min;
+		double m_Max;
+		double m_Step;
+	};
+
+
 	struct FieldInfo
 	{
 		template <typename CLASS, typename TYPE> FieldInfo(const char* name, TYPE (CLASS::*field)) :
 			m_Name(name),
 			m_Offset((u32)offsetof(CLASS, *field)),
 			m_TypeInfo(TypeInfo::Create<TYPE>()),
-			m_Version(1)
+			m_Version(1),
+			m_CustomCopy(0),
+			m_Profiles(PROFILE_ALL)
 		{
 			// The object being passed is only used to figure out template parameters
 			m_ContainerFactory = internal::CreateContainerFactory(((CLASS*)0)->*field, m_KeyTypeInfo, m_ValueTypeInfo);
@@ -58,6 +85,17 @@ namespace rflb
 		FieldInfo& LoadSaveBinaryIFFv(SerialiseLoadFunc load, SerialiseSaveFunc save);
 		FieldInfo& LoadSaveTextXML(SerialiseLoadFunc load, SerialiseSaveFunc save);
 		FieldInfo& Version(u32 version);
+		FieldInfo& CustomCopy(CustomCopyFunc copy);
+
+		// Mask of the serialisation profiles the field belongs to, all by default
+		FieldInfo& Profiles(u32 profiles);
+
+		// Have the packed serialiser write an integer field with only its low bits, as an integer
+		// within a range, or a floating point field quantised to a step within a range. Asserts
+		// if the field, or the values of its container, aren't of the right numeric kind.
+		FieldInfo& PackBits(u32 nb_bits);
+		FieldInfo& PackRange(__int64 min, __int64 max);
+		FieldInfo& Quantise(double min, double max, double step);
 
 		// All the data required for constructing a field
 		Name m_Name;
@@ -72,13 +110,92 @@ namespace rflb
 		FieldAttr m_Attributes;
 		Serialisers m_Serialisers;
 		u32 m_Version;
+		CustomCopyFunc m_CustomCopy;
+		u32 m_Profiles;
+		FieldPacking m_Packing;
+	};
+
+
+	namespace internal
+	{
+		template <typename TYPE> IContainerFactory* CreateFieldContainerFactory(TypeInfo& key_type, TypeInfo& value_type)
+		{
+			return CreateContainerFactory(*(TYPE*)0, key_type, value_type);
+		}
+
+
+		// Everything about a field type needed for registration, as constant data shared by all fields of that type
+		struct FieldTraits
+		{
+			const TypeInfo& (*m_GetTypeInfo)();
+			CreateContainerFactoryFunc m_CreateContainerFactory;
+		};
+
+		template <typename TYPE> struct FieldTraitsOf
+		{
+			static const FieldTraits traits;
+		};
+
+		template <typename TYPE> const FieldTraits FieldTraitsOf<TYPE>::traits =
+		{
+			&GetTypeInfo<TYPE>,
+			&CreateFieldContainerFactory<TYPE>
+		};
+
+		template <typename CLASS, typename TYPE> const FieldTraits* GetFieldTraits(TYPE (CLASS::*))
+		{
+			return &FieldTraitsOf<TYPE>::traits;
+		}
+
+
+		// Points a container factory at the key/value types in a type database
+		void ResolveContainerTypes(IContainerFactory* factory, const TypeInfo& key_type, const TypeInfo& value_type, TypeDatabase& type_db);
+	}
+
+
+	//
+	// Lightweight alternative to FieldInfo for types with many fields, designed to be stored in
+	// static tables. Field types are resolved and names hashed when the table is registered, with
+	// container factories shared by all fields of the same container type in a type database.
+	// Custom serialisers and copies aren't supported and need the FieldInfo path.
+	//
+	//    static const rflb::StaticFieldInfo fields[] =
+	//    {
+	//        RFLB_STATIC_FIELD(MyType, x),
+	//        RFLB_STATIC_FIELD_ATTR(MyType, cached, rflb::FieldAttr::TRANSIENT)
+	//    };
+	//    db.SetTypeFields<MyType>(fields);
+	//
+	struct StaticFieldInfo
+	{
+		const char* m_Name;
+		u32 m_Offset;
+		const internal::FieldTraits* m_Traits;
+		u32 m_Attributes;
+		u32 m_Version;
+		u32 m_Profiles;
 	};
 
 
+	#define RFLB_STATIC_FIELD_PROFILES(CLASS, name, attributes, profiles)	\
+		{ #name, (u32)offsetof(CLASS, name), rflb::internal::GetFieldTraits(&CLASS::name), attributes, 1, profiles }
+
+	#define RFLB_STATIC_FIELD_ATTR(CLASS, name, attributes) RFLB_STATIC_FIELD_PROFILES(CLASS, name, attributes, rflb::PROFILE_ALL)
+
+	#define RFLB_STATIC_FIELD(CLASS, name) RFLB_STATIC_FIELD_ATTR(CLASS, name, 0)
+
+
 	struct Field
 	{
 		Field();
 		Field(const FieldInfo& field_info, TypeDatabase& type_db);
+		Field(const StaticFieldInfo& field_info, TypeDatabase& type_db);
+
+		// Transient fields are never serialised
+		bool IsInProfile(u32 profile) const
+		{
+			return !m_Attributes.transient && (m_Profiles & profile) != 0;
+		}
 
 		// Parent-relative name
 		Name m_Name;
@@ -95,5 +212,8 @@ namespace rflb
 		FieldAttr m_Attributes;
 		Serialisers m_Serialisers;
 		u32 m_Version;
+		CustomCopyFunc m_CustomCopy;
+		u32 m_Profiles;
+		FieldPacking m_Packing;
 	};
 }
\ No newline at end of file
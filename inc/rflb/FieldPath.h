@@ -0,0 +1,139 @@
+
+#pragma once
+
+
+#include <vector>
+#include <rflb/Type.h>
+#include <rflb/TypeDatabase.h>
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	struct Field;
+	struct IContainerFactory;
+
+
+	//
+	// A dotted path to a nested field, such as "data.values.embedded_pod.x", that's resolved
+	// once against a type so that it can be accessed repeatedly without any name lookups.
+	// Fields of base types can be named directly and container elements are indexed with
+	// "name[index]".
+	//
+	// Embedded objects and C arrays are folded into a single offset from the parent object.
+	// Pointers and vector elements have to be followed at runtime, so they split the path
+	// into a list of hops.
+	//
+	class FieldPath
+	{
+	public:
+		FieldPath();
+
+		// Returns false if the path can't be resolved, leaving the path invalid
+		bool Resolve(const Type* root_type, const char* path);
+
+		template <typename TYPE> bool Resolve(TypeDatabase& db, const char* path)
+		{
+			return Resolve(&db.GetType<TYPE>(), path);
+		}
+
+		bool IsValid() const { return m_Type != 0; }
+		const Type* GetRootType() const { return m_RootType; }
+		const Type* GetType() const { return m_Type; }
+		bool IsPointer() const { return m_IsPointer; }
+
+		// Paths without pointers or vector elements are a fixed offset from the root object
+		bool HasFixedOffset() const { return m_Hops.empty(); }
+		u32 GetOffset() const { RFLB_ASSERT(HasFixedOffset()); return m_Offset; }
+
+		// Returns null if an element index is out of range or a pointer along the way is null
+		void* GetAddress(void* object) const;
+		const void* GetAddress(const void* object) const;
+
+		template <typename TYPE> bool IsType() const
+		{
+			const TypeInfo& type_info = internal::GetTypeInfo<TYPE>();
+			return m_Type && m_Type->GetName() == type_info.m_Name && m_IsPointer == type_info.m_IsPointer;
+		}
+
+		template <typename TYPE> const TYPE& Get(const void* object) const
+		{
+			RFLB_ASSERT(IsType<TYPE>());
+			const void* data = GetAddress(object);
+			RFLB_ASSERT(data != 0);
+			return *(const TYPE*)data;
+		}
+
+		template <typename TYPE> void Set(void* object, const TYPE& value) const
+		{
+			RFLB_ASSERT(IsType<TYPE>());
+			void* data = GetAddress(object);
+			RFLB_ASSERT(data != 0);
+			*(TYPE*)data = value;
+		}
+
+		// Access the field in an array of root objects. Paths with a fixed offset are a single
+		// strided walk, while others are followed for each object.
+		template <typename TYPE> void GetBatch(const void* objects, int nb_objects, TYPE* values) const
+		{
+			RFLB_ASSERT(IsType<TYPE>());
+			int stride = m_RootType->GetSize();
+			if (HasFixedOffset())
+			{
+				const char* data = (const char*)objects + m_Offset;
+				for (int i = 0; i < nb_objects; i++, data += stride)
+					values[i] = *(const TYPE*)data;
+				return;
+			}
+
+			for (int i = 0; i < nb_objects; i++)
+			{
+				const void* data = GetAddress((const char*)objects + i * stride);
+				RFLB_ASSERT(data != 0);
+				values[i] = *(const TYPE*)data;
+			}
+		}
+
+		template <typename TYPE> void SetBatch(void* objects, int nb_objects, const TYPE* values) const
+		{
+			RFLB_ASSERT(IsType<TYPE>());
+			int stride = m_RootType->GetSize();
+			if (HasFixedOffset())
+			{
+				char* data = (char*)objects + m_Offset;
+				for (int i = 0; i < nb_objects; i++, data += stride)
+					*(TYPE*)data = values[i];
+				return;
+			}
+
+			for (int i = 0; i < nb_objects; i++)
+			{
+				void* data = GetAddress((char*)objects + i * stride);
+				RFLB_ASSERT(data != 0);
+				*(TYPE*)data = values[i];
+			}
+		}
+
+	private:
+		// Step from one object to another that can't be reached with a fixed offset
+		struct Hop
+		{
+			u32 m_Offset;
+
+			// Either follow a pointer or pick an element from a container
+			IContainerFactory* m_Factory;
+			int m_Index;
+		};
+
+		void Reset();
+
+		const Type* m_RootType;
+
+		std::vector<Hop> m_Hops;
+
+		// Final field, relative to the last hop
+		u32 m_Offset;
+		const Type* m_Type;
+		bool m_IsPointer;
+	};
+}
\ No newline at end of file
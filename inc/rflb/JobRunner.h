@@ -0,0 +1,79 @@
+
+#pragma once
+
+
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	// A job is identified by its index within the set of jobs being run
+	typedef void (*JobFunc)(void* data, int index);
+
+
+	//
+	// Runs a set of independent jobs, returning once they have all completed. Implement this
+	// to hand jobs to an existing engine job system, or use the ThreadPool below.
+	//
+	class IJobRunner
+	{
+	public:
+		virtual ~IJobRunner() { }
+		virtual void Run(JobFunc func, void* data, int nb_jobs) = 0;
+	};
+
+
+	// Runs all jobs on the calling thread
+	class SerialJobRunner : public IJobRunner
+	{
+	public:
+		void Run(JobFunc func, void* data, int nb_jobs);
+	};
+
+
+	//
+	// Fixed set of worker threads that wake for each Run call and claim jobs from a shared
+	// counter until there are none left, with the calling thread also running jobs. Fast
+	// threads keep taking jobs while slow ones are busy, so uneven jobs balance themselves.
+	//
+	// Run can only be called by one thread at a time and jobs must not call Run themselves.
+	//
+	class ThreadPool : public IJobRunner
+	{
+	public:
+		// The number of threads created, in addition to the calling thread
+		ThreadPool(int nb_threads);
+		~ThreadPool();
+
+		void Run(JobFunc func, void* data, int nb_jobs);
+
+		int GetNbThreads() const { return m_NbThreads; }
+
+		// Threads and locks of the platform, defined alongside the implementation
+		struct Platform;
+
+		// Entry point for the worker threads
+		static void WorkerMain(ThreadPool* pool);
+
+	private:
+		// Non-copyable
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator = (const ThreadPool&);
+
+		void RunJobs();
+
+		Platform* m_Platform;
+		int m_NbThreads;
+
+		// Current set of jobs, only modified while all workers are waiting
+		JobFunc m_Func;
+		void* m_Data;
+		int m_NbJobs;
+		volatile long m_NextJob;
+
+		// Incremented for each Run so that workers can tell when there are new jobs
+		u32 m_Generation;
+		int m_NbFinished;
+		bool m_Quit;
+	};
+}
\ No newline at end of file
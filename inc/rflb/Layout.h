@@ -0,0 +1,64 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <vector>
+#include <rflb/Type.h>
+
+
+namespace rflb
+{
+	class TypeDatabase;
+
+
+	// Bytes within an object that no reflected field or base type occupies
+	struct PaddingHole
+	{
+		u32 m_Offset;
+		u32 m_Size;
+	};
+
+
+	struct LayoutReport
+	{
+		const Type* m_Type;
+
+		// Holes between fields and at the end of the object, in offset order
+		std::vector<PaddingHole> m_Holes;
+		u32 m_PaddingSize;
+
+		// Cache lines spanned by an object starting on a cache line boundary, and those the hot
+		// fields touch within it
+		u32 m_NbCacheLines;
+		u32 m_NbHotCacheLines;
+
+		// The type's own fields with hot fields first and each group in order of decreasing
+		// alignment, which leaves the least padding in between. Fields stay where they are if
+		// that's no smaller and doesn't touch fewer cache lines.
+		FieldList m_SuggestedOrder;
+		u32 m_SuggestedSize;
+		u32 m_SuggestedNbCacheLines;
+		u32 m_SuggestedNbHotCacheLines;
+
+		// Set when every field is a POD but padding stops the type being copied in one block
+		bool m_IsBlockWithoutPadding;
+	};
+
+
+	//
+	// Reports how the fields of a type are laid out in memory. Base types and embedded objects
+	// are treated as single fields, with their own padding reported by analysing them, so the
+	// suggested order only moves fields of the type itself, within the space they currently
+	// start at. Members that aren't reflected, and any vtable pointer, show up as holes.
+	//
+	// Hot fields are those belonging to any of the hot profiles, none by default.
+	//
+	LayoutReport AnalyseLayout(const Type* type, u32 hot_profiles = 0, u32 cache_line_size = 64);
+
+	// Reports for every type in the database that has fields, most padding first
+	void AnalyseLayouts(const TypeDatabase& db, std::vector<LayoutReport>& reports, u32 hot_profiles = 0, u32 cache_line_size = 64);
+
+	// Writes a field by field listing of the layout and any suggested order
+	void PrintLayout(std::ostream& stream, const LayoutReport& report);
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <rflb/Container.h>
 #include <rflb/Utils.h>
+#include <algorithm>
 #include <map>
 
 
@@ -52,6 +53,24 @@ namespace rflb
 				return m_Iterator != m_Container.end();
 			}
 
+			ContainerMemory GetMemory() const
+			{
+				// Each value gets its own tree node, which in the common implementations holds
+				// parent/child links and a colour ahead of the value
+				struct Node
+				{
+					void* links[3];
+					char colour;
+					typename Container::value_type value;
+				};
+
+				ContainerMemory memory;
+				memory.m_Allocated = m_Container.size() * sizeof(Node);
+				memory.m_Unused = 0;
+				memory.m_Overhead = m_Container.size() * (sizeof(Node) - sizeof(typename Container::value_type));
+				return memory;
+			}
+
 		private:
 			const Container& m_Container;
 			Iterator m_Iterator;
@@ -63,10 +82,11 @@ namespace rflb
 		{
 		public:
 			typedef std::map<KEY, DATA, COMPARE, ALLOC> Container;
-			typedef typename Container::const_iterator Iterator;
+			typedef typename Container::iterator Iterator;
 
 			MapWriteIterator(Container* container) :
-				m_Container(*container)
+				m_Container(*container),
+				m_Next(container->end())
 			{
 			}
 
@@ -88,14 +108,69 @@ namespace rflb
 
 			void* AddEmpty(void* key)
 			{
-				//std::pair<Container::iterator, bool> ret = m_Container.insert(std::pair<KEY, DATA>(*(KEY*)key, DATA()));
-				//return &*ret.first;
-				m_Container[*(KEY*)key] = DATA();
-				return &m_Container[*(KEY*)key];
+				// One lookup, resetting the value if the key is already there. Nodes can't take their
+				// key by swap, so new keys are copied into the pair that's inserted with the lookup's
+				// position rather than through make_pair and a second search.
+				const KEY& k = *(KEY*)key;
+				Iterator i = m_Container.lower_bound(k);
+				if (i != m_Container.end() && !m_Container.key_comp()(k, i->first))
+				{
+					i->second = DATA();
+					return &i->second;
+				}
+				return &m_Container.insert(i, typename Container::value_type(k, DATA()))->second;
+			}
+
+			void AddSwap(void*)
+			{
+				RFLB_ASSERT(false);
+			}
+
+			void AddSwap(void* key, void* object)
+			{
+				using std::swap;
+				swap(*(DATA*)AddEmpty(key), *(DATA*)object);
+			}
+
+			void Clear()
+			{
+				m_Container.clear();
+			}
+
+			void Reserve(int)
+			{
+				// Nodes are allocated individually
+			}
+
+			void BeginOverwrite(int)
+			{
+				m_Next = m_Container.begin();
+			}
+
+			void* Overwrite(void* key)
+			{
+				// Keys arrive in the order they were saved, so any nodes passed over weren't loaded
+				const KEY& k = *(KEY*)key;
+				COMPARE less = m_Container.key_comp();
+				while (m_Next != m_Container.end() && less(m_Next->first, k))
+					m_Container.erase(m_Next++);
+
+				// Reuse the node with a matching key or insert a new one where it belongs
+				if (m_Next != m_Container.end() && !less(k, m_Next->first))
+					return &(m_Next++)->second;
+				return &m_Container.insert(m_Next, typename Container::value_type(k, DATA()))->second;
+			}
+
+			void EndOverwrite()
+			{
+				m_Container.erase(m_Next, m_Container.end());
 			}
 
 		private:
 			Container& m_Container;
+
+			// Next node to compare against the keys being overwritten
+			Iterator m_Next;
 		};
 
 
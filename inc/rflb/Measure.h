@@ -0,0 +1,63 @@
+
+#pragma once
+
+
+#include <rflb/Utils.h>
+#include <map>
+
+
+namespace rflb
+{
+	class Type;
+
+
+	// Heap memory attributed to a single type
+	struct TypeFootprint
+	{
+		TypeFootprint() : m_NbObjects(0), m_HeapSize(0) { }
+
+		// Objects stored in container memory
+		size_t m_NbObjects;
+
+		// Container memory allocated for those objects, plus anything the type's custom measure
+		// function reports
+		size_t m_HeapSize;
+	};
+
+
+	struct MemoryFootprint
+	{
+		MemoryFootprint() : m_InlineSize(0), m_HeapSize(0), m_UnusedSize(0), m_OverheadSize(0), m_IsEstimate(false) { }
+
+		// Size of the object itself
+		size_t m_InlineSize;
+
+		// Everything the object owns on the heap, recursively, including the unused capacity and
+		// bookkeeping counted below
+		size_t m_HeapSize;
+		size_t m_UnusedSize;
+		size_t m_OverheadSize;
+
+		std::map<const Type*, TypeFootprint> m_Types;
+
+		// Set when containers were sampled
+		bool m_IsEstimate;
+	};
+
+
+	//
+	// Measures the memory owned by an object by walking its reflected fields, including
+	// transient ones, and the values of any containers they hold.
+	//
+	//    * Pointers aren't followed, as nothing says who owns what they point to.
+	//    * Types without fields own no heap memory unless they have a custom measure function,
+	//      which is how strings and the like are accounted for.
+	//    * Heap sizes are what the containers ask for and don't include allocator headers or
+	//      rounding.
+	//
+	// A non-zero max_samples limits how many values of each container are walked. Values are
+	// sampled evenly and what they own is scaled up to the full count, so the result is an
+	// estimate for containers whose values own differing amounts of memory.
+	//
+	MemoryFootprint MeasureObject(const void* object, const Type* object_type, int max_samples = 0);
+}
\ No newline at end of file
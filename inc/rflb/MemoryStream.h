@@ -0,0 +1,93 @@
+
+#pragma once
+
+
+#include <istream>
+#include <streambuf>
+
+
+namespace rflb
+{
+	//
+	// Read-only stream buffer over a block of memory. This allows the stream-based
+	// serialisers and custom load functions to run over data that has already been
+	// buffered, without copying it into a stringstream first.
+	//
+	class MemoryStreamBuf : public std::streambuf
+	{
+	public:
+		MemoryStreamBuf(const void* data, size_t size) :
+			m_RequestedEnd(0)
+		{
+			char* begin = (char*)data;
+			setg(begin, begin, begin + size);
+		}
+
+		// Furthest position any read has asked for, which is past the end of the data if a
+		// read ran out
+		size_t GetRequestedEnd() const { return m_RequestedEnd; }
+
+	protected:
+		std::streamsize xsgetn(char* dest, std::streamsize count)
+		{
+			RequestEnd(gptr() - eback() + count);
+			return std::streambuf::xsgetn(dest, count);
+		}
+
+		int_type underflow()
+		{
+			// Only called once everything has been read
+			RequestEnd(egptr() - eback() + 1);
+			return traits_type::eof();
+		}
+
+		pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			char* base = eback();
+			if (dir == std::ios_base::cur)
+				offset += gptr() - base;
+			else if (dir == std::ios_base::end)
+				offset += egptr() - base;
+
+			if (offset < 0 || offset > egptr() - base)
+				return pos_type(off_type(-1));
+
+			setg(base, base + offset, egptr());
+			return pos_type(offset);
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which)
+		{
+			return seekoff(off_type(position), std::ios_base::beg, which);
+		}
+
+	private:
+		void RequestEnd(size_t end)
+		{
+			if (end > m_RequestedEnd)
+				m_RequestedEnd = end;
+		}
+
+		size_t m_RequestedEnd;
+	};
+
+
+	// Input stream that reads directly from a block of memory
+	class MemoryInputStream : public std::istream
+	{
+	public:
+		MemoryInputStream(const void* data, size_t size) :
+			std::istream(&m_Buffer),
+			m_Buffer(data, size)
+		{
+		}
+
+		size_t GetRequestedEnd() const { return m_Buffer.GetRequestedEnd(); }
+
+	private:
+		MemoryStreamBuf m_Buffer;
+	};
+}
\ No newline at end of file
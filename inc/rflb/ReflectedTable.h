@@ -0,0 +1,106 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <vector>
+#include <rflb/FieldPath.h>
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	class Type;
+	struct Field;
+
+
+	//
+	// Stores rows of a reflected type as one column per field (struct of arrays), so that
+	// passes over a few fields of many objects only touch the memory for those fields.
+	// Embedded objects and base types are flattened so that each of their fields gets its
+	// own column, while types with custom serialisers and containers are stored whole.
+	//
+	// Only reflected fields are stored and rows are converted to and from objects of
+	// the type by copying field by field. Columns of non-POD fields hold constructed
+	// objects, which are copied with their assignment operator and swapped into their
+	// new storage when the columns grow.
+	//
+	class ReflectedTable
+	{
+	public:
+		ReflectedTable(const Type* type);
+		~ReflectedTable();
+
+		// Add a default constructed row or copy one from an object, returning the row index
+		int AddRow();
+		int AddRow(const void* object);
+
+		// Removes by moving the last row into its place, so row order isn't preserved
+		void RemoveRow(int row);
+
+		void Clear();
+		void Reserve(int nb_rows);
+
+		// Row/object conversion
+		void GetRow(int row, void* object) const;
+		void SetRow(int row, const void* object);
+
+		const Type* GetType() const { return m_Type; }
+		int GetNbRows() const { return m_NbRows; }
+		int GetNbColumns() const { return (int)m_Columns.size(); }
+
+		// Returns -1 if the dotted path doesn't name a column
+		int FindColumn(const char* path) const;
+		const Field& GetColumnField(int column) const { return *m_Columns[column].m_Field; }
+
+		// Contiguous values of a column, one for each row
+		void* GetColumnData(int column) { return m_Columns[column].m_Data; }
+		const void* GetColumnData(int column) const { return m_Columns[column].m_Data; }
+
+		template <typename TYPE> TYPE* GetColumn(int column)
+		{
+			RFLB_ASSERT(IsColumnType(column, internal::GetTypeInfo<TYPE>()));
+			return (TYPE*)GetColumnData(column);
+		}
+
+		template <typename TYPE> const TYPE* GetColumn(int column) const
+		{
+			RFLB_ASSERT(IsColumnType(column, internal::GetTypeInfo<TYPE>()));
+			return (const TYPE*)GetColumnData(column);
+		}
+
+		// Binary serialisation one whole column at a time. Loading fails if the table
+		// was saved with a different type layout, or has more rows than the rest of the
+		// stream could hold. Transient columns aren't written and are left with their
+		// default values on load.
+		void Save(std::ostream& stream) const;
+		bool Load(std::istream& stream);
+
+	private:
+		struct Column
+		{
+			const Field* m_Field;
+
+			// Offset of the field within the row object
+			u32 m_Offset;
+
+			u32 m_Size;
+			bool m_IsPOD;
+			char* m_Data;
+		};
+
+		// Non-copyable
+		ReflectedTable(const ReflectedTable&);
+		ReflectedTable& operator = (const ReflectedTable&);
+
+		void AddColumns(const Type* type, u32 offset);
+		bool IsColumnType(int column, const TypeInfo& type_info) const;
+		void SetValue(const Column& column, int row, const void* object);
+		u32 GetMinRowSize() const;
+
+		const Type* m_Type;
+		std::vector<Column> m_Columns;
+		int m_NbRows;
+		int m_Capacity;
+	};
+}
\ No newline at end of file
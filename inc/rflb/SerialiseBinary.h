@@ -3,19 +3,188 @@
 
 
 #include <iosfwd>
+#include <vector>
+#include <rflb/Utils.h>
 
 
 namespace rflb
 {
 	class Type;
+	struct Field;
+	class IJobRunner;
 }
 
 
 namespace serialise
 {
-	void LoadBinary(std::istream& stream, void* object, const rflb::Type* object_type);
-	void SaveBinary(std::ostream& stream, const void* object, const rflb::Type* object_type);
+	// Optional behaviour for the save functions
+	enum Flags
+	{
+		// Precede each IFFV object with a table of field offsets for random access by LoadFields
+		FLAG_FIELD_INDEX = 1,
 
-	void LoadBinaryIFFV(std::istream& stream, void* object, const rflb::Type* object_type);
-	void SaveBinaryIFFV(std::ostream& stream, const void* object, const rflb::Type* object_type);
+		// Store vectors and arrays of reflected objects one field at a time, rather than one object
+		// at a time, for better compression. Binary only, with the same flag required for loading.
+		FLAG_COLUMNAR = 2,
+
+		// Precede each reflected object with a bitmap of the values that differ from a default
+		// constructed object and write only those. Adjacent PODs, including those of embedded
+		// objects and base types, share a single bit. Values missing on load are reset to their
+		// defaults. Non-PODs without fields, such as strings, are always written unless their types
+		// have custom equal functions. Binary only, with the same flag required for loading.
+		FLAG_SKIP_DEFAULTS = 4,
+
+		// Load into the existing values of containers rather than adding to them, so that reloading
+		// an object reuses its memory. Vectors keep their capacity and values, map nodes with matching
+		// keys are kept and anything that isn't in the data is removed. Binary load only.
+		FLAG_RELOAD = 8
+	};
+
+
+	enum LoadStatus
+	{
+		LOAD_STATUS_NEED_MORE_DATA,
+		LOAD_STATUS_COMPLETE,
+		LOAD_STATUS_ERROR
+	};
+
+
+	//
+	// Only fields belonging to one of the profiles in the profile mask are visited, with
+	// transient fields always skipped. Binary data must be loaded with the same profile
+	// it was saved with, while IFFV skips any fields outside the profile on load.
+	//
+	void LoadBinary(std::istream& stream, void* object, const rflb::Type* object_type, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+	void SaveBinary(std::ostream& stream, const void* object, const rflb::Type* object_type, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+
+	//
+	// Binary load of data from a less-trusted source, which must be no more than size bytes.
+	// Before anything is reserved, each container count is checked against the bytes that are
+	// left, using the fewest bytes its values can be written in, so corrupt counts fail
+	// straight away rather than after a huge allocation. Values written by custom serialisers
+	// are assumed to take at least a byte. The checks are made once per container rather than
+	// per read. Returns LOAD_STATUS_ERROR for a rejected count or if the object reads past
+	// the bound, and LOAD_STATUS_NEED_MORE_DATA if the stream ends first. Either way the
+	// stream's failbit is set and the object is left partially loaded.
+	//
+	LoadStatus LoadBinaryBounded(std::istream& stream, void* object, const rflb::Type* object_type, u32 size, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+
+	// For custom loaders to check a count read from the stream before using it. During a
+	// bounded load this fails the load, returning false, if count values of value_size bytes
+	// can't fit in what's left. Always true outside of bounded loads.
+	bool CheckBound(std::istream& stream, int count, u32 value_size);
+
+	//
+	// Binary serialisation of many objects of the same type in one pass, spaced stride bytes
+	// apart so that they can be embedded in larger structures. The objects are written a field
+	// at a time, the same as vectors with FLAG_COLUMNAR, unless the type has a custom serialiser
+	// or FLAG_SKIP_DEFAULTS is set. The count isn't written and the batch must be loaded with
+	// the same count, flags and profile it was saved with.
+	//
+	void LoadBinaryBatch(std::istream& stream, void* objects, int count, u32 stride, const rflb::Type* object_type, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+	void SaveBinaryBatch(std::ostream& stream, const void* objects, int count, u32 stride, const rflb::Type* object_type, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+
+	//
+	// Batches split into chunks of objects that are serialised at the same time by a job runner,
+	// each into its own buffer. The buffers are written after a table of their sizes, so that
+	// loading can be split across the runner the same way. Containers of many objects can be
+	// saved by passing their contiguous values as the batch. Custom serialisers must be safe to
+	// call from multiple threads.
+	//
+	// Loading sets the stream's failbit if the chunk table doesn't match the count.
+	//
+	void LoadBinaryParallel(std::istream& stream, void* objects, int count, u32 stride, const rflb::Type* object_type, rflb::IJobRunner& runner, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+	void SaveBinaryParallel(std::ostream& stream, const void* objects, int count, u32 stride, const rflb::Type* object_type, rflb::IJobRunner& runner, int chunk_size = 256, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+
+	// Binary serialisation of a single field of an object
+	void LoadBinaryField(std::istream& stream, void* object, const rflb::Field& field, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+	void SaveBinaryField(std::ostream& stream, const void* object, const rflb::Field& field, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+
+	void LoadBinaryIFFV(std::istream& stream, void* object, const rflb::Type* object_type, u32 profile = rflb::PROFILE_ALL);
+	void SaveBinaryIFFV(std::ostream& stream, const void* object, const rflb::Type* object_type, u32 flags = 0, u32 profile = rflb::PROFILE_ALL);
+
+	//
+	// Loads an IFFV object with the data of its large fields, such as big containers, read into
+	// memory using the data sizes in the field headers and then loaded at the same time by a
+	// job runner. Fields of at least min_parallel_size bytes, including those of base types, are
+	// deferred and all other fields are loaded as the headers are walked. Custom serialisers of
+	// the large fields must be safe to call from multiple threads.
+	//
+	void LoadBinaryIFFVParallel(std::istream& stream, void* object, const rflb::Type* object_type, rflb::IJobRunner& runner, u32 min_parallel_size = 64 * 1024, u32 profile = rflb::PROFILE_ALL);
+
+
+	//
+	// Loads only the named fields of an IFFV object, including those of its base types,
+	// and leaves the stream at the end of the object. Objects saved with FLAG_FIELD_INDEX
+	// are read by seeking straight to the requested fields, otherwise the field headers
+	// are walked and the data of all other fields is skipped.
+	//
+	// Returns the number of fields that were found and loaded.
+	//
+	int LoadFields(std::istream& stream, void* object, const rflb::Type* object_type, const rflb::Name* names, int nb_names);
+
+	template <size_t N> int LoadFields(std::istream& stream, void* object, const rflb::Type* object_type, const rflb::Name (&names)[N])
+	{
+		return LoadFields(stream, object, object_type, names, (int)N);
+	}
+
+
+	// Location of an object within an archive, relative to the start of the archive
+	struct ArchiveEntry
+	{
+		u32 m_Offset;
+		u32 m_TypeCRC;
+	};
+
+
+	//
+	// Writes a sequence of IFFV objects followed by a footer that indexes them, so
+	// that any object can be loaded without parsing the ones before it. The archive
+	// can start anywhere in the stream but the footer must be the last thing written.
+	//
+	class ArchiveWriter
+	{
+	public:
+		ArchiveWriter(std::ostream& stream, u32 flags = FLAG_FIELD_INDEX);
+
+		void Save(const void* object, const rflb::Type* object_type);
+
+		// Writes the footer, after which no more objects can be saved
+		void Finish();
+
+	private:
+		std::ostream& m_Stream;
+		u32 m_StartPosition;
+		u32 m_Flags;
+		std::vector<ArchiveEntry> m_Entries;
+	};
+
+
+	// Random access to the objects of an archive by reading its footer from the end of the stream
+	class ArchiveReader
+	{
+	public:
+		ArchiveReader(std::istream& stream);
+
+		bool IsValid() const { return m_IsValid; }
+		int GetNbObjects() const { return (int)m_Entries.size(); }
+		u32 GetTypeCRC(int index) const { return m_Entries[index].m_TypeCRC; }
+
+		void Load(int index, void* object, const rflb::Type* object_type);
+		int LoadFields(int index, void* object, const rflb::Type* object_type, const rflb::Name* names, int nb_names);
+
+		template <size_t N> int LoadFields(int index, void* object, const rflb::Type* object_type, const rflb::Name (&names)[N])
+		{
+			return LoadFields(index, object, object_type, names, (int)N);
+		}
+
+	private:
+		const ArchiveEntry& GetEntry(int index, const rflb::Type* object_type) const;
+
+		std::istream& m_Stream;
+		u32 m_StartPosition;
+		u32 m_IndexOffset;
+		bool m_IsValid;
+		std::vector<ArchiveEntry> m_Entries;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <rflb/SerialiseEngine.h>
+
+
+namespace serialise
+{
+	//
+	// State that's reused from one serialise call to the next, so that a steady stream of
+	// loads or saves stops touching the heap once everything has grown to fit. A context is
+	// attached to a stream rather than passed around, so that every serialise call on the
+	// stream and any custom serialisers it calls can find it with GetContext:
+	//
+	//    serialise::SerialiseContext context;
+	//    context.Attach(stream);
+	//    serialise::LoadBinary(stream, object, type);
+	//
+	// LoadBinary and SaveBinary without flags run on the context's engine. The context must
+	// be detached from, or outlive, any stream it's attached to.
+	//
+	class SerialiseContext
+	{
+	public:
+		void Attach(std::ios_base& stream);
+		static void Detach(std::ios_base& stream);
+
+		BinaryEngine& GetEngine() { return m_Engine; }
+
+		// Temporaries for custom serialisers, released in reverse order
+		ScratchStack& GetScratch() { return m_Scratch; }
+
+		// Temporary string for custom serialisers, which keeps its capacity between uses
+		std::string& GetStringBuffer() { return m_StringBuffer; }
+
+		// Table for custom serialisers that write pointers as object IDs
+		u32 AddObject(void* object);
+		void* GetObject(u32 id) const { return id < m_Objects.size() ? m_Objects[id] : 0; }
+		void ClearObjects() { m_Objects.clear(); }
+
+	private:
+		BinaryEngine m_Engine;
+		ScratchStack m_Scratch;
+		std::string m_StringBuffer;
+		std::vector<void*> m_Objects;
+	};
+
+
+	// Returns null if no context is attached
+	SerialiseContext* GetContext(std::ios_base& stream);
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <vector>
+#include <rflb/Type.h>
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	struct IContainerFactory;
+	struct IReadIterator;
+	struct IWriteIterator;
+}
+
+
+namespace serialise
+{
+	//
+	// Stack allocator for temporaries that are released in the reverse order they were
+	// allocated. Memory comes from blocks that are kept once allocated, so that it can be
+	// reused without touching the heap.
+	//
+	class ScratchStack
+	{
+	public:
+		struct Marker
+		{
+			int m_Block;
+			u32 m_Used;
+		};
+
+		ScratchStack();
+		~ScratchStack();
+
+		// Allocations are aligned to 16 bytes
+		void* Push(u32 size);
+
+		// Releases everything pushed since the marker was taken
+		Marker GetMarker() const;
+		void Release(const Marker& marker);
+
+	private:
+		struct Block
+		{
+			char* m_Data;
+			u32 m_Size;
+			u32 m_Used;
+		};
+
+		// Non-copyable
+		ScratchStack(const ScratchStack&);
+		ScratchStack& operator = (const ScratchStack&);
+
+		std::vector<Block> m_Blocks;
+		int m_Current;
+	};
+
+
+	//
+	// Binary save/load that walks objects and containers with an explicit work stack rather
+	// than recursing, so that deeply nested data uses a fixed amount of native stack. The
+	// bytes are the same as SaveBinary/LoadBinary without flags. Container iterators and key
+	// temporaries are allocated from scratch memory, which along with the work stack is
+	// kept for the next call.
+	//
+	// Custom serialisers can call back into the same engine.
+	//
+	class BinaryEngine
+	{
+	public:
+		void Save(std::ostream& stream, const void* object, const rflb::Type* object_type, u32 profile = rflb::PROFILE_ALL);
+		void Load(std::istream& stream, void* object, const rflb::Type* object_type, u32 profile = rflb::PROFILE_ALL);
+
+	private:
+		// An object whose fields are being visited or a container whose values are being visited
+		struct Frame
+		{
+			char* m_Object;
+			const rflb::Type* m_Type;
+
+			// Next field of objects, including those of base types
+			const rflb::FieldList* m_Fields;
+			int m_FieldIndex;
+
+			// Containers have a factory and iterator, with keys visited before their values
+			rflb::IContainerFactory* m_Factory;
+			rflb::IReadIterator* m_ReadIterator;
+			rflb::IWriteIterator* m_WriteIterator;
+			void* m_Key;
+			int m_Count;
+			bool m_KeyDone;
+
+			// Scratch memory to release when the frame is popped
+			ScratchStack::Marker m_ScratchMarker;
+		};
+
+		void PushObject(void* object, const rflb::Type* object_type, u32 profile);
+		void SaveValue(std::ostream& stream, const void* object, const rflb::Type* object_type, bool is_pointer, rflb::IContainerFactory* factory, u32 profile);
+		void LoadValue(std::istream& stream, void* object, const rflb::Type* object_type, bool is_pointer, rflb::IContainerFactory* factory, u32 profile);
+		void SaveStep(std::ostream& stream, u32 profile);
+		void LoadStep(std::istream& stream, u32 profile);
+
+		std::vector<Frame> m_Frames;
+		ScratchStack m_Scratch;
+	};
+}
\ No newline at end of file
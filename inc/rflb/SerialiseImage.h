@@ -0,0 +1,100 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	class Type;
+	struct Field;
+}
+
+
+//
+// The image format lays out objects exactly as they sit in memory, using the reflected
+// field offsets and sizes, so that an image can be memory-mapped and its PODs used in
+// place without any loading. Containers and types with custom serialisers can't be
+// used in place, so their bytes in the object are replaced with an ImageBlock that
+// points to a separate payload:
+//
+//    * Arrays are stored inline, exactly like PODs.
+//    * Vectors point to a block of consecutive values, each laid out as the value type.
+//    * Maps point to a block of consecutive keys, followed by a block of values aligned
+//      to IMAGE_ALIGNMENT.
+//    * Types with custom binary serialisers point to the bytes they write. Values smaller
+//      than an ImageBlock are left zeroed and their blocks are stored in a table after
+//      the payloads instead.
+//
+// Pointers are not yet supported and are stored as zero. Transient fields are stored as
+// zero and left untouched on load, the same as the other serialisers. Padding between
+// reflected fields is zeroed so that images of the same object are identical, while
+// types without reflected fields are copied whole, along with any padding of their own.
+//
+namespace serialise
+{
+	// All payloads are aligned to this, relative to the start of the image
+	const u32 IMAGE_ALIGNMENT = 16;
+
+
+	struct ImageHeader
+	{
+		u32 m_Magic;
+		u32 m_Version;
+		u32 m_TypeCRC;
+		u32 m_RootOffset;
+		u32 m_Size;
+
+		// Table of ImageIndirectBlock
+		u32 m_IndirectOffset;
+		u32 m_NbIndirect;
+	};
+
+
+	// Self-relative reference to a payload, so that it can be used wherever the image is mapped
+	struct ImageBlock
+	{
+		const void* GetData() const
+		{
+			return (const char*)this + m_Offset;
+		}
+
+		// For maps, the values follow the keys
+		const void* GetValueData(u32 key_size) const
+		{
+			u32 keys_size = (m_Count * key_size + IMAGE_ALIGNMENT - 1) & ~(IMAGE_ALIGNMENT - 1);
+			return (const char*)GetData() + keys_size;
+		}
+
+		int m_Offset;
+
+		// Number of elements for containers, number of bytes for custom serialised types
+		u32 m_Count;
+	};
+
+
+	// Block of a custom serialised value that's too small to hold it, sorted by the offset of
+	// the value from the start of the image
+	struct ImageIndirectBlock
+	{
+		u32 m_ValueOffset;
+		ImageBlock m_Block;
+	};
+
+
+	void SaveImage(std::ostream& stream, const void* object, const rflb::Type* object_type);
+
+	// Returns the root object of an image, or null if it doesn't contain an object of the given type.
+	// The image must be aligned to IMAGE_ALIGNMENT.
+	const void* GetImageObject(const void* image, const rflb::Type* object_type);
+
+	// Payload reference for a container or custom serialised field of an object within an image.
+	// The image is needed to find the blocks of fields smaller than an ImageBlock.
+	const ImageBlock& GetImageBlock(const void* image_object, const rflb::Field& field);
+	const ImageBlock& GetImageBlock(const void* image, const void* image_object, const rflb::Field& field);
+
+	// Fix up an image into a live object, constructing its containers
+	void LoadImage(const void* image, void* object, const rflb::Type* object_type);
+}
\ No newline at end of file
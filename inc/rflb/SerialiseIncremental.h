@@ -0,0 +1,131 @@
+
+#pragma once
+
+
+#include <vector>
+#include <rflb/Type.h>
+#include <rflb/Utils.h>
+#include <rflb/SerialiseBinary.h>
+
+
+namespace rflb
+{
+	struct IContainerFactory;
+	struct IWriteIterator;
+}
+
+
+namespace serialise
+{
+	//
+	// Resumable loader for the binary formats that can be fed data as it arrives,
+	// rather than requiring the entire object to be buffered beforehand. The position
+	// in the field/container walk is kept between calls to Feed and objects are
+	// constructed in place as their bytes come in.
+	//
+	// PODs are copied directly from the fed data into their destination. Types with
+	// custom load functions can't be resumed half-way through, so their bytes are
+	// accumulated and the function is retried until it can run without reaching the
+	// end of the data. Retries wait for at least as much data as the last attempt tried
+	// to read and are made on a default constructed object. A function that fails
+	// without reaching the end of the data fails the load.
+	//
+	// Container counts are checked against the fewest bytes their values can be written
+	// in and the size of the object, if given to Begin, or the size of the IFFV field
+	// they're in. Negative counts always fail the load.
+	//
+	// Objects saved with FLAG_COLUMNAR or FLAG_SKIP_DEFAULTS aren't supported.
+	//
+	class IncrementalLoader
+	{
+	public:
+		IncrementalLoader();
+		~IncrementalLoader();
+
+		// Start loading a new object, abandoning any load already in progress. The size of
+		// the object's data is zero if it's not known up front.
+		void Begin(void* object, const rflb::Type* object_type, rflb::SerialiseMethod method = rflb::SERIALISE_METHOD_BINARY, u32 profile = rflb::PROFILE_ALL, u32 size = 0);
+
+		// Consume as much of the data as is needed to complete the object. Any bytes
+		// past the end of the object are left unconsumed and the number of bytes used
+		// is optionally returned.
+		LoadStatus Feed(const void* data, u32 size, u32* nb_consumed = 0);
+
+		LoadStatus GetStatus() const { return m_Status; }
+
+		// Number of bytes consumed since the call to Begin
+		u32 GetPosition() const { return m_Position; }
+
+	private:
+		struct Frame
+		{
+			enum Kind
+			{
+				KIND_OBJECT,
+				KIND_COLLECTION
+			};
+
+			Kind m_Kind;
+			int m_Stage;
+
+			void* m_Object;
+			const rflb::Type* m_Type;
+
+			// Object walk state
+			rflb::FieldList::const_iterator m_Field;
+			int m_NbFieldsLeft;
+			u32 m_FieldEnd;
+			int m_BaseIndex;
+
+			// Collection walk state
+			rflb::IContainerFactory* m_Factory;
+			rflb::IWriteIterator* m_Iterator;
+			void* m_Key;
+			int m_Count;
+			int m_Index;
+		};
+
+		void Reset();
+		void Step();
+		void StepObject();
+		void StepCollection();
+		bool RunCustomLoad(const char*& data, u32& size);
+		bool CheckCount(int count, rflb::IContainerFactory* factory) const;
+
+		void PushObject(void* object, const rflb::Type* object_type);
+		void PushCollection(void* object, rflb::IContainerFactory* factory);
+		void PushField(void* object, const rflb::Field& field);
+		void PushValue(void* object, const rflb::Type* object_type, bool is_pointer, rflb::IContainerFactory* factory);
+		void PopFrame();
+		void RequestRead(void* dest, u32 size);
+
+		rflb::SerialiseMethod m_Method;
+		u32 m_Profile;
+		LoadStatus m_Status;
+		u32 m_Position;
+
+		// Position the object must end by, zero if unknown
+		u32 m_End;
+
+		// Stack of objects and collections being walked
+		std::vector<Frame> m_Frames;
+
+		// Pending direct read into an object or the scratch buffer
+		char* m_ReadDest;
+		u32 m_ReadLeft;
+
+		// Pending skip of an unknown IFFV field
+		u32 m_SkipLeft;
+
+		// Pending custom load, with any bytes accumulated for it and how many are needed
+		// before it's worth retrying. The type is null for pointer fields, which aren't reset.
+		rflb::SerialiseLoadFunc m_CustomLoad;
+		void* m_CustomObject;
+		const rflb::Type* m_CustomType;
+		std::vector<char> m_CustomData;
+		u32 m_CustomNeeded;
+
+		// Storage for counts and field headers
+		char m_Scratch[16];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+
+#pragma once
+
+
+#include <iosfwd>
+#include <rflb/Utils.h>
+
+
+namespace rflb
+{
+	class Type;
+}
+
+
+//
+// The packed format is a bit stream that follows the same field order as the binary
+// format. Numeric fields with packing attributes (see FieldInfo::PackBits, PackRange and
+// Quantise) are written with exactly the number of bits they declare, as are the values
+// of arrays and vectors of them. Other PODs are written with all of their bits, but
+// without any padding between them and the packed values.
+//
+// Anything with a custom binary serialiser, maps and containers of pointers are written
+// by the binary serialiser, starting on a byte boundary. Vector counts take 32 bits and
+// array lengths aren't written. The stream is left on a byte boundary after each object.
+//
+// Like the binary format, objects must be loaded with the profile they were saved with.
+//
+namespace serialise
+{
+	void LoadPacked(std::istream& stream, void* object, const rflb::Type* object_type, u32 profile = rflb::PROFILE_ALL);
+	void SavePacked(std::ostream& stream, const void* object, const rflb::Type* object_type, u32 profile = rflb::PROFILE_ALL);
+}
\ No newline at end of file
@@ -2,25 +2,36 @@
 #pragma once
 
 
+#include <algorithm>
 #include <map>
+#include <vector>
+#include <utility>
 #include <rflb/Utils.h>
 
 
 namespace rflb
 {
 	struct FieldInfo;
+	struct StaticFieldInfo;
 	struct Field;
 	class TypeDatabase;
 
 
-	// Collection of fields that are optimised for searching
-	typedef std::map<u32, Field> Fields;
+	// Collection of fields that are optimised for searching, sorted by name CRC
+	typedef std::vector<std::pair<u32, Field> > Fields;
+
+	// Subset of the fields of a type, in the same order
+	typedef std::vector<const Field*> FieldList;
 
 
 	namespace internal
 	{
 		typedef void (*ConstructObjectFunc)(void* object);
 		typedef void (*DestructObjectFunc)(void* object);
+		typedef void (*AssignObjectFunc)(void* dst, const void* src);
+		typedef void (*SwapObjectFunc)(void* a, void* b);
+		typedef void (*ConstructArrayFunc)(void* objects, int count);
+		typedef void (*DestructArrayFunc)(void* objects, int count);
 
 
 		// As the constructor/destructor are inaccessible, point to these wrappers for each type
@@ -32,6 +43,68 @@ namespace rflb
 		{
 			((TYPE*)object)->TYPE::~TYPE();
 		}
+		template <typename TYPE> inline void ConstructArray(void* objects, int count)
+		{
+			for (int i = 0; i < count; i++)
+				ConstructObject<TYPE>((TYPE*)objects + i);
+		}
+		template <typename TYPE> inline void DestructArray(void* objects, int count)
+		{
+			for (int i = 0; i < count; i++)
+				DestructObject<TYPE>((TYPE*)objects + i);
+		}
+
+
+		// Arrays can't be assigned directly so are assigned element by element
+		template <typename TYPE> struct Assign
+		{
+			static void Object(TYPE& dst, const TYPE& src)
+			{
+				dst = src;
+			}
+		};
+		template <typename TYPE, size_t LENGTH> struct Assign<TYPE[LENGTH]>
+		{
+			static void Object(TYPE (&dst)[LENGTH], const TYPE (&src)[LENGTH])
+			{
+				for (size_t i = 0; i < LENGTH; i++)
+				{
+					Assign<TYPE>::Object(dst[i], src[i]);
+				}
+			}
+		};
+		template <typename TYPE> inline void AssignObject(void* dst, const void* src)
+		{
+			Assign<TYPE>::Object(*(TYPE*)dst, *(const TYPE*)src);
+		}
+
+
+		// Swapping exchanges what the values own without copying it, for types that provide a swap
+		template <typename TYPE> struct Swap
+		{
+			static void Object(TYPE& a, TYPE& b)
+			{
+				using std::swap;
+				swap(a, b);
+			}
+		};
+		template <typename TYPE, size_t LENGTH> struct Swap<TYPE[LENGTH]>
+		{
+			static void Object(TYPE (&a)[LENGTH], TYPE (&b)[LENGTH])
+			{
+				for (size_t i = 0; i < LENGTH; i++)
+				{
+					Swap<TYPE>::Object(a[i], b[i]);
+				}
+			}
+		};
+		template <typename TYPE> inline void SwapObject(void* a, void* b)
+		{
+			Swap<TYPE>::Object(*(TYPE*)a, *(TYPE*)b);
+		}
+
+
+		struct CopyPlan;
 	}
 
 
@@ -47,12 +120,19 @@ namespace rflb
 			type_info.m_Name = Name(typeid(internal::strip_pointer<TYPE>::Type).name());
 			type_info.m_IsPointer = internal::is_pointer<TYPE>::val;
 			type_info.m_Size = sizeof(TYPE);
+			type_info.m_Alignment = internal::alignment_of<TYPE>::val;
 			type_info.m_Constructor = internal::ConstructObject<TYPE>;
 			type_info.m_Destructor = internal::DestructObject<TYPE>;
+			type_info.m_Assign = internal::AssignObject<TYPE>;
+			type_info.m_Swap = internal::SwapObject<TYPE>;
+			type_info.m_ArrayConstructor = internal::ConstructArray<TYPE>;
+			type_info.m_ArrayDestructor = internal::DestructArray<TYPE>;
+			type_info.m_IsPOD = internal::is_pod<TYPE>::val != 0;
+			type_info.m_NumericKind = (NumericKind)internal::numeric_kind<TYPE>::val;
 			return type_info;
 		}
 
-		TypeInfo() : m_IsPointer(0), m_Size(0)
+		TypeInfo() : m_IsPointer(0), m_Size(0), m_Alignment(0), m_Assign(0), m_Swap(0), m_IsPOD(false), m_NumericKind(NUMERIC_NONE)
 		{
 		}
 
@@ -71,11 +151,29 @@ namespace rflb
 		Name m_Name;
 		bool m_IsPointer;
 		int m_Size;
+		int m_Alignment;
 		internal::ConstructObjectFunc m_Constructor;
 		internal::DestructObjectFunc m_Destructor;
+		internal::AssignObjectFunc m_Assign;
+		internal::SwapObjectFunc m_Swap;
+		internal::ConstructArrayFunc m_ArrayConstructor;
+		internal::DestructArrayFunc m_ArrayDestructor;
+		bool m_IsPOD;
+		NumericKind m_NumericKind;
 	};
 
 
+	namespace internal
+	{
+		// Type info created once per type, for quick type checks and registration
+		template <typename TYPE> const TypeInfo& GetTypeInfo()
+		{
+			static const TypeInfo type_info = TypeInfo::Create<TYPE>();
+			return type_info;
+		}
+	}
+
+
 	// This is the persistent type object, stored in the type database
 	class Type
 	{
@@ -92,40 +190,126 @@ namespace rflb
 		Type& LoadSaveBinaryIFFv(SerialiseLoadFunc load, SerialiseSaveFunc save);
 		Type& LoadSaveTextXML(SerialiseLoadFunc load, SerialiseSaveFunc save);
 
-		// TODO: Store database locally so that this can be a templated function?
-		Type& Inherits(Type& base);
-
-		void ConstructObject(void* object);
-		void DestructObject(void* object);
-
+		// Serialisers written by BinaryCodeGenerator, which only replace the field walk of binary
+		// data with no flags and all profiles. Unlike LoadSaveBinary the type's fields stay
+		// visible to the columnar, presence and image paths.
+		Type& GeneratedBinary(SerialiseLoadFunc load, SerialiseSaveFunc save);
+		Type& CustomCopy(CustomCopyFunc copy);
+		Type& CustomCompare(CustomEqualFunc equal, CustomHashFunc hash);
+		Type& CustomMeasure(CustomMeasureFunc measure);
+
+		// The offset is where the base type starts within this type, which is only zero for the
+		// first base. TypeDatabase::SetTypeBase figures it out from the C++ types.
+		Type& Inherits(Type& base, u32 offset = 0);
+
+		void ConstructObject(void* object) const;
+		void DestructObject(void* object) const;
+		void AssignObject(void* dst, const void* src) const;
+		void SwapObjects(void* a, void* b) const;
+
+		// Construct/destruct count adjacent objects with one call, which does nothing for PODs
+		// as they're left uninitialised the same as ConstructObject
+		void ConstructArray(void* objects, int count) const;
+		void DestructArray(void* objects, int count) const;
+
+		const Name& GetName() const { return m_Name; }
 		int GetSize() const { return m_Size; }
+		int GetAlignment() const { return m_Alignment; }
 		const Fields& GetFields() const { return m_Fields; }
+
+		// Fields that belong to any of the profiles in the mask, excluding transient fields.
+		// Built on first use for each mask.
+		const FieldList& GetProfileFields(u32 profile) const;
+
+		// Profile fields of the type followed by those of its base types, recursively, with
+		// offsets from the start of this type. This is the order the binary serialiser writes
+		// them in, so objects can be walked without recursing into base types. Built on first
+		// use for each mask and rebuilt after any type is modified.
+		const FieldList& GetFlattenedFields(u32 profile) const;
+
+		// Fewest bytes the binary serialiser can write an object in with a profile, for checking
+		// counts read from untrusted data against what's left. Zero for types with custom
+		// binary serialisers. Cached along with the flattened fields.
+		u32 GetMinBinarySize(u32 profile) const;
+
 		const Serialisers& GetSerialisers() const { return m_Serialisers; }
 		int GetNbBaseTypes() const { return m_NbBaseTypes; }
 		Type& GetBaseType(int index) const { RFLB_ASSERT(index >= 0 && index <  m_NbBaseTypes); return *m_BaseTypes[index]; }
+		u32 GetBaseOffset(int index) const { RFLB_ASSERT(index >= 0 && index <  m_NbBaseTypes); return m_BaseOffsets[index]; }
+		bool IsPOD() const { return m_IsPOD; }
+		NumericKind GetNumericKind() const { return m_NumericKind; }
+		CustomCopyFunc GetCustomCopy() const { return m_CustomCopy; }
+		CustomEqualFunc GetCustomEqual() const { return m_CustomEqual; }
+		CustomHashFunc GetCustomHash() const { return m_CustomHash; }
+		CustomMeasureFunc GetCustomMeasure() const { return m_CustomMeasure; }
+		SerialiseLoadFunc GetGeneratedLoad() const { return m_GeneratedLoad; }
+		SerialiseSaveFunc GetGeneratedSave() const { return m_GeneratedSave; }
+
+		// Built on first use and rebuilt after any type is modified
+		const internal::CopyPlan& GetCopyPlan() const;
+		const internal::CopyPlan& GetComparePlan() const;
+
+		// Blocks of adjacent PODs and individual fields that the binary serialiser writes for a
+		// profile, for eliding values that match the default object
+		const internal::CopyPlan& GetPresencePlan(u32 profile) const;
+
+		// Default constructed instance of the type, built on first use, with anything the
+		// constructor leaves uninitialised zeroed
+		const void* GetDefaultObject() const;
 
 		friend class TypeDatabase;
 
 	private:
 		void SetFields(const FieldInfo* fields, int nb_fields, TypeDatabase& type_db);
+		void SetFields(const StaticFieldInfo* fields, int nb_fields, TypeDatabase& type_db);
+		void SortFields();
+		void ResetCopyPlan();
 
 		// Description of the type
 		Name m_Name;
 		int m_Size;
+		int m_Alignment;
 
 		// Constructor/destructor
 		internal::ConstructObjectFunc m_Constructor;
 		internal::DestructObjectFunc m_Destructor;
+		internal::AssignObjectFunc m_Assign;
+		internal::SwapObjectFunc m_Swap;
+		internal::ConstructArrayFunc m_ArrayConstructor;
+		internal::DestructArrayFunc m_ArrayDestructor;
+		bool m_IsPOD;
+		NumericKind m_NumericKind;
+
+		CustomCopyFunc m_CustomCopy;
+		CustomEqualFunc m_CustomEqual;
+		CustomHashFunc m_CustomHash;
+		CustomMeasureFunc m_CustomMeasure;
+		mutable internal::CopyPlan* m_CopyPlan;
+		mutable internal::CopyPlan* m_ComparePlan;
+		mutable std::map<u32, internal::CopyPlan*> m_PresencePlans;
+		mutable void* m_DefaultObject;
 
 		// Easily searchable array of fields in the type
 		// Order is not guaranteed to match registration order
 		Fields m_Fields;
 
+		mutable std::map<u32, FieldList> m_ProfileFields;
+
+		// Copies of the fields of the whole hierarchy with their offsets adjusted, along with
+		// the generation of type changes they were built for
+		mutable std::vector<Field> m_FlattenedFields;
+		mutable std::map<u32, FieldList> m_FlattenedProfileFields;
+		mutable std::map<u32, u32> m_MinBinarySizes;
+		mutable u32 m_FlattenedGeneration;
+
 		Serialisers m_Serialisers;
+		SerialiseLoadFunc m_GeneratedLoad;
+		SerialiseSaveFunc m_GeneratedSave;
 
 		// List of base types with very limited multiple inheritance
 		static const int MAX_BASE_TYPES = 3;
 		Type* m_BaseTypes[MAX_BASE_TYPES];
+		u32 m_BaseOffsets[MAX_BASE_TYPES];
 		int m_NbBaseTypes;
 	};
 }
\ No newline at end of file
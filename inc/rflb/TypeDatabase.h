@@ -4,6 +4,7 @@
 
 #include <typeinfo>
 #include <map>
+#include <vector>
 #include <rflb/Utils.h>
 
 
@@ -11,10 +12,18 @@ namespace rflb
 {
 	struct TypeInfo;
 	struct FieldInfo;
+	struct StaticFieldInfo;
 	struct Field;
+	struct IContainerFactory;
 	class Type;
 
 
+	namespace internal
+	{
+		typedef IContainerFactory* (*CreateContainerFactoryFunc)(TypeInfo& key_type, TypeInfo& value_type);
+	}
+
+
 	class TypeDatabase
 	{
 	public:
@@ -41,8 +50,34 @@ namespace rflb
 			return type;
 		}
 
+		template <typename TYPE, size_t N> Type& SetTypeFields(const StaticFieldInfo (&fields)[N])
+		{
+			Type& type = GetType<TYPE>();
+			type.SetFields(fields, N, *this);
+			return type;
+		}
+
+		// Registers BASE as a base type of TYPE, at the offset the compiler places it
+		template <typename TYPE, typename BASE> Type& SetTypeBase()
+		{
+			// Any address will do as long as the cast doesn't see a null pointer
+			const TYPE* object = (const TYPE*)0x1000;
+			u32 offset = (u32)((const char*)static_cast<const BASE*>(object) - (const char*)object);
+			return GetType<TYPE>().Inherits(GetType<BASE>(), offset);
+		}
+
+		// Returns the factory shared by all fields of a container type, creating it on first use.
+		// Returns null if the type isn't a container.
+		IContainerFactory* GetContainerFactory(const TypeInfo& type_info, internal::CreateContainerFactoryFunc create);
+
+		// Appends every type created so far, in no particular order
+		void GetTypes(std::vector<const Type*>& types) const;
+
 	private:
 		// Map of all created types
 		std::map<u32, Type*> m_Types;
+
+		// Container factories for static fields, by container type name
+		std::map<u32, IContainerFactory*> m_ContainerFactories;
 	};
 }
\ No newline at end of file
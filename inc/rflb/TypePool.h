@@ -0,0 +1,58 @@
+
+#pragma once
+
+
+#include <vector>
+
+
+namespace rflb
+{
+	class Type;
+
+
+	//
+	// Allocator for objects of a type that's only known at runtime, such as those created by
+	// type ID while loading. Objects are carved from slabs that are sized and aligned for the
+	// type, so that there's one heap allocation per slab rather than per object, and freed
+	// objects are kept for reuse. Slabs are released when the pool is destroyed, without
+	// destructing any objects that are still allocated.
+	//
+	class TypePool
+	{
+	public:
+		TypePool(const Type* type, int nb_objects_per_slab = 64);
+		~TypePool();
+
+		void* New();
+		void Delete(void* object);
+
+		// Adjacent objects constructed and destructed with one call, which can be freed
+		// individually or together
+		void* NewArray(int count);
+		void DeleteArray(void* objects, int count);
+
+		const Type* GetType() const { return m_Type; }
+
+	private:
+		// Non-copyable
+		TypePool(const TypePool&);
+		TypePool& operator = (const TypePool&);
+
+		// Allocates adjacent slots, each of which can hold one object
+		char* Allocate(int nb_slots);
+		int GetNbSlots(int nb_objects) const;
+
+		const Type* m_Type;
+		int m_ObjectSize;
+		int m_Alignment;
+		int m_NbObjectsPerSlab;
+
+		// Unaligned slab allocations, with the unused space of the last one
+		std::vector<void*> m_Slabs;
+		char* m_Next;
+		char* m_End;
+
+		// Freed objects, each storing the next
+		void* m_FreeList;
+	};
+}
\ No newline at end of file
@@ -11,6 +11,16 @@ typedef unsigned int u32;
 
 namespace rflb
 {
+	// Arithmetic types, for serialisers that encode numbers rather than copying bytes
+	enum NumericKind
+	{
+		NUMERIC_NONE,
+		NUMERIC_SIGNED,
+		NUMERIC_UNSIGNED,
+		NUMERIC_FLOAT
+	};
+
+
 	namespace internal
 	{
 		// Very basic static assert, based on the Boost implementation - can only be used at function scope
@@ -61,6 +71,51 @@ namespace rflb
 		{
 			typedef TYPE Type;
 		};
+
+
+		// Figure out if a type can be copied with memcpy, using the compiler intrinsic
+		template <typename TYPE> struct is_pod
+		{
+			enum { val = __is_pod(TYPE) };
+		};
+
+
+		// Alignment of a type, from the padding the compiler places before it in a struct
+		template <typename TYPE> struct alignment_of
+		{
+			struct Padded
+			{
+				char c;
+				TYPE t;
+			};
+			enum { val = sizeof(Padded) - sizeof(TYPE) };
+		};
+
+
+		// Figure out the arithmetic kind of a type, with plain char signed or not depending on the compiler
+		template <typename TYPE> struct numeric_kind
+		{
+			enum { val = NUMERIC_NONE };
+		};
+		#define RFLB_NUMERIC_KIND(type, kind)	\
+			template <> struct numeric_kind<type> { enum { val = kind }; };
+		#define RFLB_NUMERIC_KIND_INT(type) RFLB_NUMERIC_KIND(type, (type)-1 < (type)0 ? NUMERIC_SIGNED : NUMERIC_UNSIGNED)
+		RFLB_NUMERIC_KIND_INT(char)
+		RFLB_NUMERIC_KIND_INT(signed char)
+		RFLB_NUMERIC_KIND_INT(unsigned char)
+		RFLB_NUMERIC_KIND_INT(short)
+		RFLB_NUMERIC_KIND_INT(unsigned short)
+		RFLB_NUMERIC_KIND_INT(int)
+		RFLB_NUMERIC_KIND_INT(unsigned int)
+		RFLB_NUMERIC_KIND_INT(long)
+		RFLB_NUMERIC_KIND_INT(unsigned long)
+		RFLB_NUMERIC_KIND_INT(__int64)
+		RFLB_NUMERIC_KIND_INT(unsigned __int64)
+		RFLB_NUMERIC_KIND(bool, NUMERIC_UNSIGNED)
+		RFLB_NUMERIC_KIND(float, NUMERIC_FLOAT)
+		RFLB_NUMERIC_KIND(double, NUMERIC_FLOAT)
+		#undef RFLB_NUMERIC_KIND_INT
+		#undef RFLB_NUMERIC_KIND
 	}
 
 
@@ -90,9 +145,25 @@ namespace rflb
 	};
 
 
+	// Fields belong to any combination of up to 32 user-defined profiles, such as disk or network,
+	// and serialisation can be restricted to the fields of a set of profiles
+	const u32 PROFILE_ALL = 0xFFFFFFFF;
+
+
 	typedef void (*SerialiseSaveFunc)(std::ostream&, u32 version, const void* data);
 	typedef void (*SerialiseLoadFunc)(std::istream&, u32 version, void* data);
 
+	// Replaces the default reflection copy of a type or field
+	typedef void (*CustomCopyFunc)(void* dst, const void* src);
+
+	// Replaces the default reflection equality/hash of a type
+	typedef bool (*CustomEqualFunc)(const void* a, const void* b);
+	typedef u32 (*CustomHashFunc)(const void* object, u32 seed);
+
+	// Returns the heap memory owned by an object of a type that doesn't expose it through
+	// fields, such as a string
+	typedef size_t (*CustomMeasureFunc)(const void* object);
+
 	enum SerialiseMethod
 	{
 		SERIALISE_METHOD_BINARY,
@@ -4,6 +4,7 @@
 
 #include <rflb/Container.h>
 #include <rflb/Utils.h>
+#include <algorithm>
 #include <vector>
 
 
@@ -52,6 +53,15 @@ namespace rflb
 				return m_Iterator != m_Container.end();
 			}
 
+			ContainerMemory GetMemory() const
+			{
+				ContainerMemory memory;
+				memory.m_Allocated = m_Container.capacity() * sizeof(TYPE);
+				memory.m_Unused = (m_Container.capacity() - m_Container.size()) * sizeof(TYPE);
+				memory.m_Overhead = 0;
+				return memory;
+			}
+
 		private:
 			const Container& m_Container;
 			Iterator m_Iterator;
@@ -65,7 +75,8 @@ namespace rflb
 			typedef std::vector<TYPE, ALLOCATOR> Container;
 
 			VectorWriteIterator(Container* container) :
-				m_Container(*container)
+				m_Container(*container),
+				m_Position(0)
 			{
 			}
 
@@ -91,8 +102,52 @@ namespace rflb
 				return 0;
 			}
 
+			void AddSwap(void* object)
+			{
+				using std::swap;
+				swap(*(TYPE*)AddEmpty(), *(TYPE*)object);
+			}
+
+			void AddSwap(void*, void*)
+			{
+				RFLB_ASSERT(false);
+			}
+
+			void Clear()
+			{
+				m_Container.clear();
+			}
+
+			void Reserve(int count)
+			{
+				m_Container.reserve(m_Container.size() + count);
+			}
+
+			void BeginOverwrite(int count)
+			{
+				// Only allocates when there's more to load than there's capacity for
+				m_Position = 0;
+				m_Container.reserve(count);
+			}
+
+			void* Overwrite()
+			{
+				if (m_Position < (int)m_Container.size())
+					return &m_Container[m_Position++];
+				m_Position++;
+				return AddEmpty();
+			}
+
+			void EndOverwrite()
+			{
+				m_Container.erase(m_Container.begin() + m_Position, m_Container.end());
+			}
+
 		private:
 			Container& m_Container;
+
+			// Next value to overwrite
+			int m_Position;
 		};
 
 
@@ -101,10 +156,12 @@ namespace rflb
 		{
 			value_type = TypeInfo::Create<TYPE>();
 
-			return new internal::ContainerFactory<
+			IContainerFactory* factory = new internal::ContainerFactory<
 				std::vector<TYPE, ALLOCATOR>,
 				VectorReadIterator<TYPE, ALLOCATOR>,
 				VectorWriteIterator<TYPE, ALLOCATOR> >();
+			factory->m_IsContiguous = true;
+			return factory;
 		}
 	}
 }
\ No newline at end of file
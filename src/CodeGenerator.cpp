@@ -0,0 +1,352 @@
+
+#include <rflb/CodeGenerator.h>
+#include <rflb/Field.h>
+#include <rflb/Container.h>
+#include <iostream>
+#include <sstream>
+
+using namespace rflb;
+
+
+namespace
+{
+	enum FieldCode
+	{
+		// Pointers aren't serialised
+		FIELD_CODE_NONE,
+
+		FIELD_CODE_POD,
+		FIELD_CODE_POD_ARRAY,
+		FIELD_CODE_POD_VECTOR,
+		FIELD_CODE_GENERATED_OBJECT,
+		FIELD_CODE_FALLBACK
+	};
+
+
+	bool HasSerialiser(const Serialisers& serialisers)
+	{
+		return serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY] != 0 || serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY] != 0;
+	}
+
+
+	bool IsPlainPOD(const Type* type, bool is_pointer)
+	{
+		return !is_pointer && !HasSerialiser(type->GetSerialisers()) && type->GetFields().empty();
+	}
+
+
+	// Follows the same order of checks as the runtime binary serialiser
+	FieldCode GetFieldCode(const Field& field, bool is_generated)
+	{
+		if (HasSerialiser(field.m_Serialisers))
+			return FIELD_CODE_FALLBACK;
+
+		if (field.m_IsPointer)
+			return FIELD_CODE_NONE;
+
+		if (HasSerialiser(field.m_Type->GetSerialisers()))
+			return FIELD_CODE_FALLBACK;
+
+		if (IContainerFactory* factory = field.m_ContainerFactory)
+		{
+			if (factory->m_KeyType == 0 && IsPlainPOD(factory->m_ValueType, factory->m_ValueIsPointer))
+			{
+				if (factory->m_IsInline)
+					return FIELD_CODE_POD_ARRAY;
+				if (factory->m_IsContiguous)
+					return FIELD_CODE_POD_VECTOR;
+			}
+			return FIELD_CODE_FALLBACK;
+		}
+
+		if (field.m_Type->GetFields().empty())
+			return FIELD_CODE_POD;
+
+		return is_generated ? FIELD_CODE_GENERATED_OBJECT : FIELD_CODE_FALLBACK;
+	}
+
+
+	std::string MakeIdentifier(const char* cpp_name)
+	{
+		std::string identifier;
+		for (const char* c = cpp_name; *c; c++)
+		{
+			bool valid = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9');
+			identifier += valid ? *c : '_';
+		}
+		return identifier;
+	}
+
+
+	// Expression for the address of a base type within the object at data
+	std::string MakeBaseData(const char* cast, u32 offset)
+	{
+		if (offset == 0)
+			return "data";
+		std::ostringstream data;
+		data << "(" << cast << ")data + " << offset;
+		return data.str();
+	}
+}
+
+
+rflb::BinaryCodeGenerator::BinaryCodeGenerator(const char* register_function_name)
+	: m_RegisterFunctionName(register_function_name)
+{
+}
+
+
+void rflb::BinaryCodeGenerator::AddInclude(const char* filename)
+{
+	m_Includes.push_back(filename);
+}
+
+
+void rflb::BinaryCodeGenerator::AddType(const Type* type, const char* cpp_name)
+{
+	RFLB_ASSERT(FindType(type) == 0);
+	GeneratedType generated_type;
+	generated_type.m_Type = type;
+	generated_type.m_CppName = cpp_name;
+	generated_type.m_FunctionSuffix = MakeIdentifier(cpp_name);
+	m_Types.push_back(generated_type);
+}
+
+
+const rflb::BinaryCodeGenerator::GeneratedType* rflb::BinaryCodeGenerator::FindType(const Type* type) const
+{
+	for (size_t i = 0; i < m_Types.size(); i++)
+	{
+		if (m_Types[i].m_Type == type)
+			return &m_Types[i];
+	}
+	return 0;
+}
+
+
+void rflb::BinaryCodeGenerator::GenerateSave(std::ostream& stream, const GeneratedType& type, std::vector<Fallback>& field_fallbacks, std::vector<Fallback>& base_fallbacks) const
+{
+	const std::string& name = type.m_CppName;
+	stream << "\n\n\tvoid SaveBinary_" << type.m_FunctionSuffix << "(std::ostream& stream, u32, const void* data)\n\t{\n";
+	stream << "\t\tconst " << name << "& object = *(const " << name << "*)data;\n";
+	stream << "\t\t(void)object;\n";
+
+	const FieldList& fields = type.m_Type->GetProfileFields(PROFILE_ALL);
+	for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+	{
+		const Field& field = **i;
+		RFLB_ASSERT(field.m_Name.m_Text != 0);
+		std::string member = std::string("object.") + field.m_Name.m_Text;
+		const GeneratedType* field_type = FindType(field.m_Type);
+
+		switch (GetFieldCode(field, field_type != 0))
+		{
+			case FIELD_CODE_NONE:
+				stream << "\t\t// " << field.m_Name.m_Text << " is a pointer\n";
+				break;
+
+			case FIELD_CODE_POD:
+				stream << "\t\tstream.write((const char*)&" << member << ", sizeof(" << member << "));\n";
+				break;
+
+			case FIELD_CODE_POD_ARRAY:
+				stream << "\t\trflb::StreamWrite(stream, (int)(sizeof(" << member << ") / sizeof(" << member << "[0])));\n";
+				stream << "\t\tstream.write((const char*)" << member << ", sizeof(" << member << "));\n";
+				break;
+
+			case FIELD_CODE_POD_VECTOR:
+				stream << "\t\t{\n";
+				stream << "\t\t\tint count = (int)" << member << ".size();\n";
+				stream << "\t\t\trflb::StreamWrite(stream, count);\n";
+				stream << "\t\t\tif (count)\n";
+				stream << "\t\t\t\tstream.write((const char*)&" << member << "[0], count * sizeof(" << member << "[0]));\n";
+				stream << "\t\t}\n";
+				break;
+
+			case FIELD_CODE_GENERATED_OBJECT:
+				stream << "\t\tSaveBinary_" << field_type->m_FunctionSuffix << "(stream, 0, &" << member << ");\n";
+				break;
+
+			case FIELD_CODE_FALLBACK:
+			{
+				Fallback fallback = { (int)(&type - &m_Types[0]), field.m_Name.m_CRC, -1 };
+				stream << "\t\tserialise::SaveBinaryField(stream, &object, *g_Fields[" << field_fallbacks.size() << "]);\n";
+				field_fallbacks.push_back(fallback);
+				break;
+			}
+		}
+	}
+
+	// Base types follow the fields
+	for (int i = 0; i < type.m_Type->GetNbBaseTypes(); i++)
+	{
+		std::string base_data = MakeBaseData("const char*", type.m_Type->GetBaseOffset(i));
+		if (const GeneratedType* base_type = FindType(&type.m_Type->GetBaseType(i)))
+		{
+			stream << "\t\tSaveBinary_" << base_type->m_FunctionSuffix << "(stream, 0, " << base_data << ");\n";
+		}
+		else
+		{
+			Fallback fallback = { (int)(&type - &m_Types[0]), 0, i };
+			stream << "\t\tserialise::SaveBinary(stream, " << base_data << ", g_BaseTypes[" << base_fallbacks.size() << "]);\n";
+			base_fallbacks.push_back(fallback);
+		}
+	}
+
+	stream << "\t}\n";
+}
+
+
+void rflb::BinaryCodeGenerator::GenerateLoad(std::ostream& stream, const GeneratedType& type, std::vector<Fallback>& field_fallbacks, std::vector<Fallback>& base_fallbacks) const
+{
+	const std::string& name = type.m_CppName;
+	stream << "\n\n\tvoid LoadBinary_" << type.m_FunctionSuffix << "(std::istream& stream, u32, void* data)\n\t{\n";
+	stream << "\t\t" << name << "& object = *(" << name << "*)data;\n";
+	stream << "\t\t(void)object;\n";
+
+	const FieldList& fields = type.m_Type->GetProfileFields(PROFILE_ALL);
+	for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+	{
+		const Field& field = **i;
+		std::string member = std::string("object.") + field.m_Name.m_Text;
+		const GeneratedType* field_type = FindType(field.m_Type);
+
+		switch (GetFieldCode(field, field_type != 0))
+		{
+			case FIELD_CODE_NONE:
+				stream << "\t\t// " << field.m_Name.m_Text << " is a pointer\n";
+				break;
+
+			case FIELD_CODE_POD:
+				stream << "\t\tstream.read((char*)&" << member << ", sizeof(" << member << "));\n";
+				break;
+
+			case FIELD_CODE_POD_ARRAY:
+				stream << "\t\t{\n";
+				stream << "\t\t\tint count;\n";
+				stream << "\t\t\trflb::StreamRead(stream, count);\n";
+				stream << "\t\t\tif (!serialise::CheckBound(stream, count, sizeof(" << member << "[0])))\n";
+				stream << "\t\t\t\treturn;\n";
+				stream << "\t\t\tRFLB_ASSERT(count >= 0 && count * sizeof(" << member << "[0]) <= sizeof(" << member << "));\n";
+				stream << "\t\t\tstream.read((char*)" << member << ", count * sizeof(" << member << "[0]));\n";
+				stream << "\t\t}\n";
+				break;
+
+			case FIELD_CODE_POD_VECTOR:
+				// Loaded values are added to the end of the vector, the same as the runtime serialiser
+				stream << "\t\t{\n";
+				stream << "\t\t\tint count;\n";
+				stream << "\t\t\trflb::StreamRead(stream, count);\n";
+				stream << "\t\t\tif (!serialise::CheckBound(stream, count, sizeof(" << member << "[0])))\n";
+				stream << "\t\t\t\treturn;\n";
+				stream << "\t\t\tsize_t start = " << member << ".size();\n";
+				stream << "\t\t\t" << member << ".resize(start + count);\n";
+				stream << "\t\t\tif (count)\n";
+				stream << "\t\t\t\tstream.read((char*)&" << member << "[start], count * sizeof(" << member << "[0]));\n";
+				stream << "\t\t}\n";
+				break;
+
+			case FIELD_CODE_GENERATED_OBJECT:
+				stream << "\t\tLoadBinary_" << field_type->m_FunctionSuffix << "(stream, 0, &" << member << ");\n";
+				break;
+
+			case FIELD_CODE_FALLBACK:
+				stream << "\t\tserialise::LoadBinaryField(stream, &object, *g_Fields[" << field_fallbacks.size() << "]);\n";
+				field_fallbacks.push_back(Fallback());
+				break;
+		}
+	}
+
+	for (int i = 0; i < type.m_Type->GetNbBaseTypes(); i++)
+	{
+		std::string base_data = MakeBaseData("char*", type.m_Type->GetBaseOffset(i));
+		if (const GeneratedType* base_type = FindType(&type.m_Type->GetBaseType(i)))
+		{
+			stream << "\t\tLoadBinary_" << base_type->m_FunctionSuffix << "(stream, 0, " << base_data << ");\n";
+		}
+		else
+		{
+			stream << "\t\tserialise::LoadBinary(stream, " << base_data << ", g_BaseTypes[" << base_fallbacks.size() << "]);\n";
+			base_fallbacks.push_back(Fallback());
+		}
+	}
+
+	stream << "\t}\n";
+}
+
+
+void rflb::BinaryCodeGenerator::Generate(std::ostream& stream) const
+{
+	stream << "\n// Generated by rflb::BinaryCodeGenerator - do not edit\n\n";
+	for (size_t i = 0; i < m_Includes.size(); i++)
+	{
+		stream << "#include \"" << m_Includes[i] << "\"\n";
+	}
+	stream << "#include <rflb/Type.h>\n";
+	stream << "#include <rflb/Field.h>\n";
+	stream << "#include <rflb/TypeDatabase.h>\n";
+	stream << "#include <rflb/SerialiseBinary.h>\n";
+	stream << "#include <iostream>\n\n\n";
+
+	// Generate the functions to a separate buffer first to collect the fallbacks. The load
+	// functions visit fields in the same order as the save functions so use the same indices.
+	std::ostringstream functions;
+	std::vector<Fallback> field_fallbacks, base_fallbacks;
+	for (size_t i = 0; i < m_Types.size(); i++)
+	{
+		std::vector<Fallback> load_field_fallbacks(field_fallbacks.size()), load_base_fallbacks(base_fallbacks.size());
+		GenerateSave(functions, m_Types[i], field_fallbacks, base_fallbacks);
+		GenerateLoad(functions, m_Types[i], load_field_fallbacks, load_base_fallbacks);
+		RFLB_ASSERT(load_field_fallbacks.size() == field_fallbacks.size());
+		RFLB_ASSERT(load_base_fallbacks.size() == base_fallbacks.size());
+	}
+
+	// Only the arrays that are used are declared, to keep the generated code free of warnings
+	stream << "namespace\n{\n";
+	if (!field_fallbacks.empty() || !base_fallbacks.empty())
+	{
+		stream << "\t// Fields and base types that use the runtime serialiser\n";
+		if (!field_fallbacks.empty())
+			stream << "\tconst rflb::Field* g_Fields[" << field_fallbacks.size() << "];\n";
+		if (!base_fallbacks.empty())
+			stream << "\tconst rflb::Type* g_BaseTypes[" << base_fallbacks.size() << "];\n";
+		stream << "\n\n";
+	}
+
+	for (size_t i = 0; i < m_Types.size(); i++)
+	{
+		stream << "\tvoid SaveBinary_" << m_Types[i].m_FunctionSuffix << "(std::ostream& stream, u32, const void* data);\n";
+		stream << "\tvoid LoadBinary_" << m_Types[i].m_FunctionSuffix << "(std::istream& stream, u32, void* data);\n";
+	}
+	stream << functions.str();
+	stream << "}\n\n\n";
+
+	stream << "void " << m_RegisterFunctionName << "(rflb::TypeDatabase& db)\n{\n";
+	for (size_t i = 0; i < m_Types.size(); i++)
+	{
+		const GeneratedType& type = m_Types[i];
+		stream << "\trflb::Type& type_" << type.m_FunctionSuffix << " = db.GetType<" << type.m_CppName << ">();\n";
+	}
+	stream << "\n";
+
+	for (size_t i = 0; i < field_fallbacks.size(); i++)
+	{
+		const Fallback& fallback = field_fallbacks[i];
+		const std::string& suffix = m_Types[fallback.m_TypeIndex].m_FunctionSuffix;
+		stream << "\tg_Fields[" << i << "] = &type_" << suffix << ".GetField(rflb::Name((u32)0x" << std::hex << fallback.m_FieldCRC << std::dec << "));\n";
+	}
+	for (size_t i = 0; i < base_fallbacks.size(); i++)
+	{
+		const Fallback& fallback = base_fallbacks[i];
+		const std::string& suffix = m_Types[fallback.m_TypeIndex].m_FunctionSuffix;
+		stream << "\tg_BaseTypes[" << i << "] = &type_" << suffix << ".GetBaseType(" << fallback.m_BaseIndex << ");\n";
+	}
+	stream << "\n";
+
+	for (size_t i = 0; i < m_Types.size(); i++)
+	{
+		const std::string& suffix = m_Types[i].m_FunctionSuffix;
+		stream << "\ttype_" << suffix << ".GeneratedBinary(LoadBinary_" << suffix << ", SaveBinary_" << suffix << ");\n";
+	}
+	stream << "}\n";
+}
\ No newline at end of file
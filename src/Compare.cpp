@@ -0,0 +1,259 @@
+
+#include <rflb/Compare.h>
+#include <rflb/Copy.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace rflb;
+
+
+namespace
+{
+	// MurmurHash3 mixing functions
+	inline u32 Rotate(u32 x, int r)
+	{
+		return (x << r) | (x >> (32 - r));
+	}
+
+	inline u32 MixWord(u32 hash, u32 word)
+	{
+		word *= 0xcc9e2d51;
+		word = Rotate(word, 15);
+		word *= 0x1b873593;
+		hash ^= word;
+		hash = Rotate(hash, 13);
+		return hash * 5 + 0xe6546b64;
+	}
+
+	inline u32 Finalise(u32 hash, u32 size)
+	{
+		hash ^= size;
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6b;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+
+	bool EqualValue(const void* a, const void* b, const Type* object_type, bool is_pointer, IContainerFactory* factory);
+	u32 HashValue(const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, u32 hash);
+
+
+	bool EqualCollection(const void* a, const void* b, IContainerFactory* factory)
+	{
+		const Type* key_type = factory->m_KeyType;
+		const Type* value_type = factory->m_ValueType;
+		IReadIterator* iterator_a = RFLB_NEW_TEMP_READ_ITERATOR(factory, a);
+		IReadIterator* iterator_b = RFLB_NEW_TEMP_READ_ITERATOR(factory, b);
+
+		bool equal = iterator_a->GetCount() == iterator_b->GetCount();
+		for ( ; equal && iterator_a->IsValid(); iterator_a->MoveNext(), iterator_b->MoveNext())
+		{
+			if (key_type && !EqualValue(iterator_a->GetKey(), iterator_b->GetKey(), key_type, factory->m_KeyIsPointer, 0))
+				equal = false;
+			else if (!EqualValue(iterator_a->GetValue(), iterator_b->GetValue(), value_type, factory->m_ValueIsPointer, 0))
+				equal = false;
+		}
+
+		RFLB_DELETE_TEMP_ITERATOR(factory, iterator_b);
+		RFLB_DELETE_TEMP_ITERATOR(factory, iterator_a);
+		return equal;
+	}
+
+
+	bool EqualValue(const void* a, const void* b, const Type* object_type, bool is_pointer, IContainerFactory* factory)
+	{
+		if (is_pointer)
+		{
+			return *(void* const*)a == *(void* const*)b;
+		}
+
+		else if (CustomEqualFunc equal = object_type->GetCustomEqual())
+		{
+			return equal(a, b);
+		}
+
+		else if (factory)
+		{
+			return EqualCollection(a, b, factory);
+		}
+
+		else if (object_type->GetFields().empty())
+		{
+			// The bytes of anything else, such as strings, include pointers
+			RFLB_ASSERT(object_type->IsPOD());
+			return memcmp(a, b, object_type->GetSize()) == 0;
+		}
+
+		const internal::CopyPlan& plan = object_type->GetComparePlan();
+		for (size_t i = 0; i < plan.m_Steps.size(); i++)
+		{
+			const internal::CopyStep& step = plan.m_Steps[i];
+			const char* step_a = (const char*)a + step.m_Offset;
+			const char* step_b = (const char*)b + step.m_Offset;
+
+			if (const Field* field = step.m_Field)
+			{
+				if (!EqualValue(step_a, step_b, field->m_Type, field->m_IsPointer, field->m_ContainerFactory))
+					return false;
+			}
+
+			else if (memcmp(step_a, step_b, step.m_Size) != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	u32 HashCollection(const void* object, IContainerFactory* factory, u32 hash)
+	{
+		const Type* key_type = factory->m_KeyType;
+		const Type* value_type = factory->m_ValueType;
+		IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, object);
+
+		hash = MixWord(hash, iterator->GetCount());
+		for ( ; iterator->IsValid(); iterator->MoveNext())
+		{
+			if (key_type)
+				hash = HashValue(iterator->GetKey(), key_type, factory->m_KeyIsPointer, 0, hash);
+			hash = HashValue(iterator->GetValue(), value_type, factory->m_ValueIsPointer, 0, hash);
+		}
+
+		RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+		return hash;
+	}
+
+
+	u32 HashValue(const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, u32 hash)
+	{
+		if (is_pointer)
+		{
+			return HashBytes(object, sizeof(void*), hash);
+		}
+
+		else if (CustomHashFunc custom_hash = object_type->GetCustomHash())
+		{
+			return custom_hash(object, hash);
+		}
+
+		else if (factory)
+		{
+			return HashCollection(object, factory, hash);
+		}
+
+		else if (object_type->GetFields().empty())
+		{
+			RFLB_ASSERT(object_type->IsPOD());
+			return HashBytes(object, object_type->GetSize(), hash);
+		}
+
+		const internal::CopyPlan& plan = object_type->GetComparePlan();
+		for (size_t i = 0; i < plan.m_Steps.size(); i++)
+		{
+			const internal::CopyStep& step = plan.m_Steps[i];
+			const char* step_object = (const char*)object + step.m_Offset;
+
+			if (const Field* field = step.m_Field)
+				hash = HashValue(step_object, field->m_Type, field->m_IsPointer, field->m_ContainerFactory, hash);
+			else
+				hash = HashBytes(step_object, step.m_Size, hash);
+		}
+
+		return hash;
+	}
+
+
+	// Mirrors EqualValue without touching any data, to find the non-PODs it would assert on
+	// Types already being checked further up are assumed comparable so recursive types terminate
+	bool CanCompareValue(const Type* object_type, bool is_pointer, IContainerFactory* factory, std::vector<const Type*>& visiting)
+	{
+		if (is_pointer || object_type->GetCustomEqual())
+			return true;
+
+		if (factory)
+		{
+			if (factory->m_KeyType && !CanCompareValue(factory->m_KeyType, factory->m_KeyIsPointer, 0, visiting))
+				return false;
+			return CanCompareValue(factory->m_ValueType, factory->m_ValueIsPointer, 0, visiting);
+		}
+
+		if (object_type->GetFields().empty())
+			return object_type->IsPOD();
+
+		if (std::find(visiting.begin(), visiting.end(), object_type) != visiting.end())
+			return true;
+		visiting.push_back(object_type);
+
+		bool can_compare = true;
+		const internal::CopyPlan& plan = object_type->GetComparePlan();
+		for (size_t i = 0; can_compare && i < plan.m_Steps.size(); i++)
+		{
+			if (const Field* field = plan.m_Steps[i].m_Field)
+				can_compare = CanCompareValue(field->m_Type, field->m_IsPointer, field->m_ContainerFactory, visiting);
+		}
+
+		visiting.pop_back();
+		return can_compare;
+	}
+}
+
+
+u32 rflb::HashBytes(const void* data, size_t size, u32 seed)
+{
+	const char* bytes = (const char*)data;
+	u32 hash = seed;
+
+	// Mix in whole words, using memcpy to avoid unaligned reads
+	size_t nb_words = size / sizeof(u32);
+	for (size_t i = 0; i < nb_words; i++)
+	{
+		u32 word;
+		memcpy(&word, bytes + i * sizeof(u32), sizeof(u32));
+		hash = MixWord(hash, word);
+	}
+
+	// Pad the remaining bytes with zero
+	size_t tail_size = size - nb_words * sizeof(u32);
+	if (tail_size)
+	{
+		u32 word = 0;
+		memcpy(&word, bytes + nb_words * sizeof(u32), tail_size);
+		hash = MixWord(hash, word);
+	}
+
+	return Finalise(hash, (u32)size);
+}
+
+
+bool rflb::EqualObjects(const void* a, const void* b, const Type* object_type)
+{
+	if (a == b)
+		return true;
+	return EqualValue(a, b, object_type, false, 0);
+}
+
+
+u32 rflb::HashObject(const void* object, const Type* object_type, u32 seed)
+{
+	return HashValue(object, object_type, false, 0, seed);
+}
+
+
+bool rflb::EqualFieldData(const void* a, const void* b, const Field& field)
+{
+	return EqualValue(a, b, field.m_Type, field.m_IsPointer, field.m_ContainerFactory);
+}
+
+
+bool rflb::CanCompareFieldData(const Field& field)
+{
+	std::vector<const Type*> visiting;
+	return CanCompareValue(field.m_Type, field.m_IsPointer, field.m_ContainerFactory, visiting);
+}
\ No newline at end of file
@@ -0,0 +1,289 @@
+
+#include <rflb/Copy.h>
+#include <rflb/Compare.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace rflb;
+
+
+namespace
+{
+	bool HasCustomFunc(const Type* type, internal::PlanUse use)
+	{
+		if (use == internal::PLAN_USE_COPY)
+			return type->GetCustomCopy() != 0;
+		return type->GetCustomEqual() != 0 || type->GetCustomHash() != 0;
+	}
+
+
+	bool IsBlockCopy(const Type* type, bool is_pointer, IContainerFactory* factory, CustomCopyFunc copy, internal::PlanUse use)
+	{
+		if (is_pointer)
+			return true;
+
+		if (copy || HasCustomFunc(type, use))
+			return false;
+
+		// Only containers that store their values in place can be copied in one go
+		if (factory)
+			return factory->m_IsInline && IsBlockCopy(factory->m_ValueType, factory->m_ValueIsPointer, 0, 0, use);
+
+		return type->GetFields().empty() && type->IsPOD();
+	}
+
+
+	void AddCopySteps(std::vector<internal::CopyStep>& steps, const Type& type, u32 offset, internal::PlanUse use)
+	{
+		const Fields& fields = type.GetFields();
+		for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			const Field& field = i->second;
+			if (use == internal::PLAN_USE_COMPARE && field.m_Attributes.transient)
+				continue;
+
+			// Field-level custom copies only apply to copying
+			CustomCopyFunc copy = use == internal::PLAN_USE_COPY ? field.m_CustomCopy : 0;
+
+			internal::CopyStep step;
+			step.m_Offset = offset + field.m_Offset;
+			step.m_Size = 0;
+			step.m_Field = 0;
+			step.m_IsComparable = true;
+
+			if (IsBlockCopy(field.m_Type, field.m_IsPointer, field.m_ContainerFactory, copy, use))
+			{
+				step.m_Size = field.m_IsPointer ? sizeof(void*) : field.m_Type->GetSize();
+				steps.push_back(step);
+			}
+
+			// Flatten embedded objects into this one so that their PODs can merge with those around them
+			else if (!field.m_ContainerFactory && !copy && !HasCustomFunc(field.m_Type, use) && !field.m_Type->GetFields().empty())
+			{
+				AddCopySteps(steps, *field.m_Type, step.m_Offset, use);
+			}
+
+			else
+			{
+				step.m_Field = &field;
+				steps.push_back(step);
+			}
+		}
+
+		for (int i = 0; i < type.GetNbBaseTypes(); i++)
+		{
+			AddCopySteps(steps, type.GetBaseType(i), offset + type.GetBaseOffset(i), use);
+		}
+	}
+
+
+	bool HasBinarySerialiser(const Serialisers& serialisers)
+	{
+		return serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY] != 0 || serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY] != 0;
+	}
+
+
+	// Mirrors how the binary serialiser walks objects, flattening only what it writes directly
+	void AddPresenceSteps(std::vector<internal::CopyStep>& steps, const Type& type, u32 offset, u32 profile)
+	{
+		const FieldList& fields = type.GetProfileFields(profile);
+		for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			const Field& field = **i;
+			bool has_field_serialiser = HasBinarySerialiser(field.m_Serialisers);
+			if (field.m_IsPointer && !has_field_serialiser)
+				continue;
+
+			internal::CopyStep step;
+			step.m_Offset = offset + field.m_Offset;
+			step.m_Size = 0;
+			step.m_Field = 0;
+			step.m_IsComparable = true;
+
+			if (has_field_serialiser || field.m_IsPointer || field.m_ContainerFactory || HasBinarySerialiser(field.m_Type->GetSerialisers()))
+			{
+				step.m_Field = &field;
+				step.m_IsComparable = CanCompareFieldData(field);
+				steps.push_back(step);
+			}
+
+			else if (field.m_Type->GetFields().empty())
+			{
+				step.m_Size = field.m_Type->GetSize();
+				steps.push_back(step);
+			}
+
+			else
+			{
+				AddPresenceSteps(steps, *field.m_Type, step.m_Offset, profile);
+			}
+		}
+
+		for (int i = 0; i < type.GetNbBaseTypes(); i++)
+		{
+			AddPresenceSteps(steps, type.GetBaseType(i), offset + type.GetBaseOffset(i), profile);
+		}
+	}
+
+
+	bool SortByOffset(const internal::CopyStep& a, const internal::CopyStep& b)
+	{
+		return a.m_Offset < b.m_Offset;
+	}
+
+
+	void CopyValue(void* dst, const void* src, const Type* object_type, bool is_pointer, IContainerFactory* factory, CustomCopyFunc copy);
+
+
+	void CopyFields(void* dst, const void* src, const internal::CopyPlan& plan)
+	{
+		for (size_t i = 0; i < plan.m_Steps.size(); i++)
+		{
+			const internal::CopyStep& step = plan.m_Steps[i];
+			char* step_dst = (char*)dst + step.m_Offset;
+			const char* step_src = (const char*)src + step.m_Offset;
+
+			if (const Field* field = step.m_Field)
+			{
+				CopyValue(step_dst, step_src, field->m_Type, field->m_IsPointer, field->m_ContainerFactory, field->m_CustomCopy);
+			}
+
+			else
+			{
+				memcpy(step_dst, step_src, step.m_Size);
+			}
+		}
+	}
+
+
+	void CopyCollection(void* dst, const void* src, IContainerFactory* factory)
+	{
+		const Type* key_type = factory->m_KeyType;
+		const Type* value_type = factory->m_ValueType;
+		IReadIterator* read_iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, src);
+
+		if (factory->m_IsInline)
+		{
+			// Values are laid out consecutively in both containers
+			int value_size = value_type->GetSize();
+			for (int i = 0; read_iterator->IsValid(); read_iterator->MoveNext(), i++)
+			{
+				CopyValue((char*)dst + i * value_size, read_iterator->GetValue(), value_type, factory->m_ValueIsPointer, 0, 0);
+			}
+		}
+
+		else
+		{
+			IWriteIterator* write_iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, dst);
+			write_iterator->Clear();
+			write_iterator->Reserve(read_iterator->GetCount());
+
+			for ( ; read_iterator->IsValid(); read_iterator->MoveNext())
+			{
+				void* value_object = key_type ? write_iterator->AddEmpty((void*)read_iterator->GetKey()) : write_iterator->AddEmpty();
+				CopyValue(value_object, read_iterator->GetValue(), value_type, factory->m_ValueIsPointer, 0, 0);
+			}
+
+			RFLB_DELETE_TEMP_ITERATOR(factory, write_iterator);
+		}
+
+		RFLB_DELETE_TEMP_ITERATOR(factory, read_iterator);
+	}
+
+
+	void CopyValue(void* dst, const void* src, const Type* object_type, bool is_pointer, IContainerFactory* factory, CustomCopyFunc copy)
+	{
+		if (is_pointer)
+		{
+			*(void**)dst = *(void* const*)src;
+		}
+
+		else if (copy || (copy = object_type->GetCustomCopy()))
+		{
+			copy(dst, src);
+		}
+
+		else if (factory)
+		{
+			CopyCollection(dst, src, factory);
+		}
+
+		else if (object_type->GetFields().empty())
+		{
+			if (object_type->IsPOD())
+				memcpy(dst, src, object_type->GetSize());
+			else
+				object_type->AssignObject(dst, src);
+		}
+
+		else
+		{
+			CopyFields(dst, src, object_type->GetCopyPlan());
+		}
+	}
+}
+
+
+void rflb::internal::BuildCopyPlan(CopyPlan& plan, const Type& type, PlanUse use, u32 profile)
+{
+	std::vector<CopyStep> steps;
+	if (use == PLAN_USE_PRESENCE)
+		AddPresenceSteps(steps, type, 0, profile);
+	else
+		AddCopySteps(steps, type, 0, use);
+	std::stable_sort(steps.begin(), steps.end(), SortByOffset);
+
+	// Merge block copies that are directly next to each other
+	plan.m_Steps.clear();
+	for (size_t i = 0; i < steps.size(); i++)
+	{
+		const CopyStep& step = steps[i];
+		if (step.m_Field == 0 && !plan.m_Steps.empty())
+		{
+			CopyStep& last = plan.m_Steps.back();
+			if (last.m_Field == 0 && last.m_Offset + last.m_Size == step.m_Offset)
+			{
+				last.m_Size += step.m_Size;
+				continue;
+			}
+		}
+		plan.m_Steps.push_back(step);
+	}
+
+	plan.m_IsBlock =
+		plan.m_Steps.size() == 1 &&
+		plan.m_Steps[0].m_Field == 0 &&
+		plan.m_Steps[0].m_Offset == 0 &&
+		plan.m_Steps[0].m_Size == (u32)type.GetSize();
+}
+
+
+void rflb::CopyObject(void* dst, const void* src, const Type* object_type)
+{
+	if (dst != src)
+	{
+		CopyValue(dst, src, object_type, false, 0, 0);
+	}
+}
+
+
+void rflb::CopyObjects(void* dst, const void* src, const Type* object_type, int count)
+{
+	if (dst == src || count <= 0)
+		return;
+
+	int size = object_type->GetSize();
+	if (IsBlockCopy(object_type, false, 0, 0, internal::PLAN_USE_COPY) ||
+		(!object_type->GetCustomCopy() && !object_type->GetFields().empty() && object_type->GetCopyPlan().m_IsBlock))
+	{
+		memcpy(dst, src, size * count);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		CopyValue((char*)dst + i * size, (const char*)src + i * size, object_type, false, 0, 0);
+	}
+}
\ No newline at end of file
@@ -3,6 +3,35 @@
 #include <rflb/Type.h>
 #include <rflb/TypeDatabase.h>
 #include <rflb/Utils.h>
+#include <cmath>
+
+
+namespace
+{
+	u32 GetNbBitsFor(unsigned __int64 max_value)
+	{
+		u32 nb_bits = 1;
+		while (nb_bits < 64 && (max_value >> nb_bits) != 0)
+			nb_bits++;
+		return nb_bits;
+	}
+
+
+	// Packing applies to the values of containers
+	rflb::NumericKind GetPackedKind(const rflb::FieldInfo& field_info)
+	{
+		if (field_info.m_TypeInfo.m_IsPointer)
+			return rflb::NUMERIC_NONE;
+		const rflb::TypeInfo& type_info = field_info.m_ContainerFactory ? field_info.m_ValueTypeInfo : field_info.m_TypeInfo;
+		return type_info.m_IsPointer ? rflb::NUMERIC_NONE : type_info.m_NumericKind;
+	}
+
+
+	bool IsInteger(rflb::NumericKind kind)
+	{
+		return kind == rflb::NUMERIC_SIGNED || kind == rflb::NUMERIC_UNSIGNED;
+	}
+}
 
 
 rflb::FieldInfo& rflb::FieldInfo::Attributes(FieldAttr attributes)
@@ -19,6 +48,56 @@ rflb::FieldInfo& rflb::FieldInfo::Version(u32 version)
 }
 
 
+rflb::FieldInfo& rflb::FieldInfo::CustomCopy(CustomCopyFunc copy)
+{
+	m_CustomCopy = copy;
+	return *this;
+}
+
+
+rflb::FieldInfo& rflb::FieldInfo::Profiles(u32 profiles)
+{
+	m_Profiles = profiles;
+	return *this;
+}
+
+
+rflb::FieldInfo& rflb::FieldInfo::PackBits(u32 nb_bits)
+{
+	RFLB_ASSERT(nb_bits > 0 && nb_bits <= 64);
+	RFLB_ASSERT(IsInteger(GetPackedKind(*this)));
+	m_Packing = FieldPacking();
+	m_Packing.m_NbBits = nb_bits;
+	return *this;
+}
+
+
+rflb::FieldInfo& rflb::FieldInfo::PackRange(__int64 min, __int64 max)
+{
+	RFLB_ASSERT(min <= max);
+	RFLB_ASSERT(IsInteger(GetPackedKind(*this)));
+	m_Packing = FieldPacking();
+	m_Packing.m_NbBits = GetNbBitsFor((unsigned __int64)max - (unsigned __int64)min);
+	m_Packing.m_RangeMin = min;
+	m_Packing.m_RangeMax = max;
+	m_Packing.m_Step = 1;
+	return *this;
+}
+
+
+rflb::FieldInfo& rflb::FieldInfo::Quantise(double min, double max, double step)
+{
+	RFLB_ASSERT(min < max && step > 0);
+	RFLB_ASSERT(GetPackedKind(*this) == NUMERIC_FLOAT);
+	m_Packing = FieldPacking();
+	m_Packing.m_NbBits = GetNbBitsFor((unsigned __int64)ceil((max - min) / step));
+	m_Packing.m_Min = min;
+	m_Packing.m_Max = max;
+	m_Packing.m_Step = step;
+	return *this;
+}
+
+
 rflb::FieldInfo& rflb::FieldInfo::LoadSaveBinary(SerialiseLoadFunc load, SerialiseSaveFunc save)
 {
 	m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY] = load;
@@ -43,7 +122,9 @@ rflb::FieldInfo& rflb::FieldInfo::LoadSaveTextXML(SerialiseLoadFunc load, Serial
 }
 
 
-rflb::Field::Field()
+rflb::Field::Field() :
+	m_CustomCopy(0),
+	m_Profiles(PROFILE_ALL)
 {
 	// For storing in std::map
 }
@@ -57,20 +138,44 @@ rflb::Field::Field(const FieldInfo& field_info, TypeDatabase& type_db) :
 	m_ContainerFactory(field_info.m_ContainerFactory),
 	m_Attributes(field_info.m_Attributes),
 	m_Serialisers(field_info.m_Serialisers),
-	m_Version(field_info.m_Version)
+	m_Version(field_info.m_Version),
+	m_CustomCopy(field_info.m_CustomCopy),
+	m_Profiles(field_info.m_Profiles),
+	m_Packing(field_info.m_Packing)
 {
 	// Resolve the container types, if present
 	if (m_ContainerFactory)
 	{
-		if (field_info.m_KeyTypeInfo != TypeInfo())
-		{
-			m_ContainerFactory->m_KeyType = &type_db.GetType(field_info.m_KeyTypeInfo);
-			m_ContainerFactory->m_KeyIsPointer = field_info.m_KeyTypeInfo.m_IsPointer;
-		}
-		if (field_info.m_ValueTypeInfo != TypeInfo())
-		{
-			m_ContainerFactory->m_ValueType = &type_db.GetType(field_info.m_ValueTypeInfo);
-			m_ContainerFactory->m_ValueIsPointer = field_info.m_ValueTypeInfo.m_IsPointer;
-		}
+		internal::ResolveContainerTypes(m_ContainerFactory, field_info.m_KeyTypeInfo, field_info.m_ValueTypeInfo, type_db);
+	}
+}
+
+
+rflb::Field::Field(const StaticFieldInfo& field_info, TypeDatabase& type_db) :
+	m_Name(field_info.m_Name),
+	m_Offset(field_info.m_Offset),
+	m_Attributes(field_info.m_Attributes),
+	m_Version(field_info.m_Version),
+	m_CustomCopy(0),
+	m_Profiles(field_info.m_Profiles)
+{
+	const TypeInfo& type_info = field_info.m_Traits->m_GetTypeInfo();
+	m_Type = &type_db.GetType(type_info);
+	m_IsPointer = type_info.m_IsPointer;
+	m_ContainerFactory = type_db.GetContainerFactory(type_info, field_info.m_Traits->m_CreateContainerFactory);
+}
+
+
+void rflb::internal::ResolveContainerTypes(IContainerFactory* factory, const TypeInfo& key_type, const TypeInfo& value_type, TypeDatabase& type_db)
+{
+	if (key_type != TypeInfo())
+	{
+		factory->m_KeyType = &type_db.GetType(key_type);
+		factory->m_KeyIsPointer = key_type.m_IsPointer;
+	}
+	if (value_type != TypeInfo())
+	{
+		factory->m_ValueType = &type_db.GetType(value_type);
+		factory->m_ValueIsPointer = value_type.m_IsPointer;
 	}
 }
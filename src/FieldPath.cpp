@@ -0,0 +1,197 @@
+
+#include <rflb/FieldPath.h>
+#include <rflb/Field.h>
+#include <rflb/Container.h>
+#include <string>
+#include <cstdlib>
+
+using namespace rflb;
+
+
+namespace
+{
+	// Depth-first search of the type and its base types, adding the offset of the base type the field is in
+	const Field* FindFieldInHierarchy(const Type* type, const Name& name, u32& base_offset)
+	{
+		if (const Field* field = type->FindField(name))
+			return field;
+
+		for (int i = 0; i < type->GetNbBaseTypes(); i++)
+		{
+			u32 offset = base_offset + type->GetBaseOffset(i);
+			if (const Field* field = FindFieldInHierarchy(&type->GetBaseType(i), name, offset))
+			{
+				base_offset = offset;
+				return field;
+			}
+		}
+
+		return 0;
+	}
+
+
+	// Containers of pointers store the pointers, not the objects they point to
+	u32 GetValueSize(const IContainerFactory* factory)
+	{
+		return factory->m_ValueIsPointer ? sizeof(void*) : factory->m_ValueType->GetSize();
+	}
+}
+
+
+rflb::FieldPath::FieldPath()
+{
+	Reset();
+}
+
+
+void rflb::FieldPath::Reset()
+{
+	m_RootType = 0;
+	m_Hops.clear();
+	m_Offset = 0;
+	m_Type = 0;
+	m_IsPointer = false;
+}
+
+
+bool rflb::FieldPath::Resolve(const Type* root_type, const char* path)
+{
+	Reset();
+
+	const Type* type = root_type;
+	bool is_pointer = false;
+	u32 offset = 0;
+
+	const char* segment = path;
+	while (*segment)
+	{
+		// Can only name fields of objects, not pointers to them
+		if (is_pointer)
+		{
+			Hop hop = { offset, 0, 0 };
+			m_Hops.push_back(hop);
+			offset = 0;
+			is_pointer = false;
+		}
+
+		// Split off the field name
+		const char* end = segment;
+		while (*end && *end != '.' && *end != '[')
+			end++;
+		std::string name(segment, end);
+		if (name.empty())
+			return false;
+
+		const Field* field = FindFieldInHierarchy(type, Name(name.c_str()), offset);
+		if (field == 0)
+			return false;
+
+		offset += field->m_Offset;
+		type = field->m_Type;
+		is_pointer = field->m_IsPointer;
+
+		if (*end == '[')
+		{
+			IContainerFactory* factory = field->m_ContainerFactory;
+			if (factory == 0 || factory->m_KeyType != 0 || is_pointer)
+				return false;
+
+			char* index_end;
+			long index = strtol(end + 1, &index_end, 10);
+			if (index_end == end + 1 || *index_end != ']' || index < 0)
+				return false;
+			end = index_end + 1;
+
+			const Type* value_type = factory->m_ValueType;
+			if (factory->m_IsInline)
+			{
+				// Array elements are at a fixed offset within the parent
+				u32 value_size = GetValueSize(factory);
+				if ((index + 1) * value_size > type->GetSize())
+					return false;
+				offset += (u32)index * value_size;
+			}
+
+			else
+			{
+				Hop hop = { offset, factory, (int)index };
+				m_Hops.push_back(hop);
+				offset = 0;
+			}
+
+			type = value_type;
+			is_pointer = factory->m_ValueIsPointer;
+		}
+
+		else if (field->m_ContainerFactory && *end == '.')
+		{
+			// Containers need an index before any of their value's fields can be named
+			return false;
+		}
+
+		// Dots must be followed by another name
+		if (*end == '.' && end[1] != 0)
+			end++;
+		else if (*end != 0)
+			return false;
+		segment = end;
+	}
+
+	if (segment == path)
+		return false;
+
+	m_RootType = root_type;
+	m_Offset = offset;
+	m_Type = type;
+	m_IsPointer = is_pointer;
+	return true;
+}
+
+
+void* rflb::FieldPath::GetAddress(void* object) const
+{
+	return (void*)GetAddress((const void*)object);
+}
+
+
+const void* rflb::FieldPath::GetAddress(const void* object) const
+{
+	RFLB_ASSERT(IsValid());
+	const char* data = (const char*)object;
+
+	for (size_t i = 0; i < m_Hops.size(); i++)
+	{
+		const Hop& hop = m_Hops[i];
+		data += hop.m_Offset;
+
+		if (IContainerFactory* factory = hop.m_Factory)
+		{
+			IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, data);
+			data = 0;
+			if (hop.m_Index < iterator->GetCount())
+			{
+				if (factory->m_IsContiguous)
+				{
+					data = (const char*)iterator->GetValue() + hop.m_Index * GetValueSize(factory);
+				}
+				else
+				{
+					for (int j = 0; j < hop.m_Index; j++)
+						iterator->MoveNext();
+					data = (const char*)iterator->GetValue();
+				}
+			}
+			RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+		}
+
+		else
+		{
+			data = *(const char* const*)data;
+		}
+
+		if (data == 0)
+			return 0;
+	}
+
+	return data + m_Offset;
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+
+#include <rflb/JobRunner.h>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+
+//
+// Minimal thread, lock and condition variable wrappers
+//
+#ifdef _WIN32
+
+struct rflb::ThreadPool::Platform
+{
+	std::vector<HANDLE> m_Threads;
+	CRITICAL_SECTION m_Lock;
+	CONDITION_VARIABLE m_WorkReady;
+	CONDITION_VARIABLE m_WorkDone;
+};
+
+
+namespace
+{
+	DWORD WINAPI ThreadMain(LPVOID data);
+
+	void InitPlatform(rflb::ThreadPool::Platform& platform)
+	{
+		InitializeCriticalSection(&platform.m_Lock);
+		InitializeConditionVariable(&platform.m_WorkReady);
+		InitializeConditionVariable(&platform.m_WorkDone);
+	}
+
+	void StartThread(rflb::ThreadPool::Platform& platform, void* data)
+	{
+		if (HANDLE thread = CreateThread(0, 0, ThreadMain, data, 0, 0))
+			platform.m_Threads.push_back(thread);
+	}
+
+	void JoinThreads(rflb::ThreadPool::Platform& platform)
+	{
+		for (size_t i = 0; i < platform.m_Threads.size(); i++)
+		{
+			WaitForSingleObject(platform.m_Threads[i], INFINITE);
+			CloseHandle(platform.m_Threads[i]);
+		}
+		DeleteCriticalSection(&platform.m_Lock);
+	}
+
+	void Lock(rflb::ThreadPool::Platform& platform) { EnterCriticalSection(&platform.m_Lock); }
+	void Unlock(rflb::ThreadPool::Platform& platform) { LeaveCriticalSection(&platform.m_Lock); }
+	void Wait(rflb::ThreadPool::Platform& platform, CONDITION_VARIABLE& condition) { SleepConditionVariableCS(&condition, &platform.m_Lock, INFINITE); }
+	void WakeAll(CONDITION_VARIABLE& condition) { WakeAllConditionVariable(&condition); }
+
+	long AtomicIncrement(volatile long* value)
+	{
+		return InterlockedIncrement(value);
+	}
+}
+
+#else
+
+struct rflb::ThreadPool::Platform
+{
+	std::vector<pthread_t> m_Threads;
+	pthread_mutex_t m_Lock;
+	pthread_cond_t m_WorkReady;
+	pthread_cond_t m_WorkDone;
+};
+
+
+namespace
+{
+	void* ThreadMain(void* data);
+
+	void InitPlatform(rflb::ThreadPool::Platform& platform)
+	{
+		pthread_mutex_init(&platform.m_Lock, 0);
+		pthread_cond_init(&platform.m_WorkReady, 0);
+		pthread_cond_init(&platform.m_WorkDone, 0);
+	}
+
+	void StartThread(rflb::ThreadPool::Platform& platform, void* data)
+	{
+		pthread_t thread;
+		if (pthread_create(&thread, 0, ThreadMain, data) == 0)
+			platform.m_Threads.push_back(thread);
+	}
+
+	void JoinThreads(rflb::ThreadPool::Platform& platform)
+	{
+		for (size_t i = 0; i < platform.m_Threads.size(); i++)
+			pthread_join(platform.m_Threads[i], 0);
+		pthread_cond_destroy(&platform.m_WorkDone);
+		pthread_cond_destroy(&platform.m_WorkReady);
+		pthread_mutex_destroy(&platform.m_Lock);
+	}
+
+	void Lock(rflb::ThreadPool::Platform& platform) { pthread_mutex_lock(&platform.m_Lock); }
+	void Unlock(rflb::ThreadPool::Platform& platform) { pthread_mutex_unlock(&platform.m_Lock); }
+	void Wait(rflb::ThreadPool::Platform& platform, pthread_cond_t& condition) { pthread_cond_wait(&condition, &platform.m_Lock); }
+	void WakeAll(pthread_cond_t& condition) { pthread_cond_broadcast(&condition); }
+
+	long AtomicIncrement(volatile long* value)
+	{
+		return __sync_add_and_fetch(value, 1);
+	}
+}
+
+#endif
+
+
+namespace
+{
+	// Entry point for the worker threads, which forwards to the pool
+	#ifdef _WIN32
+	DWORD WINAPI ThreadMain(LPVOID data)
+	#else
+	void* ThreadMain(void* data)
+	#endif
+	{
+		rflb::ThreadPool::WorkerMain((rflb::ThreadPool*)data);
+		return 0;
+	}
+}
+
+
+void rflb::SerialJobRunner::Run(JobFunc func, void* data, int nb_jobs)
+{
+	for (int i = 0; i < nb_jobs; i++)
+		func(data, i);
+}
+
+
+rflb::ThreadPool::ThreadPool(int nb_threads)
+	: m_Platform(new Platform)
+	, m_NbThreads(0)
+	, m_Func(0)
+	, m_Data(0)
+	, m_NbJobs(0)
+	, m_NextJob(0)
+	, m_Generation(0)
+	, m_NbFinished(0)
+	, m_Quit(false)
+{
+	InitPlatform(*m_Platform);
+	for (int i = 0; i < nb_threads; i++)
+		StartThread(*m_Platform, this);
+
+	// Threads that failed to start are left out
+	m_NbThreads = (int)m_Platform->m_Threads.size();
+}
+
+
+rflb::ThreadPool::~ThreadPool()
+{
+	Lock(*m_Platform);
+	m_Quit = true;
+	WakeAll(m_Platform->m_WorkReady);
+	Unlock(*m_Platform);
+
+	JoinThreads(*m_Platform);
+	delete m_Platform;
+}
+
+
+void rflb::ThreadPool::Run(JobFunc func, void* data, int nb_jobs)
+{
+	if (nb_jobs <= 0)
+		return;
+
+	Lock(*m_Platform);
+	m_Func = func;
+	m_Data = data;
+	m_NbJobs = nb_jobs;
+	m_NextJob = 0;
+	m_NbFinished = 0;
+	m_Generation++;
+	WakeAll(m_Platform->m_WorkReady);
+	Unlock(*m_Platform);
+
+	RunJobs();
+
+	// Every worker has to finish with this set of jobs before it can be replaced
+	Lock(*m_Platform);
+	while (m_NbFinished < m_NbThreads)
+		Wait(*m_Platform, m_Platform->m_WorkDone);
+	Unlock(*m_Platform);
+}
+
+
+void rflb::ThreadPool::WorkerMain(ThreadPool* pool)
+{
+	Platform& platform = *pool->m_Platform;
+	u32 generation = 0;
+
+	Lock(platform);
+	while (true)
+	{
+		while (pool->m_Generation == generation && !pool->m_Quit)
+			Wait(platform, platform.m_WorkReady);
+		if (pool->m_Quit)
+			break;
+
+		generation = pool->m_Generation;
+		Unlock(platform);
+		pool->RunJobs();
+		Lock(platform);
+
+		if (++pool->m_NbFinished == pool->m_NbThreads)
+			WakeAll(platform.m_WorkDone);
+	}
+	Unlock(platform);
+}
+
+
+void rflb::ThreadPool::RunJobs()
+{
+	while (true)
+	{
+		int index = (int)AtomicIncrement(&m_NextJob) - 1;
+		if (index >= m_NbJobs)
+			break;
+		m_Func(m_Data, index);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+
+#include <rflb/Layout.h>
+#include <rflb/TypeDatabase.h>
+#include <rflb/Field.h>
+#include <rflb/Copy.h>
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+using namespace rflb;
+
+
+namespace
+{
+	// Space occupied by a field or base type, or a hole when printing
+	struct Region
+	{
+		u32 m_Offset;
+		u32 m_Size;
+		Name m_Name;
+		const char* m_Label;
+	};
+
+
+	u32 GetFieldSize(const Field& field)
+	{
+		return field.m_IsPointer ? sizeof(void*) : field.m_Type->GetSize();
+	}
+
+
+	u32 GetFieldAlignment(const Field& field)
+	{
+		u32 alignment = field.m_IsPointer ? sizeof(void*) : field.m_Type->GetAlignment();
+		return alignment ? alignment : 1;
+	}
+
+
+	u32 AlignUp(u32 offset, u32 alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+
+	bool IsHot(const Field& field, u32 hot_profiles)
+	{
+		return (field.m_Profiles & hot_profiles) != 0;
+	}
+
+
+	bool SortFieldsByOffset(const Field* a, const Field* b)
+	{
+		return a->m_Offset < b->m_Offset;
+	}
+
+
+	bool SortRegionsByOffset(const Region& a, const Region& b)
+	{
+		return a.m_Offset < b.m_Offset;
+	}
+
+
+	bool SortByPadding(const LayoutReport& a, const LayoutReport& b)
+	{
+		return a.m_PaddingSize > b.m_PaddingSize;
+	}
+
+
+	// Hot fields first, then larger alignments, otherwise keeping the current order
+	struct SuggestedOrder
+	{
+		SuggestedOrder(u32 hot_profiles) : m_HotProfiles(hot_profiles) { }
+
+		bool operator () (const Field* a, const Field* b) const
+		{
+			bool a_hot = IsHot(*a, m_HotProfiles);
+			bool b_hot = IsHot(*b, m_HotProfiles);
+			if (a_hot != b_hot)
+				return a_hot;
+			return GetFieldAlignment(*a) > GetFieldAlignment(*b);
+		}
+
+		u32 m_HotProfiles;
+	};
+
+
+	u32 CountHotCacheLines(const FieldList& fields, const std::vector<u32>& offsets, u32 hot_profiles, u32 cache_line_size)
+	{
+		std::set<u32> lines;
+		for (size_t i = 0; i < fields.size(); i++)
+		{
+			if (!IsHot(*fields[i], hot_profiles))
+				continue;
+			u32 size = GetFieldSize(*fields[i]);
+			for (u32 line = offsets[i] / cache_line_size; size && line <= (offsets[i] + size - 1) / cache_line_size; line++)
+				lines.insert(line);
+		}
+		return (u32)lines.size();
+	}
+
+
+	void PrintName(std::ostream& stream, const Name& name)
+	{
+		if (name.m_Text)
+			stream << name.m_Text;
+		else
+			stream << "0x" << std::hex << name.m_CRC << std::dec;
+	}
+}
+
+
+LayoutReport rflb::AnalyseLayout(const Type* type, u32 hot_profiles, u32 cache_line_size)
+{
+	LayoutReport report;
+	report.m_Type = type;
+	report.m_PaddingSize = 0;
+	report.m_NbCacheLines = (type->GetSize() + cache_line_size - 1) / cache_line_size;
+	report.m_IsBlockWithoutPadding = false;
+
+	FieldList fields;
+	std::vector<Region> regions;
+	const Fields& type_fields = type->GetFields();
+	for (Fields::const_iterator i = type_fields.begin(); i != type_fields.end(); ++i)
+	{
+		const Field& field = i->second;
+		fields.push_back(&field);
+		Region region = { field.m_Offset, GetFieldSize(field), field.m_Name, 0 };
+		regions.push_back(region);
+	}
+	for (int i = 0; i < type->GetNbBaseTypes(); i++)
+	{
+		Region region = { type->GetBaseOffset(i), (u32)type->GetBaseType(i).GetSize(), type->GetBaseType(i).GetName(), 0 };
+		regions.push_back(region);
+	}
+	std::stable_sort(fields.begin(), fields.end(), SortFieldsByOffset);
+	std::stable_sort(regions.begin(), regions.end(), SortRegionsByOffset);
+
+	// Regions can overlap where a derived type reuses the tail padding of its base
+	u32 end = 0;
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		if (regions[i].m_Offset > end)
+		{
+			PaddingHole hole = { end, regions[i].m_Offset - end };
+			report.m_Holes.push_back(hole);
+		}
+		end = std::max(end, regions[i].m_Offset + regions[i].m_Size);
+	}
+	if ((u32)type->GetSize() > end)
+	{
+		PaddingHole hole = { end, type->GetSize() - end };
+		report.m_Holes.push_back(hole);
+	}
+	for (size_t i = 0; i < report.m_Holes.size(); i++)
+		report.m_PaddingSize += report.m_Holes[i].m_Size;
+
+	std::vector<u32> offsets;
+	for (size_t i = 0; i < fields.size(); i++)
+		offsets.push_back(fields[i]->m_Offset);
+	report.m_NbHotCacheLines = CountHotCacheLines(fields, offsets, hot_profiles, cache_line_size);
+
+	// Lay the fields out again in the suggested order, starting where the first one is now
+	FieldList order = fields;
+	std::stable_sort(order.begin(), order.end(), SuggestedOrder(hot_profiles));
+	std::vector<u32> order_offsets;
+	u32 offset = fields.empty() ? 0 : fields[0]->m_Offset;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		offset = AlignUp(offset, GetFieldAlignment(*order[i]));
+		order_offsets.push_back(offset);
+		offset += GetFieldSize(*order[i]);
+	}
+	for (int i = 0; i < type->GetNbBaseTypes(); i++)
+		offset = std::max(offset, type->GetBaseOffset(i) + type->GetBaseType(i).GetSize());
+	u32 suggested_size = AlignUp(offset, type->GetAlignment() ? type->GetAlignment() : 1);
+	u32 suggested_hot_lines = CountHotCacheLines(order, order_offsets, hot_profiles, cache_line_size);
+
+	if (!fields.empty() && (suggested_size < (u32)type->GetSize() || suggested_hot_lines < report.m_NbHotCacheLines))
+	{
+		report.m_SuggestedOrder = order;
+		report.m_SuggestedSize = suggested_size;
+		report.m_SuggestedNbCacheLines = (suggested_size + cache_line_size - 1) / cache_line_size;
+		report.m_SuggestedNbHotCacheLines = suggested_hot_lines;
+	}
+	else
+	{
+		report.m_SuggestedOrder = fields;
+		report.m_SuggestedSize = type->GetSize();
+		report.m_SuggestedNbCacheLines = report.m_NbCacheLines;
+		report.m_SuggestedNbHotCacheLines = report.m_NbHotCacheLines;
+	}
+
+	// Blocks of PODs are only split by the gaps between them
+	if (!fields.empty() && !type->GetCustomCopy())
+	{
+		const internal::CopyPlan& plan = type->GetCopyPlan();
+		bool all_pods = true;
+		for (size_t i = 0; i < plan.m_Steps.size(); i++)
+			all_pods &= plan.m_Steps[i].m_Field == 0;
+		report.m_IsBlockWithoutPadding = all_pods && !plan.m_IsBlock;
+	}
+
+	return report;
+}
+
+
+void rflb::AnalyseLayouts(const TypeDatabase& db, std::vector<LayoutReport>& reports, u32 hot_profiles, u32 cache_line_size)
+{
+	std::vector<const Type*> types;
+	db.GetTypes(types);
+	for (size_t i = 0; i < types.size(); i++)
+	{
+		if (!types[i]->GetFields().empty())
+			reports.push_back(AnalyseLayout(types[i], hot_profiles, cache_line_size));
+	}
+
+	std::stable_sort(reports.begin(), reports.end(), SortByPadding);
+}
+
+
+void rflb::PrintLayout(std::ostream& stream, const LayoutReport& report)
+{
+	const Type* type = report.m_Type;
+	PrintName(stream, type->GetName());
+	stream << ": " << type->GetSize() << " bytes, " << report.m_PaddingSize << " padding, " << report.m_NbCacheLines << " cache lines\n";
+
+	// Fields, base types and holes in offset order
+	std::vector<Region> regions;
+	const Fields& fields = type->GetFields();
+	for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+	{
+		Region region = { i->second.m_Offset, GetFieldSize(i->second), i->second.m_Name, 0 };
+		regions.push_back(region);
+	}
+	for (int i = 0; i < type->GetNbBaseTypes(); i++)
+	{
+		Region region = { type->GetBaseOffset(i), (u32)type->GetBaseType(i).GetSize(), type->GetBaseType(i).GetName(), "base " };
+		regions.push_back(region);
+	}
+	for (size_t i = 0; i < report.m_Holes.size(); i++)
+	{
+		Region region = { report.m_Holes[i].m_Offset, report.m_Holes[i].m_Size, Name(), "padding" };
+		regions.push_back(region);
+	}
+	std::stable_sort(regions.begin(), regions.end(), SortRegionsByOffset);
+
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		const Region& region = regions[i];
+		stream << "\t" << region.m_Offset << "\t" << region.m_Size << "\t";
+		if (region.m_Label)
+			stream << region.m_Label;
+		if (region.m_Name.m_CRC)
+			PrintName(stream, region.m_Name);
+		stream << "\n";
+	}
+
+	if (report.m_IsBlockWithoutPadding)
+		stream << "\tcopyable as one block without padding\n";
+
+	if (report.m_SuggestedSize < (u32)type->GetSize() || report.m_SuggestedNbHotCacheLines < report.m_NbHotCacheLines)
+	{
+		stream << "\tsuggested order, " << report.m_SuggestedSize << " bytes, " << report.m_SuggestedNbCacheLines << " cache lines:";
+		for (size_t i = 0; i < report.m_SuggestedOrder.size(); i++)
+		{
+			stream << (i ? ", " : " ");
+			PrintName(stream, report.m_SuggestedOrder[i]->m_Name);
+		}
+		stream << "\n";
+	}
+}
\ No newline at end of file
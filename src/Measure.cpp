@@ -0,0 +1,136 @@
+
+#include <rflb/Measure.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+
+using namespace rflb;
+
+
+namespace
+{
+	struct Measurer
+	{
+		MemoryFootprint& m_Footprint;
+		int m_MaxSamples;
+
+		// Memory is added to the footprint multiplied by this, which is the product of the
+		// sampling ratios of all containers being walked
+		double m_Scale;
+	};
+
+
+	size_t Scale(size_t size, double scale)
+	{
+		return (size_t)(size * scale + 0.5);
+	}
+
+
+	// Values that can't own anything aren't worth visiting
+	bool OwnsMemory(const Type* type, bool is_pointer)
+	{
+		return !is_pointer && (type->GetCustomMeasure() || !type->GetFields().empty());
+	}
+
+
+	void MeasureValue(Measurer& measurer, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory);
+
+
+	void MeasureFields(Measurer& measurer, const char* object, const Type* object_type)
+	{
+		const Fields& fields = object_type->GetFields();
+		for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			const Field& field = i->second;
+			MeasureValue(measurer, object + field.m_Offset, field.m_Type, field.m_IsPointer, field.m_ContainerFactory);
+		}
+
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			MeasureFields(measurer, object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i));
+		}
+	}
+
+
+	void MeasureContainer(Measurer& measurer, const void* container, IContainerFactory* factory)
+	{
+		IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, container);
+		int count = iterator->GetCount();
+
+		// Container memory is counted against the type of its values, keys included for maps
+		ContainerMemory memory = iterator->GetMemory();
+		MemoryFootprint& footprint = measurer.m_Footprint;
+		footprint.m_HeapSize += Scale(memory.m_Allocated, measurer.m_Scale);
+		footprint.m_UnusedSize += Scale(memory.m_Unused, measurer.m_Scale);
+		footprint.m_OverheadSize += Scale(memory.m_Overhead, measurer.m_Scale);
+		TypeFootprint& type_footprint = footprint.m_Types[factory->m_ValueType];
+		type_footprint.m_NbObjects += Scale(count, measurer.m_Scale);
+		type_footprint.m_HeapSize += Scale(memory.m_Allocated, measurer.m_Scale);
+
+		bool measure_keys = factory->m_KeyType && OwnsMemory(factory->m_KeyType, factory->m_KeyIsPointer);
+		bool measure_values = OwnsMemory(factory->m_ValueType, factory->m_ValueIsPointer);
+		if (count && (measure_keys || measure_values))
+		{
+			int nb_samples = count;
+			if (measurer.m_MaxSamples > 0 && count > measurer.m_MaxSamples)
+			{
+				nb_samples = measurer.m_MaxSamples;
+				footprint.m_IsEstimate = true;
+			}
+
+			// Samples are spread evenly over the whole container rather than taken from the front
+			double scale = measurer.m_Scale;
+			measurer.m_Scale = scale * count / nb_samples;
+			int position = 0;
+			for (int i = 0; i < nb_samples; i++)
+			{
+				int index = (int)((unsigned __int64)i * count / nb_samples);
+				for ( ; position < index; position++)
+					iterator->MoveNext();
+				if (measure_keys)
+					MeasureValue(measurer, iterator->GetKey(), factory->m_KeyType, false, 0);
+				if (measure_values)
+					MeasureValue(measurer, iterator->GetValue(), factory->m_ValueType, false, 0);
+			}
+			measurer.m_Scale = scale;
+		}
+
+		RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+	}
+
+
+	void MeasureValue(Measurer& measurer, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory)
+	{
+		if (is_pointer)
+		{
+			// Not owned
+		}
+
+		else if (CustomMeasureFunc measure = object_type->GetCustomMeasure())
+		{
+			size_t size = Scale(measure(object), measurer.m_Scale);
+			measurer.m_Footprint.m_HeapSize += size;
+			measurer.m_Footprint.m_Types[object_type].m_HeapSize += size;
+		}
+
+		else if (factory)
+		{
+			MeasureContainer(measurer, object, factory);
+		}
+
+		else
+		{
+			MeasureFields(measurer, (const char*)object, object_type);
+		}
+	}
+}
+
+
+MemoryFootprint rflb::MeasureObject(const void* object, const Type* object_type, int max_samples)
+{
+	MemoryFootprint footprint;
+	footprint.m_InlineSize = object_type->GetSize();
+
+	Measurer measurer = { footprint, max_samples, 1.0 };
+	MeasureValue(measurer, object, object_type, false, 0);
+	return footprint;
+}
\ No newline at end of file
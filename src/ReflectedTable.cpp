@@ -0,0 +1,367 @@
+
+#include <rflb/ReflectedTable.h>
+#include <rflb/SerialiseBinary.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <iostream>
+#include <cstring>
+
+using namespace rflb;
+
+
+namespace
+{
+	// POD columns without custom serialisers are written as a single block
+	bool IsBlockColumn(const Field& field, bool is_pod, SerialiseMethod method)
+	{
+		return is_pod &&
+			!field.m_Serialisers.m_SaveFuncs[method] &&
+			!field.m_Serialisers.m_LoadFuncs[method] &&
+			!field.m_Type->GetSerialisers().m_SaveFuncs[method] &&
+			!field.m_Type->GetSerialisers().m_LoadFuncs[method];
+	}
+}
+
+
+rflb::ReflectedTable::ReflectedTable(const Type* type)
+	: m_Type(type)
+	, m_NbRows(0)
+	, m_Capacity(0)
+{
+	AddColumns(type, 0);
+}
+
+
+rflb::ReflectedTable::~ReflectedTable()
+{
+	Clear();
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		operator delete(m_Columns[i].m_Data);
+	}
+}
+
+
+void rflb::ReflectedTable::AddColumns(const Type* type, u32 offset)
+{
+	const Fields& fields = type->GetFields();
+	for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+	{
+		const Field& field = i->second;
+		const Type* field_type = field.m_Type;
+
+		// Flatten embedded objects that can be stored field by field
+		if (!field.m_IsPointer &&
+			!field.m_ContainerFactory &&
+			!field.m_Serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY] &&
+			!field_type->GetSerialisers().m_SaveFuncs[SERIALISE_METHOD_BINARY] &&
+			!field_type->GetFields().empty())
+		{
+			AddColumns(field_type, offset + field.m_Offset);
+			continue;
+		}
+
+		Column column;
+		column.m_Field = &field;
+		column.m_Offset = offset + field.m_Offset;
+		column.m_Size = field.m_IsPointer ? sizeof(void*) : field_type->GetSize();
+		column.m_IsPOD = field.m_IsPointer || (field_type->IsPOD() && field_type->GetFields().empty());
+		column.m_Data = 0;
+		m_Columns.push_back(column);
+	}
+
+	for (int i = 0; i < type->GetNbBaseTypes(); i++)
+	{
+		AddColumns(&type->GetBaseType(i), offset + type->GetBaseOffset(i));
+	}
+}
+
+
+int rflb::ReflectedTable::AddRow()
+{
+	// Copy the row from a default constructed object so that it gets the type's default values
+	void* object = _alloca(m_Type->GetSize());
+	m_Type->ConstructObject(object);
+	int row = AddRow(object);
+	m_Type->DestructObject(object);
+	return row;
+}
+
+
+int rflb::ReflectedTable::AddRow(const void* object)
+{
+	if (m_NbRows == m_Capacity)
+	{
+		Reserve(m_Capacity ? m_Capacity * 2 : 16);
+	}
+
+	int row = m_NbRows++;
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		if (!column.m_IsPOD)
+		{
+			column.m_Field->m_Type->ConstructObject(column.m_Data + row * column.m_Size);
+		}
+		SetValue(column, row, (const char*)object + column.m_Offset);
+	}
+
+	return row;
+}
+
+
+void rflb::ReflectedTable::RemoveRow(int row)
+{
+	RFLB_ASSERT(row >= 0 && row < m_NbRows);
+	int last = m_NbRows - 1;
+
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		char* last_value = column.m_Data + last * column.m_Size;
+		if (row != last)
+		{
+			SetValue(column, row, last_value);
+		}
+		if (!column.m_IsPOD)
+		{
+			column.m_Field->m_Type->DestructObject(last_value);
+		}
+	}
+
+	m_NbRows--;
+}
+
+
+void rflb::ReflectedTable::Clear()
+{
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		if (!column.m_IsPOD)
+		{
+			column.m_Field->m_Type->DestructArray(column.m_Data, m_NbRows);
+		}
+	}
+
+	m_NbRows = 0;
+}
+
+
+void rflb::ReflectedTable::Reserve(int nb_rows)
+{
+	if (nb_rows <= m_Capacity)
+		return;
+
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		Column& column = m_Columns[i];
+		char* data = (char*)operator new(nb_rows * column.m_Size);
+
+		if (column.m_IsPOD)
+		{
+			if (m_NbRows)
+				memcpy(data, column.m_Data, m_NbRows * column.m_Size);
+		}
+
+		else
+		{
+			// Non-POD values can't be moved in memory so are swapped into empty values at their new
+			// location, which takes what they own without copying it
+			const Type* field_type = column.m_Field->m_Type;
+			for (int j = 0; j < m_NbRows; j++)
+			{
+				void* value = data + j * column.m_Size;
+				void* old_value = column.m_Data + j * column.m_Size;
+				field_type->ConstructObject(value);
+				field_type->SwapObjects(value, old_value);
+				field_type->DestructObject(old_value);
+			}
+		}
+
+		operator delete(column.m_Data);
+		column.m_Data = data;
+	}
+
+	m_Capacity = nb_rows;
+}
+
+
+void rflb::ReflectedTable::GetRow(int row, void* object) const
+{
+	RFLB_ASSERT(row >= 0 && row < m_NbRows);
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		void* dst = (char*)object + column.m_Offset;
+		const void* src = column.m_Data + row * column.m_Size;
+
+		if (column.m_IsPOD)
+			memcpy(dst, src, column.m_Size);
+		else
+			column.m_Field->m_Type->AssignObject(dst, src);
+	}
+}
+
+
+void rflb::ReflectedTable::SetRow(int row, const void* object)
+{
+	RFLB_ASSERT(row >= 0 && row < m_NbRows);
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		SetValue(column, row, (const char*)object + column.m_Offset);
+	}
+}
+
+
+void rflb::ReflectedTable::SetValue(const Column& column, int row, const void* src)
+{
+	void* dst = column.m_Data + row * column.m_Size;
+	if (column.m_IsPOD)
+		memcpy(dst, src, column.m_Size);
+	else
+		column.m_Field->m_Type->AssignObject(dst, src);
+}
+
+
+int rflb::ReflectedTable::FindColumn(const char* path) const
+{
+	FieldPath field_path;
+	if (!field_path.Resolve(m_Type, path) || !field_path.HasFixedOffset())
+		return -1;
+
+	// Embedded objects share their offset with their first field so the type is also needed
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		if (column.m_Offset == field_path.GetOffset() && column.m_Field->m_Type == field_path.GetType())
+			return (int)i;
+	}
+
+	return -1;
+}
+
+
+bool rflb::ReflectedTable::IsColumnType(int column, const TypeInfo& type_info) const
+{
+	const Field& field = *m_Columns[column].m_Field;
+	return field.m_Type->GetName() == type_info.m_Name && field.m_IsPointer == type_info.m_IsPointer;
+}
+
+
+void rflb::ReflectedTable::Save(std::ostream& stream) const
+{
+	// Header describing the layout, for checking on load
+	StreamWrite(stream, m_Type->GetName().m_CRC);
+	StreamWrite(stream, m_NbRows);
+	StreamWrite(stream, (int)m_Columns.size());
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		StreamWrite(stream, m_Columns[i].m_Offset);
+		StreamWrite(stream, m_Columns[i].m_Size);
+	}
+
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		const Field& field = *column.m_Field;
+
+		// Pointers and transient fields aren't written, the same as the binary serialiser
+		if (field.m_IsPointer || field.m_Attributes.transient)
+			continue;
+
+		if (IsBlockColumn(field, column.m_IsPOD, SERIALISE_METHOD_BINARY))
+		{
+			// TODO: endian-ness
+			stream.write(column.m_Data, m_NbRows * column.m_Size);
+		}
+
+		else
+		{
+			// The field serialiser expects a pointer to the object containing the field
+			for (int j = 0; j < m_NbRows; j++)
+				serialise::SaveBinaryField(stream, column.m_Data + j * column.m_Size - field.m_Offset, field);
+		}
+	}
+}
+
+
+u32 rflb::ReflectedTable::GetMinRowSize() const
+{
+	u32 size = 0;
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		const Field& field = *column.m_Field;
+		if (field.m_IsPointer || field.m_Attributes.transient || field.m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY])
+			continue;
+		if (IsBlockColumn(field, column.m_IsPOD, SERIALISE_METHOD_BINARY))
+			size += column.m_Size;
+		else
+			size += field.m_ContainerFactory ? sizeof(int) : field.m_Type->GetMinBinarySize(PROFILE_ALL);
+	}
+	return size;
+}
+
+
+bool rflb::ReflectedTable::Load(std::istream& stream)
+{
+	u32 type_crc;
+	int nb_rows, nb_columns;
+	StreamRead(stream, type_crc);
+	StreamRead(stream, nb_rows);
+	StreamRead(stream, nb_columns);
+	if (!stream || type_crc != m_Type->GetName().m_CRC || nb_columns != (int)m_Columns.size() || nb_rows < 0)
+		return false;
+
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		u32 offset, size;
+		StreamRead(stream, offset);
+		StreamRead(stream, size);
+		if (offset != m_Columns[i].m_Offset || size != m_Columns[i].m_Size)
+			return false;
+	}
+
+	// The row count comes from the stream so check the rows can fit in what's left of it before
+	// allocating them. Rows that could be written in nothing are still limited to one per byte.
+	std::streamoff position = stream.tellg();
+	if (position != -1)
+	{
+		stream.seekg(0, std::ios_base::end);
+		std::streamoff remaining = stream.tellg() - position;
+		stream.seekg(position);
+		u32 row_size = GetMinRowSize();
+		if ((std::streamoff)nb_rows * (row_size ? row_size : 1) > remaining)
+			return false;
+	}
+
+	Clear();
+	Reserve(nb_rows);
+	for (int i = 0; i < nb_rows; i++)
+	{
+		AddRow();
+	}
+
+	for (size_t i = 0; i < m_Columns.size(); i++)
+	{
+		const Column& column = m_Columns[i];
+		const Field& field = *column.m_Field;
+		if (field.m_IsPointer || field.m_Attributes.transient)
+			continue;
+
+		if (IsBlockColumn(field, column.m_IsPOD, SERIALISE_METHOD_BINARY))
+		{
+			stream.read(column.m_Data, m_NbRows * column.m_Size);
+		}
+
+		else
+		{
+			for (int j = 0; j < m_NbRows; j++)
+				serialise::LoadBinaryField(stream, column.m_Data + j * column.m_Size - field.m_Offset, field);
+		}
+	}
+
+	return !stream.fail();
+}
\ No newline at end of file
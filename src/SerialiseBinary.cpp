@@ -2,7 +2,17 @@
 #include <rflb/SerialiseBinary.h>
 #include <rflb/Type.h>
 #include <rflb/Field.h>
+#include <rflb/Copy.h>
+#include <rflb/Compare.h>
+#include <rflb/JobRunner.h>
+#include <rflb/MemoryStream.h>
+#include <rflb/SerialiseContext.h>
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cstring>
 
 using namespace rflb;
 
@@ -63,20 +73,480 @@ namespace
 	};
 
 
-	void LoadObject(std::istream& stream, void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method);
-	void SaveObject(std::ostream& stream, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method);
-	void LoadBinary(std::istream& stream, void* object, const Type* object_type, SerialiseMethod method);
-	void SaveBinary(std::ostream& stream, const void* object, const Type* object_type, SerialiseMethod method);
+	// Set in the IFFV field count when the object is preceded by a field index
+	const u32 FIELD_INDEX_BIT = 0x80000000;
 
 
-	void LoadCollection(std::istream& stream, void* object, IContainerFactory* factory, SerialiseMethod method)
+	// Entry in the field index, sorted by name CRC to match the order of the type's fields
+	struct FieldIndexEntry
 	{
-		// Create an iterator and read the count
-		IWriteIterator* iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, object);
+		u32 m_NameCRC;
+		u32 m_HeaderOffset;
+
+		bool operator < (const FieldIndexEntry& rhs) const
+		{
+			return m_NameCRC < rhs.m_NameCRC;
+		}
+	};
+
+
+	//
+	// Each indexed IFFV object is laid out as:
+	//
+	//    int nb_fields | FIELD_INDEX_BIT
+	//    u32 object_size
+	//    FieldIndexEntry entries[nb_fields]
+	//    FieldHeader/data pairs...
+	//
+	// All offsets are relative to the start of the object so that it can be
+	// relocated within a larger stream. The object size allows readers to hop
+	// directly to the base type objects that follow.
+	//
+	class FieldIndexWriter
+	{
+	public:
+		FieldIndexWriter(std::ostream& stream)
+			: m_Stream(stream)
+			, m_StartPosition(0)
+			, m_NbAdded(0)
+			, m_Active(false)
+		{
+		}
+
+		void Begin(int nb_fields)
+		{
+			m_Active = true;
+			m_StartPosition = (u32)m_Stream.tellp();
+			StreamWrite(m_Stream, nb_fields | FIELD_INDEX_BIT);
+
+			// Reserve space for the size and the index, to be patched later
+			u32 object_size = 0;
+			StreamWrite(m_Stream, object_size);
+			m_Entries.resize(nb_fields);
+			if (nb_fields)
+			{
+				m_Stream.write((char*)&m_Entries[0], nb_fields * sizeof(FieldIndexEntry));
+			}
+		}
+
+		void AddField(u32 name_crc)
+		{
+			FieldIndexEntry& entry = m_Entries[m_NbAdded++];
+			entry.m_NameCRC = name_crc;
+			entry.m_HeaderOffset = (u32)m_Stream.tellp() - m_StartPosition;
+		}
+
+		void Patch()
+		{
+			u32 cur_pos = (u32)m_Stream.tellp();
+			u32 object_size = cur_pos - m_StartPosition;
+
+			m_Stream.seekp(m_StartPosition + sizeof(u32), std::ostream::beg);
+			StreamWrite(m_Stream, object_size);
+			if (!m_Entries.empty())
+			{
+				m_Stream.write((char*)&m_Entries[0], m_Entries.size() * sizeof(FieldIndexEntry));
+			}
+			m_Stream.seekp(cur_pos, std::ostream::beg);
+		}
+
+		bool IsActive() const { return m_Active; }
+
+	private:
+		std::ostream& m_Stream;
+		u32 m_StartPosition;
+		std::vector<FieldIndexEntry> m_Entries;
+		int m_NbAdded;
+		bool m_Active;
+	};
+
+
+	// Reads the field count of an IFFV object, skipping any field index
+	int ReadNbFields(std::istream& stream)
+	{
+		int nb_fields;
+		StreamRead(stream, nb_fields);
+
+		if (nb_fields & FIELD_INDEX_BIT)
+		{
+			nb_fields &= ~FIELD_INDEX_BIT;
+			stream.seekg(sizeof(u32) + nb_fields * sizeof(FieldIndexEntry), std::ios_base::cur);
+		}
+
+		return nb_fields;
+	}
+
+
+	void LoadObject(std::istream& stream, void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile);
+	void SaveObject(std::ostream& stream, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile);
+	void LoadBinary(std::istream& stream, void* object, const Type* object_type, SerialiseMethod method, u32 flags, u32 profile);
+	void SaveBinary(std::ostream& stream, const void* object, const Type* object_type, SerialiseMethod method, u32 flags, u32 profile);
+
+
+	//
+	// Columnar collections store each field of their values for all values before moving
+	// on to the next field. Embedded objects and base types are flattened so that each
+	// POD field gets its own column, which is written in one go. Fields that need custom
+	// serialisers or are containers themselves are written value by value within their
+	// column.
+	//
+	struct Column
+	{
+		// Offset of the object containing the field within each value
+		u32 m_ParentOffset;
+		const Field* m_Field;
+		bool m_IsPOD;
+	};
+
+
+	bool HasSerialiser(const Serialisers& serialisers, SerialiseMethod method)
+	{
+		return serialisers.m_SaveFuncs[method] != 0 || serialisers.m_LoadFuncs[method] != 0;
+	}
+
+
+	// Generated serialisers don't handle flags or profiles so the fields are walked for anything else
+	SerialiseLoadFunc GetGeneratedLoad(const Type* object_type, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		return method == SERIALISE_METHOD_BINARY && flags == 0 && profile == PROFILE_ALL ? object_type->GetGeneratedLoad() : 0;
+	}
+
+
+	SerialiseSaveFunc GetGeneratedSave(const Type* object_type, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		return method == SERIALISE_METHOD_BINARY && flags == 0 && profile == PROFILE_ALL ? object_type->GetGeneratedSave() : 0;
+	}
+
+
+	bool IsColumnar(IContainerFactory* factory, SerialiseMethod method, u32 flags)
+	{
+		// IFFV requires a header for each object, which would be lost by flattening
+		if ((flags & serialise::FLAG_COLUMNAR) == 0 || method != SERIALISE_METHOD_BINARY)
+			return false;
+
+		const Type* value_type = factory->m_ValueType;
+		return factory->m_KeyType == 0 &&
+			factory->m_IsContiguous &&
+			!factory->m_ValueIsPointer &&
+			!HasSerialiser(value_type->GetSerialisers(), method) &&
+			!value_type->GetFields().empty();
+	}
+
+
+	// Batches of objects are written a field at a time unless each object needs its own header or bitmap
+	bool IsBatchColumnar(const Type* object_type, u32 flags)
+	{
+		return (flags & serialise::FLAG_SKIP_DEFAULTS) == 0 &&
+			!HasSerialiser(object_type->GetSerialisers(), SERIALISE_METHOD_BINARY) &&
+			!object_type->GetFields().empty();
+	}
+
+
+	void AddColumns(std::vector<Column>& columns, const Type* object_type, u32 parent_offset, SerialiseMethod method, u32 profile)
+	{
+		// Includes the fields of base types
+		const FieldList& fields = object_type->GetFlattenedFields(profile);
+		for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			const Field& field = **i;
+			const Type* field_type = field.m_Type;
+			Column column = { parent_offset, &field, false };
+
+			// Pointers aren't written
+			if (field.m_IsPointer && !HasSerialiser(field.m_Serialisers, method))
+				continue;
+
+			if (HasSerialiser(field.m_Serialisers, method) || HasSerialiser(field_type->GetSerialisers(), method) || field.m_ContainerFactory)
+			{
+				columns.push_back(column);
+			}
+
+			else if (field_type->GetFields().empty())
+			{
+				column.m_IsPOD = true;
+				columns.push_back(column);
+			}
+
+			else
+			{
+				AddColumns(columns, field_type, parent_offset + field.m_Offset, method, profile);
+			}
+		}
+	}
+
+
+	// Strided gather/scatter of fixed size values, allowing the copies to be inlined
+	template <u32 SIZE> void GatherColumn(char* column, const char* values, u32 stride, int count)
+	{
+		for (int i = 0; i < count; i++)
+			memcpy(column + i * SIZE, values + i * stride, SIZE);
+	}
+
+	template <u32 SIZE> void ScatterColumn(char* values, const char* column, u32 stride, int count)
+	{
+		for (int i = 0; i < count; i++)
+			memcpy(values + i * stride, column + i * SIZE, SIZE);
+	}
+
+
+	void GatherColumn(char* column, const char* values, u32 size, u32 stride, int count)
+	{
+		switch (size)
+		{
+			case 1: GatherColumn<1>(column, values, stride, count); break;
+			case 2: GatherColumn<2>(column, values, stride, count); break;
+			case 4: GatherColumn<4>(column, values, stride, count); break;
+			case 8: GatherColumn<8>(column, values, stride, count); break;
+			default:
+				for (int i = 0; i < count; i++)
+					memcpy(column + i * size, values + i * stride, size);
+		}
+	}
+
+
+	void ScatterColumn(char* values, const char* column, u32 size, u32 stride, int count)
+	{
+		switch (size)
+		{
+			case 1: ScatterColumn<1>(values, column, stride, count); break;
+			case 2: ScatterColumn<2>(values, column, stride, count); break;
+			case 4: ScatterColumn<4>(values, column, stride, count); break;
+			case 8: ScatterColumn<8>(values, column, stride, count); break;
+			default:
+				for (int i = 0; i < count; i++)
+					memcpy(values + i * stride, column + i * size, size);
+		}
+	}
+
+
+	void SaveField(std::ostream& stream, const void* object, const Field& field, SerialiseMethod method, u32 flags, u32 profile);
+	void LoadField(std::istream& stream, void* object, const Field& field, SerialiseMethod method, u32 flags, u32 profile);
+
+
+	void SaveColumns(std::ostream& stream, const char* values, int count, u32 stride, const Type* value_type, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		std::vector<Column> columns;
+		AddColumns(columns, value_type, 0, method, profile);
+
+		std::vector<char> buffer;
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			const Column& column = columns[i];
+			const Field& field = *column.m_Field;
+
+			if (column.m_IsPOD)
+			{
+				// TODO: endian-ness
+				u32 size = field.m_Type->GetSize();
+				buffer.resize(size * count);
+				GatherColumn(&buffer[0], values + column.m_ParentOffset + field.m_Offset, size, stride, count);
+				stream.write(&buffer[0], buffer.size());
+			}
+
+			else
+			{
+				for (int j = 0; j < count; j++)
+					SaveField(stream, values + j * stride + column.m_ParentOffset, field, method, flags, profile);
+			}
+		}
+	}
+
+
+	void LoadColumns(std::istream& stream, char* values, int count, u32 stride, const Type* value_type, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		std::vector<Column> columns;
+		AddColumns(columns, value_type, 0, method, profile);
+
+		std::vector<char> buffer;
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			const Column& column = columns[i];
+			const Field& field = *column.m_Field;
+
+			if (column.m_IsPOD)
+			{
+				u32 size = field.m_Type->GetSize();
+				buffer.resize(size * count);
+				stream.read(&buffer[0], buffer.size());
+				ScatterColumn(values + column.m_ParentOffset + field.m_Offset, &buffer[0], size, stride, count);
+			}
+
+			else
+			{
+				for (int j = 0; j < count; j++)
+					LoadField(stream, values + j * stride + column.m_ParentOffset, field, method, flags, profile);
+			}
+		}
+	}
+
+
+	//
+	// Objects saved with FLAG_SKIP_DEFAULTS are laid out as:
+	//
+	//    u8 presence[(nb_steps + 7) / 8]
+	//    data of each present step...
+	//
+	// where the steps come from the type's presence plan. Embedded objects and base types are
+	// flattened into the plan, so only objects within containers or behind custom serialisers
+	// get bitmaps of their own.
+	//
+	void SaveNonDefault(std::ostream& stream, const void* object, const Type* object_type, u32 flags, u32 profile)
+	{
+		const internal::CopyPlan& plan = object_type->GetPresencePlan(profile);
+		const char* default_object = (const char*)object_type->GetDefaultObject();
+		int nb_steps = (int)plan.m_Steps.size();
+		int presence_size = (nb_steps + 7) / 8;
+		unsigned char* presence = (unsigned char*)_alloca(presence_size);
+		memset(presence, 0, presence_size);
+
+		for (int i = 0; i < nb_steps; i++)
+		{
+			const internal::CopyStep& step = plan.m_Steps[i];
+			const char* value = (const char*)object + step.m_Offset;
+			const char* default_value = default_object + step.m_Offset;
+
+			// Fields that can't be compared are always written
+			bool is_default = step.m_Field ?
+				step.m_IsComparable && EqualFieldData(value, default_value, *step.m_Field) :
+				memcmp(value, default_value, step.m_Size) == 0;
+			if (!is_default)
+				presence[i >> 3] |= 1 << (i & 7);
+		}
+		stream.write((char*)presence, presence_size);
+
+		for (int i = 0; i < nb_steps; i++)
+		{
+			if ((presence[i >> 3] & (1 << (i & 7))) == 0)
+				continue;
+
+			const internal::CopyStep& step = plan.m_Steps[i];
+			if (const Field* field = step.m_Field)
+			{
+				// The field serialiser expects a pointer to the object containing the field
+				SaveField(stream, (const char*)object + step.m_Offset - field->m_Offset, *field, SERIALISE_METHOD_BINARY, flags, profile);
+			}
+			else
+			{
+				// TODO: endian-ness
+				stream.write((const char*)object + step.m_Offset, step.m_Size);
+			}
+		}
+	}
+
+
+	void LoadNonDefault(std::istream& stream, void* object, const Type* object_type, u32 flags, u32 profile)
+	{
+		const internal::CopyPlan& plan = object_type->GetPresencePlan(profile);
+		const char* default_object = (const char*)object_type->GetDefaultObject();
+		int nb_steps = (int)plan.m_Steps.size();
+		int presence_size = (nb_steps + 7) / 8;
+		unsigned char* presence = (unsigned char*)_alloca(presence_size);
+		stream.read((char*)presence, presence_size);
+
+		for (int i = 0; i < nb_steps; i++)
+		{
+			const internal::CopyStep& step = plan.m_Steps[i];
+			char* value = (char*)object + step.m_Offset;
+			bool is_present = (presence[i >> 3] & (1 << (i & 7))) != 0;
+
+			if (const Field* field = step.m_Field)
+			{
+				// Pointers are reset themselves, rather than assigning an object of the pointee type
+				if (is_present)
+					LoadField(stream, value - field->m_Offset, *field, SERIALISE_METHOD_BINARY, flags, profile);
+				else if (field->m_IsPointer)
+					memcpy(value, default_object + step.m_Offset, sizeof(void*));
+				else
+					field->m_Type->AssignObject(value, default_object + step.m_Offset);
+			}
+			else
+			{
+				if (is_present)
+					stream.read(value, step.m_Size);
+				else
+					memcpy(value, default_object + step.m_Offset, step.m_Size);
+			}
+		}
+	}
+
+
+	// Where a bounded load must end, attached to the stream by LoadBinaryBounded
+	struct Bound
+	{
+		std::streamoff m_End;
+		bool m_Rejected;
+	};
+
+	const int g_BoundIndex = std::ios_base::xalloc();
+
+
+	// Fewest bytes a value can be written in, for checking container counts against the bytes
+	// that are left. Custom serialisers and pointers could write nothing.
+	u32 GetMinSize(const Type* type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		if (is_pointer || type->GetSerialisers().m_LoadFuncs[method])
+			return 0;
+
+		if (factory)
+			return sizeof(int);
+
+		if (type->GetFields().empty())
+			return type->GetSize();
+
+		// Objects can have fields left out
+		if (method != SERIALISE_METHOD_BINARY || (flags & serialise::FLAG_SKIP_DEFAULTS))
+			return 0;
+
+		return type->GetMinBinarySize(profile);
+	}
+
+
+	bool CheckCount(std::istream& stream, int count, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		u32 value_size = GetMinSize(factory->m_ValueType, factory->m_ValueIsPointer, 0, method, flags, profile);
+		if (Type* key_type = factory->m_KeyType)
+			value_size += GetMinSize(key_type, factory->m_KeyIsPointer, 0, method, flags, profile);
+		return serialise::CheckBound(stream, count, value_size);
+	}
+
+
+	void LoadCollection(std::istream& stream, void* object, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		// Read the count, validating it if the load is bounded, and create an iterator
 		int count;
 		StreamRead(stream, count);
+		if (stream.pword(g_BoundIndex) && !CheckCount(stream, count, factory, method, flags, profile))
+			return;
 
-		if (Type* key_type = factory->m_KeyType)
+		// Negative counts in unbounded loads of corrupt data load nothing, and mustn't reach the allocator
+		if (count < 0)
+			count = 0;
+
+		IWriteIterator* iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, object);
+		bool reload = (flags & serialise::FLAG_RELOAD) != 0;
+		if (reload)
+			iterator->BeginOverwrite(count);
+		else if (count > 0)
+			iterator->Reserve(count);
+
+		if (IsColumnar(factory, method, flags))
+		{
+			// Construct all values up front, which are contiguous once reserved
+			char* values = 0;
+			for (int i = 0; i < count; i++)
+			{
+				void* value_object = reload ? iterator->Overwrite() : iterator->AddEmpty();
+				if (i == 0)
+					values = (char*)value_object;
+			}
+
+			if (count)
+			{
+				LoadColumns(stream, values, count, factory->m_ValueType->GetSize(), factory->m_ValueType, method, flags, profile);
+			}
+		}
+
+		else if (Type* key_type = factory->m_KeyType)
 		{
 			// Construct a temporary for the key
 			void* key = _alloca(key_type->GetSize());
@@ -85,9 +555,9 @@ namespace
 			// Load the key/value pairs of the container
 			for (int i = 0; i < count; i++)
 			{
-				LoadObject(stream, key, key_type, false, 0, method);
-				void* value_object = iterator->AddEmpty(key);
-				LoadObject(stream, value_object, factory->m_ValueType, factory->m_ValueIsPointer, 0, method);
+				LoadObject(stream, key, key_type, false, 0, method, flags, profile);
+				void* value_object = reload ? iterator->Overwrite(key) : iterator->AddEmpty(key);
+				LoadObject(stream, value_object, factory->m_ValueType, factory->m_ValueIsPointer, 0, method, flags, profile);
 			}
 
 			key_type->DestructObject(key);
@@ -98,11 +568,13 @@ namespace
 			// Just load the values of the container
 			for (int i = 0; i < count; i++)
 			{
-				void* value_object = iterator->AddEmpty();
-				LoadObject(stream, value_object, factory->m_ValueType, factory->m_ValueIsPointer, 0, method);
+				void* value_object = reload ? iterator->Overwrite() : iterator->AddEmpty();
+				LoadObject(stream, value_object, factory->m_ValueType, factory->m_ValueIsPointer, 0, method, flags, profile);
 			}
 		}
 
+		if (reload)
+			iterator->EndOverwrite();
 		RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
 	}
 
@@ -110,7 +582,7 @@ namespace
 
 	// NOTE: All of these branches can be "baked" into the field load function
 
-	void LoadObject(std::istream& stream, void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method)
+	void LoadObject(std::istream& stream, void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile)
 	{
 		if (is_pointer)
 		{
@@ -124,7 +596,12 @@ namespace
 
 		else if (factory)
 		{
-			LoadCollection(stream, object, factory, method);
+			LoadCollection(stream, object, factory, method, flags, profile);
+		}
+
+		else if (SerialiseLoadFunc load = GetGeneratedLoad(object_type, method, flags, profile))
+		{
+			load(stream, 0, object);
 		}
 
 		else if (object_type->GetFields().empty())
@@ -137,12 +614,12 @@ namespace
 		else
 		{
 			// Recurse into the fields of this object
-			LoadBinary(stream, object, object_type, method);
+			LoadBinary(stream, object, object_type, method, flags, profile);
 		}
 	}
 
 
-	void LoadField(std::istream& stream, void* object, const Field& field, SerialiseMethod method)
+	void LoadField(std::istream& stream, void* object, const Field& field, SerialiseMethod method, u32 flags, u32 profile)
 	{
 		void* field_data = (char*)object + field.m_Offset;
 
@@ -153,17 +630,34 @@ namespace
 
 		else
 		{
-			LoadObject(stream, field_data, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, method);
+			LoadObject(stream, field_data, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, method, flags, profile);
 		}
 	}
 
 
-	void LoadBinary(std::istream& stream, void* object, const Type* object_type, SerialiseMethod method)
+	void LoadBinary(std::istream& stream, void* object, const Type* object_type, SerialiseMethod method, u32 flags, u32 profile)
 	{
+		if (method == SERIALISE_METHOD_BINARY && (flags & serialise::FLAG_SKIP_DEFAULTS))
+		{
+			// Base types are part of the presence plan
+			LoadNonDefault(stream, object, object_type, flags, profile);
+			return;
+		}
+
+		if (method == SERIALISE_METHOD_BINARY)
+		{
+			// One walk over the fields of the type and its base types
+			const FieldList& fields = object_type->GetFlattenedFields(profile);
+			for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+			{
+				LoadField(stream, object, **i, method, flags, profile);
+			}
+			return;
+		}
+
 		if (method == SERIALISE_METHOD_BINARY_IFFV)
 		{
-			int nb_fields;
-			StreamRead(stream, nb_fields);
+			int nb_fields = ReadNbFields(stream);
 
 			for (int i = 0; i < nb_fields; i++)
 			{
@@ -171,10 +665,10 @@ namespace
 				header.Read(stream);
 
 				const Field* field = object_type->FindField(Name(header.m_NameCRC));
-				if (field && field->m_Version == header.m_Version)
+				if (field && field->m_Version == header.m_Version && field->IsInProfile(profile))
 				{
 					u32 field_start = (u32)stream.tellg();
-					LoadField(stream, object, *field, method);
+					LoadField(stream, object, *field, method, flags, profile);
 
 					if ((u32)stream.tellg() - field_start != header.m_DataSize)
 					{
@@ -186,7 +680,7 @@ namespace
 
 				else
 				{
-					// Field not found or version mismatch
+					// Field not found, version mismatch or excluded by the profile
 					stream.seekg(header.m_DataSize, std::ios_base::cur);
 				}
 			}
@@ -194,34 +688,44 @@ namespace
 
 		else
 		{
-			const Fields& fields = object_type->GetFields();
-			for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+			// Visit only the fields of the profile, the same as when saving
+			const FieldList& fields = object_type->GetProfileFields(profile);
+			for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
 			{
-				LoadField(stream, object, i->second, method);
+				LoadField(stream, object, **i, method, flags, profile);
 			}
 		}
 
-		// Recurse into base types
+		// Recurse into base types, which have their own field headers
 		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
 		{
-			LoadBinary(stream, object, &object_type->GetBaseType(i), method);
+			LoadBinary(stream, (char*)object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i), method, flags, profile);
 		}
 	}
 
 
-	void SaveCollection(std::ostream& stream, const void* object, IContainerFactory* factory, SerialiseMethod method)
+	void SaveCollection(std::ostream& stream, const void* object, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile)
 	{
 		// Create an iterator and write the count
 		IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, object);
-		StreamWrite(stream, iterator->GetCount());
+		int count = iterator->GetCount();
+		StreamWrite(stream, count);
+
+		if (IsColumnar(factory, method, flags))
+		{
+			if (count)
+			{
+				SaveColumns(stream, (const char*)iterator->GetValue(), count, factory->m_ValueType->GetSize(), factory->m_ValueType, method, flags, profile);
+			}
+		}
 
-		if (factory->m_KeyType)
+		else if (factory->m_KeyType)
 		{
 			// Save the key/value pairs of the container
 			while (iterator->IsValid())
 			{
-				SaveObject(stream, iterator->GetKey(), factory->m_KeyType, factory->m_KeyIsPointer, 0, method);
-				SaveObject(stream, iterator->GetValue(), factory->m_ValueType, factory->m_ValueIsPointer, 0, method);
+				SaveObject(stream, iterator->GetKey(), factory->m_KeyType, factory->m_KeyIsPointer, 0, method, flags, profile);
+				SaveObject(stream, iterator->GetValue(), factory->m_ValueType, factory->m_ValueIsPointer, 0, method, flags, profile);
 				iterator->MoveNext();
 			}
 		}
@@ -230,7 +734,7 @@ namespace
 			// Save just the values of the container
 			while (iterator->IsValid())
 			{
-				SaveObject(stream, iterator->GetValue(), factory->m_ValueType, factory->m_ValueIsPointer, 0, method);
+				SaveObject(stream, iterator->GetValue(), factory->m_ValueType, factory->m_ValueIsPointer, 0, method, flags, profile);
 				iterator->MoveNext();
 			}
 		}
@@ -239,7 +743,7 @@ namespace
 	}
 
 
-	void SaveObject(std::ostream& stream, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method)
+	void SaveObject(std::ostream& stream, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseMethod method, u32 flags, u32 profile)
 	{
 		if (is_pointer)
 		{
@@ -256,7 +760,12 @@ namespace
 		// has no fields
 		else if (factory)
 		{
-			SaveCollection(stream, object, factory, method);
+			SaveCollection(stream, object, factory, method, flags, profile);
+		}
+
+		else if (SerialiseSaveFunc save = GetGeneratedSave(object_type, method, flags, profile))
+		{
+			save(stream, 0, object);
 		}
 
 		else if (object_type->GetFields().empty())
@@ -268,74 +777,675 @@ namespace
 
 		else
 		{
-			// Recurse into the fields of this object
-			SaveBinary(stream, object, object_type, method);
+			// Recurse into the fields of this object, which don't get their own field index
+			SaveBinary(stream, object, object_type, method, flags & ~serialise::FLAG_FIELD_INDEX, profile);
+		}
+	}
+
+
+	void SaveField(std::ostream& stream, const void* object, const Field& field, SerialiseMethod method, u32 flags, u32 profile)
+	{
+		const void* field_data = (const char*)object + field.m_Offset;
+
+		if (SerialiseSaveFunc save_func = field.m_Serialisers.m_SaveFuncs[method])
+		{
+			save_func(stream, 0, field_data);
+		}
+
+		else
+		{
+			SaveObject(stream, field_data, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, method, flags, profile);
 		}
 	}
 
 
-	void SaveBinary(std::ostream& stream, const void* object, const Type* object_type, SerialiseMethod method)
+	void SaveBinary(std::ostream& stream, const void* object, const Type* object_type, SerialiseMethod method, u32 flags, u32 profile)
 	{
-		const Fields& fields = object_type->GetFields();
+		if (method == SERIALISE_METHOD_BINARY && (flags & serialise::FLAG_SKIP_DEFAULTS))
+		{
+			SaveNonDefault(stream, object, object_type, flags, profile);
+			return;
+		}
+
+		if (method == SERIALISE_METHOD_BINARY)
+		{
+			const FieldList& fields = object_type->GetFlattenedFields(profile);
+			for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+			{
+				SaveField(stream, object, **i, method, flags, profile);
+			}
+			return;
+		}
+
+		const FieldList& fields = object_type->GetProfileFields(profile);
+		FieldIndexWriter index_writer(stream);
 		if (method == SERIALISE_METHOD_BINARY_IFFV)
 		{
-			StreamWrite(stream, fields.size());
+			if (flags & serialise::FLAG_FIELD_INDEX)
+			{
+				index_writer.Begin((int)fields.size());
+			}
+			else
+			{
+				StreamWrite(stream, (int)fields.size());
+			}
 		}
 
-		for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
 		{
-			const Field& field = i->second;
+			const Field& field = **i;
 			FieldHeader header(field);
 
 			if (method == SERIALISE_METHOD_BINARY_IFFV)
 			{
+				if (index_writer.IsActive())
+				{
+					index_writer.AddField(header.m_NameCRC);
+				}
 				header.Write(stream);
 			}
 
-			if (SerialiseSaveFunc save_func = field.m_Serialisers.m_SaveFuncs[method])
+			SaveField(stream, object, field, method, flags, profile);
+
+			if (method == SERIALISE_METHOD_BINARY_IFFV)
 			{
-				save_func(stream, 0, (const char*)object + field.m_Offset);
+				header.PatchDataSize(stream);
 			}
+		}
 
-			else
+		if (index_writer.IsActive())
+		{
+			index_writer.Patch();
+		}
+
+		// Recurse into base types
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			SaveBinary(stream, (const char*)object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i), method, flags, profile);
+		}
+	}
+
+
+	int FindName(const Name* names, int nb_names, u32 name_crc)
+	{
+		for (int i = 0; i < nb_names; i++)
+		{
+			if (names[i].m_CRC == name_crc)
+				return i;
+		}
+		return -1;
+	}
+
+
+	void LoadFields(std::istream& stream, void* object, const Type* object_type, const Name* names, int nb_names, std::vector<bool>& loaded)
+	{
+		u32 start_position = (u32)stream.tellg();
+		int nb_fields;
+		StreamRead(stream, nb_fields);
+
+		if (nb_fields & FIELD_INDEX_BIT)
+		{
+			nb_fields &= ~FIELD_INDEX_BIT;
+			u32 object_size;
+			StreamRead(stream, object_size);
+			std::vector<FieldIndexEntry> entries(nb_fields);
+			if (nb_fields)
 			{
-				SaveObject(stream, (const char*)object + field.m_Offset, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, method);
+				stream.read((char*)&entries[0], nb_fields * sizeof(FieldIndexEntry));
 			}
 
-			if (method == SERIALISE_METHOD_BINARY_IFFV)
+			// Jump straight to each of the requested fields that belong to this type
+			for (int i = 0; i < nb_names; i++)
 			{
-				header.PatchDataSize(stream);
+				const Field* field = object_type->FindField(names[i]);
+				if (loaded[i] || field == 0)
+					continue;
+
+				FieldIndexEntry key;
+				key.m_NameCRC = names[i].m_CRC;
+				std::vector<FieldIndexEntry>::const_iterator entry = std::lower_bound(entries.begin(), entries.end(), key);
+				if (entry == entries.end() || entry->m_NameCRC != key.m_NameCRC)
+					continue;
+
+				stream.seekg(start_position + entry->m_HeaderOffset, std::ios_base::beg);
+				FieldHeader header;
+				header.Read(stream);
+				if (header.m_Version == field->m_Version)
+				{
+					LoadField(stream, object, *field, SERIALISE_METHOD_BINARY_IFFV, 0, PROFILE_ALL);
+					loaded[i] = true;
+				}
+			}
+
+			stream.seekg(start_position + object_size, std::ios_base::beg);
+		}
+
+		else
+		{
+			// No index so walk the field headers, skipping the data of any fields that aren't needed
+			for (int i = 0; i < nb_fields; i++)
+			{
+				FieldHeader header;
+				header.Read(stream);
+				u32 field_start = (u32)stream.tellg();
+
+				int name_index = FindName(names, nb_names, header.m_NameCRC);
+				if (name_index != -1 && !loaded[name_index])
+				{
+					const Field* field = object_type->FindField(Name(header.m_NameCRC));
+					if (field && field->m_Version == header.m_Version)
+					{
+						LoadField(stream, object, *field, SERIALISE_METHOD_BINARY_IFFV, 0, PROFILE_ALL);
+						loaded[name_index] = true;
+					}
+				}
+
+				stream.seekg(field_start + header.m_DataSize, std::ios_base::beg);
+			}
+		}
+
+		// Base types follow the fields of this type
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			LoadFields(stream, (char*)object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i), names, nb_names, loaded);
+		}
+	}
+
+
+	const u32 ARCHIVE_MAGIC = 0x41424c52;	// 'RLBA'
+	const u32 ARCHIVE_TRAILER_SIZE = sizeof(u32) * 3;
+
+
+	// The caches built on first use by types aren't thread-safe, so are built before any jobs start
+	void BuildTypeCaches(const Type* object_type, u32 flags, u32 profile, std::set<const Type*>& visited)
+	{
+		if (!visited.insert(object_type).second)
+			return;
+
+		const FieldList& fields = object_type->GetProfileFields(profile);
+		object_type->GetFlattenedFields(profile);
+		object_type->GetMinBinarySize(profile);
+		if (flags & serialise::FLAG_SKIP_DEFAULTS)
+		{
+			object_type->GetPresencePlan(profile);
+			object_type->GetComparePlan();
+			object_type->GetDefaultObject();
+		}
+
+		for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			const Field& field = **i;
+			BuildTypeCaches(field.m_Type, flags, profile, visited);
+			if (IContainerFactory* factory = field.m_ContainerFactory)
+			{
+				if (factory->m_KeyType)
+					BuildTypeCaches(factory->m_KeyType, flags, profile, visited);
+				BuildTypeCaches(factory->m_ValueType, flags, profile, visited);
+			}
+		}
+
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			BuildTypeCaches(&object_type->GetBaseType(i), flags, profile, visited);
+		}
+	}
+
+
+	// Appends data from the stream a block at a time, so that a corrupt size only allocates as
+	// much as the stream actually has. Returns false if the stream ends first.
+	bool ReadData(std::istream& stream, std::vector<char>& data, u32 size)
+	{
+		const u32 BLOCK_SIZE = 65536;
+		while (size && stream)
+		{
+			u32 nb_bytes = size < BLOCK_SIZE ? size : BLOCK_SIZE;
+			size_t offset = data.size();
+			data.resize(offset + nb_bytes);
+			stream.read(&data[offset], nb_bytes);
+			size -= nb_bytes;
+		}
+		return !stream.fail();
+	}
+
+
+	// Shared by all the jobs of a parallel save/load, with one job per chunk
+	struct ParallelBatch
+	{
+		ParallelBatch(const void* objects, int count, u32 stride, int chunk_size, const Type* type, u32 flags, u32 profile) :
+			m_Objects((char*)objects),
+			m_Count(count),
+			m_Stride(stride),
+			m_ChunkSize(chunk_size),
+			m_Type(type),
+			m_Flags(flags),
+			m_Profile(profile)
+		{
+		}
+
+		char* m_Objects;
+		int m_Count;
+		u32 m_Stride;
+		int m_ChunkSize;
+		const Type* m_Type;
+		u32 m_Flags;
+		u32 m_Profile;
+
+		// Saved chunks, or the loaded data and where each chunk starts within it, with any chunks
+		// that failed to load. Flags are chars so that jobs can set their own without a lock.
+		std::vector<std::string> m_Chunks;
+		std::vector<char> m_Data;
+		std::vector<u32> m_ChunkOffsets;
+		std::vector<char> m_ChunkFailed;
+
+		int GetChunkCount(int chunk) const
+		{
+			return std::min(m_ChunkSize, m_Count - chunk * m_ChunkSize);
+		}
+	};
+
+
+	void SaveChunk(void* data, int chunk)
+	{
+		ParallelBatch& batch = *(ParallelBatch*)data;
+		std::ostringstream stream;
+		serialise::SaveBinaryBatch(stream, batch.m_Objects + chunk * batch.m_ChunkSize * batch.m_Stride,
+			batch.GetChunkCount(chunk), batch.m_Stride, batch.m_Type, batch.m_Flags, batch.m_Profile);
+		batch.m_Chunks[chunk] = stream.str();
+	}
+
+
+	void LoadChunk(void* data, int chunk)
+	{
+		ParallelBatch& batch = *(ParallelBatch*)data;
+		u32 offset = batch.m_ChunkOffsets[chunk];
+		MemoryInputStream stream(&batch.m_Data[0] + offset, batch.m_ChunkOffsets[chunk + 1] - offset);
+		serialise::LoadBinaryBatch(stream, batch.m_Objects + chunk * batch.m_ChunkSize * batch.m_Stride,
+			batch.GetChunkCount(chunk), batch.m_Stride, batch.m_Type, batch.m_Flags, batch.m_Profile);
+		batch.m_ChunkFailed[chunk] = stream.fail();
+	}
+
+
+	// Large IFFV fields, with their data read into one buffer to be loaded by jobs
+	struct ParallelFields
+	{
+		struct Block
+		{
+			void* m_Object;
+			const Field* m_Field;
+			u32 m_Offset;
+			u32 m_Size;
+		};
+
+		u32 m_Profile;
+		std::vector<Block> m_Blocks;
+		std::vector<char> m_Data;
+	};
+
+
+	// Loads small fields as the field headers are walked and reads the data of large fields for later
+	void ScanIFFV(std::istream& stream, void* object, const Type* object_type, u32 min_parallel_size, ParallelFields& fields)
+	{
+		int nb_fields = ReadNbFields(stream);
+
+		for (int i = 0; i < nb_fields; i++)
+		{
+			FieldHeader header;
+			header.Read(stream);
+
+			const Field* field = object_type->FindField(Name(header.m_NameCRC));
+			if (!field || field->m_Version != header.m_Version || !field->IsInProfile(fields.m_Profile))
+			{
+				stream.seekg(header.m_DataSize, std::ios_base::cur);
+			}
+
+			// Empty fields have nothing to defer and no data to point at
+			else if (header.m_DataSize >= min_parallel_size && header.m_DataSize != 0)
+			{
+				// Read in blocks so a corrupt size fails at the end of the stream rather than allocating it all
+				ParallelFields::Block block = { object, field, (u32)fields.m_Data.size(), header.m_DataSize };
+				if (!ReadData(stream, fields.m_Data, block.m_Size))
+				{
+					fields.m_Data.resize(block.m_Offset);
+					return;
+				}
+				fields.m_Blocks.push_back(block);
+			}
+
+			else
+			{
+				u32 field_start = (u32)stream.tellg();
+				LoadField(stream, object, *field, SERIALISE_METHOD_BINARY_IFFV, 0, fields.m_Profile);
+				if ((u32)stream.tellg() - field_start != header.m_DataSize)
+					stream.seekg(field_start + header.m_DataSize);
 			}
 		}
 
-		// Recurse into base types
 		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
 		{
-			SaveBinary(stream, object, &object_type->GetBaseType(i), method);
+			ScanIFFV(stream, (char*)object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i), min_parallel_size, fields);
 		}
 	}
+
+
+	void LoadFieldBlock(void* data, int index)
+	{
+		ParallelFields& fields = *(ParallelFields*)data;
+		const ParallelFields::Block& block = fields.m_Blocks[index];
+		MemoryInputStream stream(&fields.m_Data[block.m_Offset], block.m_Size);
+		LoadField(stream, block.m_Object, *block.m_Field, SERIALISE_METHOD_BINARY_IFFV, 0, fields.m_Profile);
+	}
+}
+
+void serialise::LoadBinary(std::istream& stream, void* object, const Type* object_type, u32 flags, u32 profile)
+{
+	// The engine of an attached context writes the same bytes, reusing its memory between calls
+	SerialiseContext* context = GetContext(stream);
+	if (context && flags == 0)
+		context->GetEngine().Load(stream, object, object_type, profile);
+	else
+		::LoadBinary(stream, object, object_type, SERIALISE_METHOD_BINARY, flags, profile);
+}
+
+
+serialise::LoadStatus serialise::LoadBinaryBounded(std::istream& stream, void* object, const Type* object_type, u32 size, u32 flags, u32 profile)
+{
+	Bound bound = { (std::streamoff)stream.tellg() + size, false };
+	void* outer_bound = stream.pword(g_BoundIndex);
+	stream.pword(g_BoundIndex) = &bound;
+	::LoadBinary(stream, object, object_type, SERIALISE_METHOD_BINARY, flags, profile);
+	stream.pword(g_BoundIndex) = outer_bound;
+
+	if (bound.m_Rejected)
+		return LOAD_STATUS_ERROR;
+	if (!stream)
+		return LOAD_STATUS_NEED_MORE_DATA;
+	if ((std::streamoff)stream.tellg() > bound.m_End)
+	{
+		stream.setstate(std::ios_base::failbit);
+		return LOAD_STATUS_ERROR;
+	}
+	return LOAD_STATUS_COMPLETE;
+}
+
+
+bool serialise::CheckBound(std::istream& stream, int count, u32 value_size)
+{
+	Bound* bound = (Bound*)stream.pword(g_BoundIndex);
+	if (bound == 0)
+		return true;
+
+	// Already failed, so whatever was read isn't the count
+	if (!stream)
+		return false;
+
+	// Values that could be written in nothing are still limited to one per byte
+	std::streamoff remaining = bound->m_End - (std::streamoff)stream.tellg();
+	if (count < 0 || (std::streamoff)count * (value_size ? value_size : 1) > remaining)
+	{
+		bound->m_Rejected = true;
+		stream.setstate(std::ios_base::failbit);
+		return false;
+	}
+	return true;
 }
 
 
-void serialise::LoadBinary(std::istream& stream, void* object, const Type* object_type)
+void serialise::SaveBinary(std::ostream& stream, const void* object, const Type* object_type, u32 flags, u32 profile)
 {
-	::LoadBinary(stream, object, object_type, SERIALISE_METHOD_BINARY);
+	// Field indices only apply to IFFV
+	flags &= ~FLAG_FIELD_INDEX;
+
+	SerialiseContext* context = GetContext(stream);
+	if (context && flags == 0)
+		context->GetEngine().Save(stream, object, object_type, profile);
+	else
+		::SaveBinary(stream, object, object_type, SERIALISE_METHOD_BINARY, flags, profile);
+}
+
+
+void serialise::LoadBinaryBatch(std::istream& stream, void* objects, int count, u32 stride, const Type* object_type, u32 flags, u32 profile)
+{
+	if (count && IsBatchColumnar(object_type, flags))
+	{
+		LoadColumns(stream, (char*)objects, count, stride, object_type, SERIALISE_METHOD_BINARY, flags, profile);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		::LoadObject(stream, (char*)objects + i * stride, object_type, false, 0, SERIALISE_METHOD_BINARY, flags, profile);
+}
+
+
+void serialise::SaveBinaryBatch(std::ostream& stream, const void* objects, int count, u32 stride, const Type* object_type, u32 flags, u32 profile)
+{
+	flags &= ~FLAG_FIELD_INDEX;
+	if (count && IsBatchColumnar(object_type, flags))
+	{
+		SaveColumns(stream, (const char*)objects, count, stride, object_type, SERIALISE_METHOD_BINARY, flags, profile);
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+		::SaveObject(stream, (const char*)objects + i * stride, object_type, false, 0, SERIALISE_METHOD_BINARY, flags, profile);
+}
+
+
+//
+// Parallel batches are laid out as:
+//
+//    int nb_chunks
+//    int chunk_size
+//    u32 chunk_sizes[nb_chunks]
+//    chunk data
+//
+void serialise::LoadBinaryParallel(std::istream& stream, void* objects, int count, u32 stride, const Type* object_type, IJobRunner& runner, u32 flags, u32 profile)
+{
+	ParallelBatch batch(objects, count, stride, 0, object_type, flags, profile);
+	int nb_chunks;
+	StreamRead(stream, nb_chunks);
+	StreamRead(stream, batch.m_ChunkSize);
+	if (!stream || batch.m_ChunkSize <= 0 || nb_chunks != (count + batch.m_ChunkSize - 1) / batch.m_ChunkSize)
+	{
+		stream.setstate(std::ios_base::failbit);
+		return;
+	}
+
+	// Chunk sizes come from the stream so the offsets mustn't wrap
+	batch.m_ChunkOffsets.resize(nb_chunks + 1, 0);
+	for (int i = 0; i < nb_chunks; i++)
+	{
+		u32 size;
+		StreamRead(stream, size);
+		if (!stream || size > 0xFFFFFFFF - batch.m_ChunkOffsets[i])
+		{
+			stream.setstate(std::ios_base::failbit);
+			return;
+		}
+		batch.m_ChunkOffsets[i + 1] = batch.m_ChunkOffsets[i] + size;
+	}
+
+	// Chunks never read past the end of the data, and the extra byte gives empty chunks an address
+	if (!ReadData(stream, batch.m_Data, batch.m_ChunkOffsets[nb_chunks]))
+		return;
+	batch.m_Data.push_back(0);
+
+	std::set<const Type*> visited;
+	BuildTypeCaches(object_type, flags, profile, visited);
+	batch.m_ChunkFailed.resize(nb_chunks, 0);
+	runner.Run(LoadChunk, &batch, nb_chunks);
+
+	if (std::find(batch.m_ChunkFailed.begin(), batch.m_ChunkFailed.end(), 1) != batch.m_ChunkFailed.end())
+		stream.setstate(std::ios_base::failbit);
+}
+
+
+void serialise::SaveBinaryParallel(std::ostream& stream, const void* objects, int count, u32 stride, const Type* object_type, IJobRunner& runner, int chunk_size, u32 flags, u32 profile)
+{
+	RFLB_ASSERT(chunk_size > 0);
+	ParallelBatch batch(objects, count, stride, chunk_size, object_type, flags, profile);
+	int nb_chunks = (count + chunk_size - 1) / chunk_size;
+	batch.m_Chunks.resize(nb_chunks);
+
+	std::set<const Type*> visited;
+	BuildTypeCaches(object_type, flags, profile, visited);
+	runner.Run(SaveChunk, &batch, nb_chunks);
+
+	StreamWrite(stream, nb_chunks);
+	StreamWrite(stream, chunk_size);
+	for (int i = 0; i < nb_chunks; i++)
+	{
+		StreamWrite(stream, (u32)batch.m_Chunks[i].size());
+	}
+	for (int i = 0; i < nb_chunks; i++)
+	{
+		stream.write(batch.m_Chunks[i].data(), batch.m_Chunks[i].size());
+	}
+}
+
+
+void serialise::LoadBinaryField(std::istream& stream, void* object, const Field& field, u32 flags, u32 profile)
+{
+	::LoadField(stream, object, field, SERIALISE_METHOD_BINARY, flags, profile);
+}
+
+
+void serialise::SaveBinaryField(std::ostream& stream, const void* object, const Field& field, u32 flags, u32 profile)
+{
+	::SaveField(stream, object, field, SERIALISE_METHOD_BINARY, flags & ~FLAG_FIELD_INDEX, profile);
+}
+
+
+void serialise::LoadBinaryIFFV(std::istream& stream, void* object, const Type* object_type, u32 profile)
+{
+	::LoadBinary(stream, object, object_type, SERIALISE_METHOD_BINARY_IFFV, 0, profile);
+}
+
+
+void serialise::SaveBinaryIFFV(std::ostream& stream, const void* object, const rflb::Type* object_type, u32 flags, u32 profile)
+{
+	::SaveBinary(stream, object, object_type, SERIALISE_METHOD_BINARY_IFFV, flags, profile);
+}
+
+
+void serialise::LoadBinaryIFFVParallel(std::istream& stream, void* object, const Type* object_type, IJobRunner& runner, u32 min_parallel_size, u32 profile)
+{
+	std::set<const Type*> visited;
+	BuildTypeCaches(object_type, 0, profile, visited);
+
+	ParallelFields fields;
+	fields.m_Profile = profile;
+	ScanIFFV(stream, object, object_type, min_parallel_size, fields);
+	if (stream)
+		runner.Run(LoadFieldBlock, &fields, (int)fields.m_Blocks.size());
+}
+
+
+int serialise::LoadFields(std::istream& stream, void* object, const Type* object_type, const Name* names, int nb_names)
+{
+	std::vector<bool> loaded(nb_names, false);
+	::LoadFields(stream, object, object_type, names, nb_names, loaded);
+	return (int)std::count(loaded.begin(), loaded.end(), true);
+}
+
+
+serialise::ArchiveWriter::ArchiveWriter(std::ostream& stream, u32 flags)
+	: m_Stream(stream)
+	, m_StartPosition((u32)stream.tellp())
+	, m_Flags(flags)
+{
+}
+
+
+void serialise::ArchiveWriter::Save(const void* object, const Type* object_type)
+{
+	ArchiveEntry entry;
+	entry.m_Offset = (u32)m_Stream.tellp() - m_StartPosition;
+	entry.m_TypeCRC = object_type->GetName().m_CRC;
+	m_Entries.push_back(entry);
+
+	SaveBinaryIFFV(m_Stream, object, object_type, m_Flags);
+}
+
+
+void serialise::ArchiveWriter::Finish()
+{
+	// Write the object index followed by a fixed-size trailer that locates it
+	u32 footer_offset = (u32)m_Stream.tellp() - m_StartPosition;
+	if (!m_Entries.empty())
+	{
+		m_Stream.write((char*)&m_Entries[0], m_Entries.size() * sizeof(ArchiveEntry));
+	}
+	StreamWrite(m_Stream, (u32)m_Entries.size());
+	StreamWrite(m_Stream, footer_offset);
+	StreamWrite(m_Stream, ARCHIVE_MAGIC);
+}
+
+
+serialise::ArchiveReader::ArchiveReader(std::istream& stream)
+	: m_Stream(stream)
+	, m_StartPosition(0)
+	, m_IndexOffset(0)
+	, m_IsValid(false)
+{
+	// Read the trailer from the end of the stream
+	stream.seekg(0, std::ios_base::end);
+	u32 end_position = (u32)stream.tellg();
+	if (end_position < ARCHIVE_TRAILER_SIZE)
+		return;
+
+	u32 nb_objects, footer_offset, magic;
+	stream.seekg(end_position - ARCHIVE_TRAILER_SIZE, std::ios_base::beg);
+	StreamRead(stream, nb_objects);
+	StreamRead(stream, footer_offset);
+	StreamRead(stream, magic);
+	if (!stream || magic != ARCHIVE_MAGIC)
+		return;
+
+	// Locate the start of the archive, which may be embedded in a larger stream
+	// Sizes are checked by division first so corrupt counts can't wrap around
+	if (nb_objects > (end_position - ARCHIVE_TRAILER_SIZE) / sizeof(ArchiveEntry))
+		return;
+	u32 index_size = nb_objects * sizeof(ArchiveEntry);
+	u32 index_position = end_position - ARCHIVE_TRAILER_SIZE - index_size;
+	if (footer_offset > index_position)
+		return;
+	m_StartPosition = index_position - footer_offset;
+	m_IndexOffset = footer_offset;
+
+	m_Entries.resize(nb_objects);
+	stream.seekg(index_position, std::ios_base::beg);
+	if (nb_objects)
+	{
+		stream.read((char*)&m_Entries[0], index_size);
+	}
+	m_IsValid = !stream.fail();
 }
 
 
-void serialise::SaveBinary(std::ostream& stream, const void* object, const Type* object_type)
+void serialise::ArchiveReader::Load(int index, void* object, const Type* object_type)
 {
-	::SaveBinary(stream, object, object_type, SERIALISE_METHOD_BINARY);
+	const ArchiveEntry& entry = GetEntry(index, object_type);
+	m_Stream.seekg(m_StartPosition + entry.m_Offset, std::ios_base::beg);
+	LoadBinaryIFFV(m_Stream, object, object_type);
 }
 
 
-void serialise::LoadBinaryIFFV(std::istream& stream, void* object, const Type* object_type)
+int serialise::ArchiveReader::LoadFields(int index, void* object, const Type* object_type, const Name* names, int nb_names)
 {
-	::LoadBinary(stream, object, object_type, SERIALISE_METHOD_BINARY_IFFV);
+	const ArchiveEntry& entry = GetEntry(index, object_type);
+	m_Stream.seekg(m_StartPosition + entry.m_Offset, std::ios_base::beg);
+	return serialise::LoadFields(m_Stream, object, object_type, names, nb_names);
 }
 
 
-void serialise::SaveBinaryIFFV(std::ostream& stream, const void* object, const rflb::Type* object_type)
+const serialise::ArchiveEntry& serialise::ArchiveReader::GetEntry(int index, const Type* object_type) const
 {
-	::SaveBinary(stream, object, object_type, SERIALISE_METHOD_BINARY_IFFV);
+	RFLB_ASSERT(m_IsValid);
+	RFLB_ASSERT(index >= 0 && index < (int)m_Entries.size());
+	const ArchiveEntry& entry = m_Entries[index];
+	RFLB_ASSERT(entry.m_TypeCRC == object_type->GetName().m_CRC);
+
+	// Objects are all written before the index
+	RFLB_ASSERT(entry.m_Offset < m_IndexOffset);
+	return entry;
 }
\ No newline at end of file
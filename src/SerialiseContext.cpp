@@ -0,0 +1,35 @@
+
+#include <rflb/SerialiseContext.h>
+#include <ios>
+
+
+namespace
+{
+	// Stream storage slot for the context pointer, allocated once for all streams
+	const int g_ContextIndex = std::ios_base::xalloc();
+}
+
+
+void serialise::SerialiseContext::Attach(std::ios_base& stream)
+{
+	stream.pword(g_ContextIndex) = this;
+}
+
+
+void serialise::SerialiseContext::Detach(std::ios_base& stream)
+{
+	stream.pword(g_ContextIndex) = 0;
+}
+
+
+u32 serialise::SerialiseContext::AddObject(void* object)
+{
+	m_Objects.push_back(object);
+	return (u32)m_Objects.size() - 1;
+}
+
+
+serialise::SerialiseContext* serialise::GetContext(std::ios_base& stream)
+{
+	return (SerialiseContext*)stream.pword(g_ContextIndex);
+}
\ No newline at end of file
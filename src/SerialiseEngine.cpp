@@ -0,0 +1,314 @@
+
+#include <rflb/SerialiseEngine.h>
+#include <rflb/SerialiseBinary.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <iostream>
+
+using namespace rflb;
+
+
+namespace
+{
+	const u32 SCRATCH_ALIGNMENT = 16;
+	const u32 SCRATCH_BLOCK_SIZE = 4096;
+}
+
+
+serialise::ScratchStack::ScratchStack()
+	: m_Current(-1)
+{
+}
+
+
+serialise::ScratchStack::~ScratchStack()
+{
+	for (size_t i = 0; i < m_Blocks.size(); i++)
+	{
+		operator delete(m_Blocks[i].m_Data);
+	}
+}
+
+
+void* serialise::ScratchStack::Push(u32 size)
+{
+	size = (size + SCRATCH_ALIGNMENT - 1) & ~(SCRATCH_ALIGNMENT - 1);
+
+	if (m_Current >= 0)
+	{
+		Block& block = m_Blocks[m_Current];
+		if (block.m_Used + size <= block.m_Size)
+		{
+			void* data = block.m_Data + block.m_Used;
+			block.m_Used += size;
+			return data;
+		}
+	}
+
+	// Blocks after the current one are unused, so any that are too small are replaced
+	int next = m_Current + 1;
+	while (next < (int)m_Blocks.size() && m_Blocks[next].m_Size < size)
+	{
+		operator delete(m_Blocks[next].m_Data);
+		m_Blocks.erase(m_Blocks.begin() + next);
+	}
+
+	if (next == (int)m_Blocks.size())
+	{
+		Block block;
+		block.m_Size = size > SCRATCH_BLOCK_SIZE ? size : SCRATCH_BLOCK_SIZE;
+		block.m_Data = (char*)operator new(block.m_Size);
+		block.m_Used = 0;
+		m_Blocks.push_back(block);
+	}
+
+	m_Current = next;
+	m_Blocks[next].m_Used = size;
+	return m_Blocks[next].m_Data;
+}
+
+
+serialise::ScratchStack::Marker serialise::ScratchStack::GetMarker() const
+{
+	Marker marker = { m_Current, m_Current >= 0 ? m_Blocks[m_Current].m_Used : 0 };
+	return marker;
+}
+
+
+void serialise::ScratchStack::Release(const Marker& marker)
+{
+	for (int i = marker.m_Block + 1; i <= m_Current; i++)
+	{
+		m_Blocks[i].m_Used = 0;
+	}
+
+	m_Current = marker.m_Block;
+	if (m_Current >= 0)
+		m_Blocks[m_Current].m_Used = marker.m_Used;
+}
+
+
+void serialise::BinaryEngine::Save(std::ostream& stream, const void* object, const Type* object_type, u32 profile)
+{
+	// Only frames above the current top belong to this call, in case it's nested within a custom serialiser
+	size_t first_frame = m_Frames.size();
+
+	// The fields of the root object are always walked, the same as SaveBinary
+	PushObject((void*)object, object_type, profile);
+	while (m_Frames.size() > first_frame)
+	{
+		SaveStep(stream, profile);
+	}
+}
+
+
+void serialise::BinaryEngine::Load(std::istream& stream, void* object, const Type* object_type, u32 profile)
+{
+	size_t first_frame = m_Frames.size();
+	PushObject(object, object_type, profile);
+	while (m_Frames.size() > first_frame)
+	{
+		LoadStep(stream, profile);
+	}
+}
+
+
+void serialise::BinaryEngine::PushObject(void* object, const Type* object_type, u32 profile)
+{
+	// Base type fields are included so objects are a single frame
+	Frame frame = { (char*)object, object_type, &object_type->GetFlattenedFields(profile), 0, 0, 0, 0, 0, 0, false, m_Scratch.GetMarker() };
+	m_Frames.push_back(frame);
+}
+
+
+void serialise::BinaryEngine::SaveValue(std::ostream& stream, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, u32 profile)
+{
+	if (is_pointer)
+	{
+		// TODO: get CRC and serialise that
+	}
+
+	else if (SerialiseSaveFunc save = object_type->GetSerialisers().m_SaveFuncs[SERIALISE_METHOD_BINARY])
+	{
+		save(stream, 0, object);
+	}
+
+	else if (factory)
+	{
+		Frame frame = { (char*)object, object_type, 0, 0, factory, 0, 0, 0, 0, false, m_Scratch.GetMarker() };
+		frame.m_ReadIterator = factory->ConstructReadIterator(m_Scratch.Push(factory->GetReadIteratorSize()), object);
+		int count = frame.m_ReadIterator->GetCount();
+		StreamWrite(stream, count);
+		m_Frames.push_back(frame);
+	}
+
+	else if (SerialiseSaveFunc save = profile == PROFILE_ALL ? object_type->GetGeneratedSave() : 0)
+	{
+		save(stream, 0, object);
+	}
+
+	else if (object_type->GetFields().empty())
+	{
+		// TODO: endian-ness
+		stream.write((const char*)object, object_type->GetSize());
+	}
+
+	else
+	{
+		PushObject((void*)object, object_type, profile);
+	}
+}
+
+
+void serialise::BinaryEngine::LoadValue(std::istream& stream, void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, u32 profile)
+{
+	if (is_pointer)
+	{
+		// TODO: read CRC and lookup object
+	}
+
+	else if (SerialiseLoadFunc load = object_type->GetSerialisers().m_LoadFuncs[SERIALISE_METHOD_BINARY])
+	{
+		load(stream, 0, object);
+	}
+
+	else if (factory)
+	{
+		Frame frame = { (char*)object, object_type, 0, 0, factory, 0, 0, 0, 0, false, m_Scratch.GetMarker() };
+		frame.m_WriteIterator = factory->ConstructContainer(m_Scratch.Push(factory->GetWriteIteratorSize()), object);
+		StreamRead(stream, frame.m_Count);
+
+		// Nested loads from custom serialisers can be part of a bounded load, which fails the stream
+		u32 value_size = factory->m_ValueIsPointer ? 0 : factory->m_ValueType->GetMinBinarySize(profile);
+		if (Type* key_type = factory->m_KeyType)
+			value_size += factory->m_KeyIsPointer ? 0 : key_type->GetMinBinarySize(profile);
+		if (!CheckBound(stream, frame.m_Count, value_size))
+			frame.m_Count = 0;
+
+		// Negative counts from unbounded loads of corrupt data load nothing
+		if (frame.m_Count > 0)
+			frame.m_WriteIterator->Reserve(frame.m_Count);
+
+		// A temporary for each key to be loaded into before its value is added
+		if (Type* key_type = factory->m_KeyType)
+		{
+			frame.m_Key = m_Scratch.Push(key_type->GetSize());
+			key_type->ConstructObject(frame.m_Key);
+		}
+
+		m_Frames.push_back(frame);
+	}
+
+	else if (SerialiseLoadFunc load = profile == PROFILE_ALL ? object_type->GetGeneratedLoad() : 0)
+	{
+		load(stream, 0, object);
+	}
+
+	else if (object_type->GetFields().empty())
+	{
+		stream.read((char*)object, object_type->GetSize());
+	}
+
+	else
+	{
+		PushObject(object, object_type, profile);
+	}
+}
+
+
+void serialise::BinaryEngine::SaveStep(std::ostream& stream, u32 profile)
+{
+	// Pushing a frame can move the others so the frame isn't used after any call that can push
+	Frame& frame = m_Frames.back();
+
+	if (IContainerFactory* factory = frame.m_Factory)
+	{
+		IReadIterator* iterator = frame.m_ReadIterator;
+		if (!iterator->IsValid())
+		{
+			factory->DestructIterator(iterator);
+			m_Scratch.Release(frame.m_ScratchMarker);
+			m_Frames.pop_back();
+		}
+
+		else if (factory->m_KeyType && !frame.m_KeyDone)
+		{
+			frame.m_KeyDone = true;
+			SaveValue(stream, iterator->GetKey(), factory->m_KeyType, factory->m_KeyIsPointer, 0, profile);
+		}
+
+		else
+		{
+			// Values stay where they are while the container is saved so the iterator can move on
+			frame.m_KeyDone = false;
+			const void* value = iterator->GetValue();
+			iterator->MoveNext();
+			SaveValue(stream, value, factory->m_ValueType, factory->m_ValueIsPointer, 0, profile);
+		}
+	}
+
+	else if (frame.m_FieldIndex < (int)frame.m_Fields->size())
+	{
+		const Field& field = *(*frame.m_Fields)[frame.m_FieldIndex++];
+		const void* field_data = frame.m_Object + field.m_Offset;
+
+		if (SerialiseSaveFunc save_func = field.m_Serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY])
+			save_func(stream, 0, field_data);
+		else
+			SaveValue(stream, field_data, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, profile);
+	}
+
+	else
+	{
+		m_Frames.pop_back();
+	}
+}
+
+
+void serialise::BinaryEngine::LoadStep(std::istream& stream, u32 profile)
+{
+	Frame& frame = m_Frames.back();
+
+	if (IContainerFactory* factory = frame.m_Factory)
+	{
+		if (frame.m_Count <= 0)
+		{
+			if (frame.m_Key)
+				factory->m_KeyType->DestructObject(frame.m_Key);
+			factory->DestructIterator(frame.m_WriteIterator);
+			m_Scratch.Release(frame.m_ScratchMarker);
+			m_Frames.pop_back();
+		}
+
+		else if (frame.m_Key && !frame.m_KeyDone)
+		{
+			frame.m_KeyDone = true;
+			LoadValue(stream, frame.m_Key, factory->m_KeyType, false, 0, profile);
+		}
+
+		else
+		{
+			// The key has been completely loaded by now, including anything it pushed
+			frame.m_KeyDone = false;
+			frame.m_Count--;
+			void* value = frame.m_Key ? frame.m_WriteIterator->AddEmpty(frame.m_Key) : frame.m_WriteIterator->AddEmpty();
+			LoadValue(stream, value, factory->m_ValueType, factory->m_ValueIsPointer, 0, profile);
+		}
+	}
+
+	else if (frame.m_FieldIndex < (int)frame.m_Fields->size())
+	{
+		const Field& field = *(*frame.m_Fields)[frame.m_FieldIndex++];
+		void* field_data = frame.m_Object + field.m_Offset;
+
+		if (SerialiseLoadFunc load_func = field.m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY])
+			load_func(stream, 0, field_data);
+		else
+			LoadValue(stream, field_data, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, profile);
+	}
+
+	else
+	{
+		m_Frames.pop_back();
+	}
+}
\ No newline at end of file
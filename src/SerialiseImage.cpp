@@ -0,0 +1,365 @@
+
+#include <rflb/SerialiseImage.h>
+#include <rflb/MemoryStream.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+using namespace rflb;
+using namespace serialise;
+
+
+namespace
+{
+	const u32 IMAGE_MAGIC = 0x494c4652;		// 'RFLI'
+	const u32 IMAGE_VERSION = 2;
+
+
+	u32 Align(u32 value)
+	{
+		return (value + IMAGE_ALIGNMENT - 1) & ~(IMAGE_ALIGNMENT - 1);
+	}
+
+
+	//
+	// Builds the image in memory, as payloads are appended while earlier objects are
+	// still being written. Everything is addressed by offset as the buffer can move.
+	//
+	class ImageWriter
+	{
+	public:
+		u32 Allocate(u32 size)
+		{
+			u32 offset = Align((u32)m_Data.size());
+			m_Data.resize(offset + size, 0);
+			return offset;
+		}
+
+		void WriteObject(u32 dest, const void* object, const Type* object_type)
+		{
+			const Fields& fields = object_type->GetFields();
+			for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+			{
+				const Field& field = i->second;
+				if (field.m_Attributes.transient)
+					continue;
+				WriteValue(dest + field.m_Offset, (const char*)object + field.m_Offset, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, field.m_Serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY]);
+			}
+
+			for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+			{
+				u32 offset = object_type->GetBaseOffset(i);
+				WriteObject(dest + offset, (const char*)object + offset, &object_type->GetBaseType(i));
+			}
+		}
+
+		void WriteValue(u32 dest, const void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseSaveFunc save)
+		{
+			if (is_pointer)
+			{
+				// TODO: Relative offsets to other objects in the image
+			}
+
+			else if (save || (save = object_type->GetSerialisers().m_SaveFuncs[SERIALISE_METHOD_BINARY]))
+			{
+				WriteCustom(dest, object, object_type, save);
+			}
+
+			else if (factory && factory->m_IsInline)
+			{
+				WriteInlineCollection(dest, object, factory);
+			}
+
+			else if (factory)
+			{
+				WriteCollection(dest, object, factory);
+			}
+
+			else if (object_type->GetFields().empty())
+			{
+				memcpy(&m_Data[dest], object, object_type->GetSize());
+			}
+
+			else
+			{
+				WriteObject(dest, object, object_type);
+			}
+		}
+
+		void WriteCustom(u32 dest, const void* object, const Type* object_type, SerialiseSaveFunc save)
+		{
+			std::ostringstream stream(std::ios_base::out | std::ios_base::binary);
+			save(stream, 0, object);
+			std::string data = stream.str();
+
+			u32 payload = Allocate((u32)data.size());
+			if (!data.empty())
+			{
+				memcpy(&m_Data[payload], data.data(), data.size());
+			}
+
+			if (object_type->GetSize() >= (int)sizeof(ImageBlock))
+			{
+				WriteBlock(dest, payload, (u32)data.size());
+			}
+			else
+			{
+				Indirect indirect = { dest, payload, (u32)data.size() };
+				m_Indirect.push_back(indirect);
+			}
+		}
+
+		// Writes the blocks of small custom serialised values, returning where they start
+		u32 WriteIndirectBlocks()
+		{
+			std::sort(m_Indirect.begin(), m_Indirect.end());
+			u32 table = Allocate((u32)(m_Indirect.size() * sizeof(ImageIndirectBlock)));
+			for (size_t i = 0; i < m_Indirect.size(); i++)
+			{
+				u32 entry = table + (u32)(i * sizeof(ImageIndirectBlock));
+				memcpy(&m_Data[entry], &m_Indirect[i].m_ValueOffset, sizeof(u32));
+				WriteBlock(entry + offsetof(ImageIndirectBlock, m_Block), m_Indirect[i].m_Payload, m_Indirect[i].m_Count);
+			}
+			return table;
+		}
+
+		void WriteInlineCollection(u32 dest, const void* object, IContainerFactory* factory)
+		{
+			// Values are written in place, the same as they're laid out in the container
+			const Type* value_type = factory->m_ValueType;
+			IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, object);
+			for (u32 offset = dest; iterator->IsValid(); iterator->MoveNext(), offset += value_type->GetSize())
+			{
+				WriteValue(offset, iterator->GetValue(), value_type, factory->m_ValueIsPointer, 0, 0);
+			}
+			RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+		}
+
+		void WriteCollection(u32 dest, const void* object, IContainerFactory* factory)
+		{
+			const Type* key_type = factory->m_KeyType;
+			const Type* value_type = factory->m_ValueType;
+
+			IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, object);
+			u32 count = iterator->GetCount();
+
+			// Allocate keys and values together so that the values can be located from the keys
+			u32 keys_size = key_type ? Align(count * key_type->GetSize()) : 0;
+			u32 payload = Allocate(keys_size + count * value_type->GetSize());
+			WriteBlock(dest, payload, count);
+
+			for (u32 i = 0; iterator->IsValid(); iterator->MoveNext(), i++)
+			{
+				if (key_type)
+				{
+					WriteValue(payload + i * key_type->GetSize(), iterator->GetKey(), key_type, factory->m_KeyIsPointer, 0, 0);
+				}
+				WriteValue(payload + keys_size + i * value_type->GetSize(), iterator->GetValue(), value_type, factory->m_ValueIsPointer, 0, 0);
+			}
+
+			RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+		}
+
+		void WriteBlock(u32 dest, u32 payload, u32 count)
+		{
+			ImageBlock block;
+			block.m_Offset = (int)payload - (int)dest;
+			block.m_Count = count;
+			memcpy(&m_Data[dest], &block, sizeof(block));
+		}
+
+		struct Indirect
+		{
+			u32 m_ValueOffset;
+			u32 m_Payload;
+			u32 m_Count;
+
+			bool operator < (const Indirect& rhs) const
+			{
+				return m_ValueOffset < rhs.m_ValueOffset;
+			}
+		};
+
+		std::vector<char> m_Data;
+		std::vector<Indirect> m_Indirect;
+	};
+
+
+	bool IndirectLess(const ImageIndirectBlock& block, u32 value_offset)
+	{
+		return block.m_ValueOffset < value_offset;
+	}
+
+
+	const ImageBlock& FindBlock(const char* image, const char* src, u32 size)
+	{
+		if (size >= sizeof(ImageBlock))
+			return *(const ImageBlock*)src;
+
+		const ImageHeader& header = *(const ImageHeader*)image;
+		const ImageIndirectBlock* begin = (const ImageIndirectBlock*)(image + header.m_IndirectOffset);
+		const ImageIndirectBlock* end = begin + header.m_NbIndirect;
+		u32 value_offset = (u32)(src - image);
+		const ImageIndirectBlock* found = std::lower_bound(begin, end, value_offset, IndirectLess);
+		RFLB_ASSERT(found != end && found->m_ValueOffset == value_offset);
+		return found->m_Block;
+	}
+
+
+	void ReadObject(const char* image, const char* src, void* object, const Type* object_type);
+
+
+	void ReadValue(const char* image, const char* src, void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory, SerialiseLoadFunc load)
+	{
+		if (is_pointer)
+		{
+			// TODO: Resolve relative offsets to other objects in the image
+		}
+
+		else if (load || (load = object_type->GetSerialisers().m_LoadFuncs[SERIALISE_METHOD_BINARY]))
+		{
+			const ImageBlock& block = FindBlock(image, src, object_type->GetSize());
+			MemoryInputStream stream(block.GetData(), block.m_Count);
+			load(stream, 0, object);
+		}
+
+		else if (factory && factory->m_IsInline)
+		{
+			const Type* value_type = factory->m_ValueType;
+			IWriteIterator* iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, object);
+			IReadIterator* count_iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, object);
+			int count = count_iterator->GetCount();
+			RFLB_DELETE_TEMP_ITERATOR(factory, count_iterator);
+
+			for (int i = 0; i < count; i++)
+			{
+				ReadValue(image, src + i * value_type->GetSize(), iterator->AddEmpty(), value_type, factory->m_ValueIsPointer, 0, 0);
+			}
+			RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+		}
+
+		else if (factory)
+		{
+			const ImageBlock& block = *(const ImageBlock*)src;
+			Type* key_type = factory->m_KeyType;
+			const Type* value_type = factory->m_ValueType;
+			IWriteIterator* iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, object);
+
+			if (key_type)
+			{
+				const char* keys = (const char*)block.GetData();
+				const char* values = (const char*)block.GetValueData(key_type->GetSize());
+
+				// Construct a temporary for the key
+				void* key = _alloca(key_type->GetSize());
+				key_type->ConstructObject(key);
+
+				for (u32 i = 0; i < block.m_Count; i++)
+				{
+					ReadValue(image, keys + i * key_type->GetSize(), key, key_type, false, 0, 0);
+					void* value_object = iterator->AddEmpty(key);
+					ReadValue(image, values + i * value_type->GetSize(), value_object, value_type, factory->m_ValueIsPointer, 0, 0);
+				}
+
+				key_type->DestructObject(key);
+			}
+
+			else
+			{
+				const char* values = (const char*)block.GetData();
+				for (u32 i = 0; i < block.m_Count; i++)
+				{
+					ReadValue(image, values + i * value_type->GetSize(), iterator->AddEmpty(), value_type, factory->m_ValueIsPointer, 0, 0);
+				}
+			}
+
+			RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+		}
+
+		else if (object_type->GetFields().empty())
+		{
+			memcpy(object, src, object_type->GetSize());
+		}
+
+		else
+		{
+			ReadObject(image, src, object, object_type);
+		}
+	}
+
+
+	void ReadObject(const char* image, const char* src, void* object, const Type* object_type)
+	{
+		const Fields& fields = object_type->GetFields();
+		for (Fields::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			const Field& field = i->second;
+			if (field.m_Attributes.transient)
+				continue;
+			ReadValue(image, src + field.m_Offset, (char*)object + field.m_Offset, field.m_Type, field.m_IsPointer, field.m_ContainerFactory, field.m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY]);
+		}
+
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			u32 offset = object_type->GetBaseOffset(i);
+			ReadObject(image, src + offset, (char*)object + offset, &object_type->GetBaseType(i));
+		}
+	}
+}
+
+
+void serialise::SaveImage(std::ostream& stream, const void* object, const Type* object_type)
+{
+	ImageWriter writer;
+	u32 header = writer.Allocate(sizeof(ImageHeader));
+	u32 root = writer.Allocate(object_type->GetSize());
+	writer.WriteObject(root, object, object_type);
+	u32 nb_indirect = (u32)writer.m_Indirect.size();
+	u32 indirect = writer.WriteIndirectBlocks();
+
+	ImageHeader image_header;
+	image_header.m_Magic = IMAGE_MAGIC;
+	image_header.m_Version = IMAGE_VERSION;
+	image_header.m_TypeCRC = object_type->GetName().m_CRC;
+	image_header.m_RootOffset = root;
+	image_header.m_Size = (u32)writer.m_Data.size();
+	image_header.m_IndirectOffset = indirect;
+	image_header.m_NbIndirect = nb_indirect;
+	memcpy(&writer.m_Data[header], &image_header, sizeof(image_header));
+
+	stream.write(&writer.m_Data[0], writer.m_Data.size());
+}
+
+
+const void* serialise::GetImageObject(const void* image, const Type* object_type)
+{
+	const ImageHeader& header = *(const ImageHeader*)image;
+	if (header.m_Magic != IMAGE_MAGIC || header.m_Version != IMAGE_VERSION || header.m_TypeCRC != object_type->GetName().m_CRC)
+		return 0;
+	return (const char*)image + header.m_RootOffset;
+}
+
+
+const serialise::ImageBlock& serialise::GetImageBlock(const void* image_object, const Field& field)
+{
+	RFLB_ASSERT(field.m_Type->GetSize() >= (int)sizeof(ImageBlock));
+	return *(const ImageBlock*)((const char*)image_object + field.m_Offset);
+}
+
+
+const serialise::ImageBlock& serialise::GetImageBlock(const void* image, const void* image_object, const Field& field)
+{
+	return FindBlock((const char*)image, (const char*)image_object + field.m_Offset, field.m_Type->GetSize());
+}
+
+
+void serialise::LoadImage(const void* image, void* object, const Type* object_type)
+{
+	const void* image_object = GetImageObject(image, object_type);
+	RFLB_ASSERT(image_object != 0);
+	ReadObject((const char*)image, (const char*)image_object, object, object_type);
+}
\ No newline at end of file
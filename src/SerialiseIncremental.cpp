@@ -0,0 +1,564 @@
+
+#include <rflb/SerialiseIncremental.h>
+#include <rflb/MemoryStream.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <cstring>
+
+using namespace rflb;
+
+
+namespace
+{
+	enum ObjectStage
+	{
+		OBJECT_STAGE_FIELDS,
+		OBJECT_STAGE_READ_NB_FIELDS,
+		OBJECT_STAGE_NB_FIELDS_READ,
+		OBJECT_STAGE_NEXT_HEADER,
+		OBJECT_STAGE_HEADER_READ,
+		OBJECT_STAGE_FIELD_END,
+		OBJECT_STAGE_BASES
+	};
+
+
+	enum CollectionStage
+	{
+		COLLECTION_STAGE_READ_COUNT,
+		COLLECTION_STAGE_COUNT_READ,
+		COLLECTION_STAGE_NEXT_ELEMENT,
+		COLLECTION_STAGE_KEY_LOADED
+	};
+
+
+	// Matches the flag in SerialiseBinary.cpp for objects preceded by a field index
+	const u32 FIELD_INDEX_BIT = 0x80000000;
+
+
+	template <typename TYPE> TYPE ReadScratch(const char* scratch, int offset)
+	{
+		TYPE value;
+		memcpy(&value, scratch + offset, sizeof(value));
+		return value;
+	}
+}
+
+
+serialise::IncrementalLoader::IncrementalLoader() :
+	m_Method(SERIALISE_METHOD_BINARY),
+	m_Profile(PROFILE_ALL),
+	m_Status(LOAD_STATUS_COMPLETE),
+	m_Position(0),
+	m_End(0),
+	m_ReadDest(0),
+	m_ReadLeft(0),
+	m_SkipLeft(0),
+	m_CustomLoad(0),
+	m_CustomObject(0),
+	m_CustomType(0),
+	m_CustomNeeded(0)
+{
+}
+
+
+serialise::IncrementalLoader::~IncrementalLoader()
+{
+	Reset();
+}
+
+
+void serialise::IncrementalLoader::Begin(void* object, const Type* object_type, SerialiseMethod method, u32 profile, u32 size)
+{
+	RFLB_ASSERT(method == SERIALISE_METHOD_BINARY || method == SERIALISE_METHOD_BINARY_IFFV);
+
+	Reset();
+	m_Method = method;
+	m_Profile = profile;
+	m_End = size;
+	m_Status = LOAD_STATUS_NEED_MORE_DATA;
+
+	// As with LoadBinary, the fields of the root object are always walked
+	PushObject(object, object_type);
+}
+
+
+serialise::LoadStatus serialise::IncrementalLoader::Feed(const void* data, u32 size, u32* nb_consumed)
+{
+	const char* input = (const char*)data;
+	u32 input_size = size;
+
+	while (m_Status == LOAD_STATUS_NEED_MORE_DATA)
+	{
+		if (m_ReadLeft)
+		{
+			// Copy as much of the pending read as is available
+			u32 nb_bytes = m_ReadLeft < input_size ? m_ReadLeft : input_size;
+			memcpy(m_ReadDest, input, nb_bytes);
+			m_ReadDest += nb_bytes;
+			m_ReadLeft -= nb_bytes;
+			m_Position += nb_bytes;
+			input += nb_bytes;
+			input_size -= nb_bytes;
+			if (m_ReadLeft)
+				break;
+		}
+
+		else if (m_SkipLeft)
+		{
+			u32 nb_bytes = m_SkipLeft < input_size ? m_SkipLeft : input_size;
+			m_SkipLeft -= nb_bytes;
+			m_Position += nb_bytes;
+			input += nb_bytes;
+			input_size -= nb_bytes;
+			if (m_SkipLeft)
+				break;
+		}
+
+		else if (m_CustomLoad)
+		{
+			if (!RunCustomLoad(input, input_size))
+				break;
+		}
+
+		else if (m_Frames.empty())
+		{
+			m_Status = LOAD_STATUS_COMPLETE;
+		}
+
+		else
+		{
+			Step();
+		}
+	}
+
+	if (nb_consumed)
+	{
+		*nb_consumed = size - input_size;
+	}
+
+	return m_Status;
+}
+
+
+void serialise::IncrementalLoader::Reset()
+{
+	// Release any containers that were left half-loaded
+	while (!m_Frames.empty())
+	{
+		PopFrame();
+	}
+
+	m_Position = 0;
+	m_ReadDest = 0;
+	m_ReadLeft = 0;
+	m_SkipLeft = 0;
+	m_CustomLoad = 0;
+	m_CustomObject = 0;
+	m_CustomType = 0;
+	m_CustomData.clear();
+	m_CustomNeeded = 0;
+}
+
+
+void serialise::IncrementalLoader::Step()
+{
+	if (m_Frames.back().m_Kind == Frame::KIND_OBJECT)
+	{
+		StepObject();
+	}
+	else
+	{
+		StepCollection();
+	}
+}
+
+
+void serialise::IncrementalLoader::StepObject()
+{
+	// Pushing a frame invalidates this reference so the frame is always updated before that happens
+	Frame& frame = m_Frames.back();
+	void* object = frame.m_Object;
+	const Type* object_type = frame.m_Type;
+
+	switch (frame.m_Stage)
+	{
+		case OBJECT_STAGE_FIELDS:
+			if (frame.m_Field != object_type->GetProfileFields(m_Profile).end())
+			{
+				const Field& field = **frame.m_Field;
+				++frame.m_Field;
+				PushField(object, field);
+			}
+			else
+			{
+				frame.m_Stage = OBJECT_STAGE_BASES;
+			}
+			break;
+
+		case OBJECT_STAGE_READ_NB_FIELDS:
+			frame.m_Stage = OBJECT_STAGE_NB_FIELDS_READ;
+			RequestRead(m_Scratch, sizeof(int));
+			break;
+
+		case OBJECT_STAGE_NB_FIELDS_READ:
+		{
+			int nb_fields = ReadScratch<int>(m_Scratch, 0);
+			if (nb_fields & FIELD_INDEX_BIT)
+			{
+				// The fields arrive in order so skip the object size and field index
+				nb_fields &= ~FIELD_INDEX_BIT;
+				m_SkipLeft = sizeof(u32) + nb_fields * sizeof(u32) * 2;
+			}
+			frame.m_NbFieldsLeft = nb_fields;
+			frame.m_Stage = OBJECT_STAGE_NEXT_HEADER;
+			break;
+		}
+
+		case OBJECT_STAGE_NEXT_HEADER:
+			if (frame.m_NbFieldsLeft > 0)
+			{
+				frame.m_NbFieldsLeft--;
+				frame.m_Stage = OBJECT_STAGE_HEADER_READ;
+				RequestRead(m_Scratch, sizeof(u32) * 3);
+			}
+			else
+			{
+				frame.m_Stage = OBJECT_STAGE_BASES;
+			}
+			break;
+
+		case OBJECT_STAGE_HEADER_READ:
+		{
+			// Matches the layout of FieldHeader in SerialiseBinary.cpp
+			u32 name_crc = ReadScratch<u32>(m_Scratch, 0);
+			u32 version = ReadScratch<u32>(m_Scratch, 4);
+			u32 data_size = ReadScratch<u32>(m_Scratch, 8);
+
+			const Field* field = object_type->FindField(Name(name_crc));
+			if (field && field->m_Version == version && field->IsInProfile(m_Profile))
+			{
+				frame.m_FieldEnd = m_Position + data_size;
+				frame.m_Stage = OBJECT_STAGE_FIELD_END;
+				PushField(object, *field);
+			}
+			else
+			{
+				// Field not found, version mismatch or excluded by the profile
+				m_SkipLeft = data_size;
+				frame.m_Stage = OBJECT_STAGE_NEXT_HEADER;
+			}
+			break;
+		}
+
+		case OBJECT_STAGE_FIELD_END:
+			if (m_Position > frame.m_FieldEnd)
+			{
+				// The field overflowed into the next one and there's no way of rewinding
+				// data that has already been fed in
+				m_Status = LOAD_STATUS_ERROR;
+			}
+			else
+			{
+				// Skip anything the field didn't read
+				m_SkipLeft = frame.m_FieldEnd - m_Position;
+				frame.m_Stage = OBJECT_STAGE_NEXT_HEADER;
+			}
+			break;
+
+		case OBJECT_STAGE_BASES:
+			if (frame.m_BaseIndex < object_type->GetNbBaseTypes())
+			{
+				int base_index = frame.m_BaseIndex++;
+				PushObject((char*)object + object_type->GetBaseOffset(base_index), &object_type->GetBaseType(base_index));
+			}
+			else
+			{
+				PopFrame();
+			}
+			break;
+	}
+}
+
+
+void serialise::IncrementalLoader::StepCollection()
+{
+	Frame& frame = m_Frames.back();
+	IContainerFactory* factory = frame.m_Factory;
+
+	switch (frame.m_Stage)
+	{
+		case COLLECTION_STAGE_READ_COUNT:
+			frame.m_Stage = COLLECTION_STAGE_COUNT_READ;
+			RequestRead(m_Scratch, sizeof(int));
+			break;
+
+		case COLLECTION_STAGE_COUNT_READ:
+			frame.m_Count = ReadScratch<int>(m_Scratch, 0);
+			if (!CheckCount(frame.m_Count, factory))
+			{
+				m_Status = LOAD_STATUS_ERROR;
+				break;
+			}
+			if (Type* key_type = factory->m_KeyType)
+			{
+				// Construct a temporary for the key that lives as long as the frame
+				frame.m_Key = operator new(key_type->GetSize());
+				key_type->ConstructObject(frame.m_Key);
+			}
+			frame.m_Stage = COLLECTION_STAGE_NEXT_ELEMENT;
+			break;
+
+		case COLLECTION_STAGE_NEXT_ELEMENT:
+			if (frame.m_Index >= frame.m_Count)
+			{
+				PopFrame();
+			}
+			else if (frame.m_Key)
+			{
+				// Load the key before the value can be added
+				frame.m_Stage = COLLECTION_STAGE_KEY_LOADED;
+				PushValue(frame.m_Key, factory->m_KeyType, false, 0);
+			}
+			else
+			{
+				frame.m_Index++;
+				void* value_object = frame.m_Iterator->AddEmpty();
+				PushValue(value_object, factory->m_ValueType, factory->m_ValueIsPointer, 0);
+			}
+			break;
+
+		case COLLECTION_STAGE_KEY_LOADED:
+		{
+			frame.m_Index++;
+			frame.m_Stage = COLLECTION_STAGE_NEXT_ELEMENT;
+			void* value_object = frame.m_Iterator->AddEmpty(frame.m_Key);
+			PushValue(value_object, factory->m_ValueType, factory->m_ValueIsPointer, 0);
+			break;
+		}
+	}
+}
+
+
+bool serialise::IncrementalLoader::RunCustomLoad(const char*& data, u32& size)
+{
+	u32 nb_accumulated = (u32)m_CustomData.size();
+	if (nb_accumulated + size < m_CustomNeeded)
+	{
+		// The last attempt read further than this so there's no point trying again yet
+		m_CustomData.insert(m_CustomData.end(), data, data + size);
+		m_Position += size;
+		data += size;
+		size = 0;
+		return false;
+	}
+
+	// Try the load directly on the input if nothing has been accumulated yet
+	const char* load_data = data;
+	u32 load_size = size;
+	if (nb_accumulated)
+	{
+		m_CustomData.insert(m_CustomData.end(), data, data + size);
+		load_data = &m_CustomData[0];
+		load_size = (u32)m_CustomData.size();
+
+		// Undo whatever the failed attempt did to the object
+		if (m_CustomType)
+		{
+			m_CustomType->DestructObject(m_CustomObject);
+			m_CustomType->ConstructObject(m_CustomObject);
+		}
+	}
+
+	MemoryInputStream stream(load_data, load_size);
+	m_CustomLoad(stream, 0, m_CustomObject);
+
+	if (stream.fail())
+	{
+		// Failing anywhere other than the end of the data means the data is bad
+		if (!stream.eof())
+		{
+			m_Status = LOAD_STATUS_ERROR;
+			return false;
+		}
+
+		// Ran out of data so hold on to what's arrived and wait for more
+		if (!nb_accumulated)
+		{
+			m_CustomData.insert(m_CustomData.end(), data, data + size);
+		}
+		size_t requested_end = stream.GetRequestedEnd();
+		m_CustomNeeded = requested_end > load_size ? (u32)requested_end : load_size + 1;
+		m_Position += size;
+		data += size;
+		size = 0;
+		return false;
+	}
+
+	// Everything accumulated was needed by previous attempts, so only the
+	// remainder of what was read comes from the new data
+	u32 nb_read = (u32)stream.tellg() - nb_accumulated;
+	m_Position += nb_read;
+	data += nb_read;
+	size -= nb_read;
+
+	m_CustomLoad = 0;
+	m_CustomObject = 0;
+	m_CustomType = 0;
+	m_CustomData.clear();
+	m_CustomNeeded = 0;
+	return true;
+}
+
+
+bool serialise::IncrementalLoader::CheckCount(int count, IContainerFactory* factory) const
+{
+	if (count < 0)
+		return false;
+
+	// The innermost IFFV field being loaded or the end of the object limits what's left
+	u32 end = m_End;
+	for (size_t i = m_Frames.size(); i-- > 0; )
+	{
+		const Frame& frame = m_Frames[i];
+		if (frame.m_Kind == Frame::KIND_OBJECT && frame.m_Stage == OBJECT_STAGE_FIELD_END)
+		{
+			end = frame.m_FieldEnd;
+			break;
+		}
+	}
+	if (end == 0)
+		return true;
+
+	// Values that could be written in nothing are still limited to one per byte, the same as
+	// LoadBinaryBounded. IFFV objects can have fields left out.
+	u32 value_size = 0;
+	if (m_Method == SERIALISE_METHOD_BINARY)
+	{
+		value_size = factory->m_ValueIsPointer ? 0 : factory->m_ValueType->GetMinBinarySize(m_Profile);
+		if (Type* key_type = factory->m_KeyType)
+			value_size += factory->m_KeyIsPointer ? 0 : key_type->GetMinBinarySize(m_Profile);
+	}
+	u32 remaining = end > m_Position ? end - m_Position : 0;
+	return (unsigned __int64)count * (value_size ? value_size : 1) <= remaining;
+}
+
+
+void serialise::IncrementalLoader::PushObject(void* object, const Type* object_type)
+{
+	Frame frame;
+	frame.m_Kind = Frame::KIND_OBJECT;
+	frame.m_Stage = m_Method == SERIALISE_METHOD_BINARY_IFFV ? OBJECT_STAGE_READ_NB_FIELDS : OBJECT_STAGE_FIELDS;
+	frame.m_Object = object;
+	frame.m_Type = object_type;
+	frame.m_Field = object_type->GetProfileFields(m_Profile).begin();
+	frame.m_NbFieldsLeft = 0;
+	frame.m_FieldEnd = 0;
+	frame.m_BaseIndex = 0;
+	frame.m_Factory = 0;
+	frame.m_Iterator = 0;
+	frame.m_Key = 0;
+	frame.m_Count = 0;
+	frame.m_Index = 0;
+	m_Frames.push_back(frame);
+}
+
+
+void serialise::IncrementalLoader::PushCollection(void* object, IContainerFactory* factory)
+{
+	Frame frame;
+	frame.m_Kind = Frame::KIND_COLLECTION;
+	frame.m_Stage = COLLECTION_STAGE_READ_COUNT;
+	frame.m_Object = object;
+	frame.m_Type = 0;
+	frame.m_NbFieldsLeft = 0;
+	frame.m_FieldEnd = 0;
+	frame.m_BaseIndex = 0;
+	frame.m_Factory = factory;
+	frame.m_Key = 0;
+	frame.m_Count = 0;
+	frame.m_Index = 0;
+
+	// The iterator has to outlive this call so can't be allocated on the stack
+	frame.m_Iterator = factory->ConstructContainer(operator new(factory->GetWriteIteratorSize()), object);
+	m_Frames.push_back(frame);
+}
+
+
+void serialise::IncrementalLoader::PushField(void* object, const Field& field)
+{
+	void* field_data = (char*)object + field.m_Offset;
+
+	if (SerialiseLoadFunc load_func = field.m_Serialisers.m_LoadFuncs[m_Method])
+	{
+		m_CustomLoad = load_func;
+		m_CustomObject = field_data;
+		m_CustomType = field.m_IsPointer ? 0 : field.m_Type;
+	}
+
+	else
+	{
+		PushValue(field_data, field.m_Type, field.m_IsPointer, field.m_ContainerFactory);
+	}
+}
+
+
+void serialise::IncrementalLoader::PushValue(void* object, const Type* object_type, bool is_pointer, IContainerFactory* factory)
+{
+	// Mirrors the branches of LoadObject in SerialiseBinary.cpp
+
+	if (is_pointer)
+	{
+		// TODO: read CRC and lookup object
+	}
+
+	else if (SerialiseLoadFunc load = object_type->GetSerialisers().m_LoadFuncs[m_Method])
+	{
+		m_CustomLoad = load;
+		m_CustomObject = object;
+		m_CustomType = object_type;
+	}
+
+	else if (factory)
+	{
+		PushCollection(object, factory);
+	}
+
+	else if (object_type->GetFields().empty())
+	{
+		// Straight read of PODs, directly from the input
+		// TODO: endian-ness
+		RequestRead(object, object_type->GetSize());
+	}
+
+	else
+	{
+		PushObject(object, object_type);
+	}
+}
+
+
+void serialise::IncrementalLoader::PopFrame()
+{
+	Frame& frame = m_Frames.back();
+
+	if (frame.m_Kind == Frame::KIND_COLLECTION)
+	{
+		if (frame.m_Key)
+		{
+			frame.m_Factory->m_KeyType->DestructObject(frame.m_Key);
+			operator delete(frame.m_Key);
+		}
+
+		frame.m_Factory->DestructIterator(frame.m_Iterator);
+		operator delete(frame.m_Iterator);
+	}
+
+	m_Frames.pop_back();
+}
+
+
+void serialise::IncrementalLoader::RequestRead(void* dest, u32 size)
+{
+	m_ReadDest = (char*)dest;
+	m_ReadLeft = size;
+}
\ No newline at end of file
@@ -0,0 +1,564 @@
+
+#include <rflb/SerialisePacked.h>
+#include <rflb/SerialiseBinary.h>
+#include <rflb/Type.h>
+#include <rflb/Field.h>
+#include <iostream>
+#include <cmath>
+
+using namespace rflb;
+
+
+namespace
+{
+	typedef unsigned __int64 u64;
+
+
+	inline u64 GetMask(u32 nb_bits)
+	{
+		return nb_bits >= 64 ? ~(u64)0 : ((u64)1 << nb_bits) - 1;
+	}
+
+
+	// Accumulates bits, lowest first, and writes them to the stream buffer a word at a time
+	class BitWriter
+	{
+	public:
+		BitWriter(std::ostream& stream)
+			: m_Stream(stream)
+			, m_Bits(0)
+			, m_NbBits(0)
+		{
+		}
+
+		void Write(u64 value, u32 nb_bits)
+		{
+			// Keeps the accumulator within 64 bits
+			if (nb_bits > 32)
+			{
+				Write(value & 0xFFFFFFFF, 32);
+				Write(value >> 32, nb_bits - 32);
+				return;
+			}
+
+			m_Bits |= (value & GetMask(nb_bits)) << m_NbBits;
+			m_NbBits += nb_bits;
+			if (m_NbBits >= 32)
+			{
+				// TODO: endian-ness
+				u32 word = (u32)m_Bits;
+				Put(&word, sizeof(word));
+				m_Bits >>= 32;
+				m_NbBits -= 32;
+			}
+		}
+
+		void WriteBytes(const void* data, u32 size)
+		{
+			if ((m_NbBits & 7) == 0)
+			{
+				// On a byte boundary so the bytes can go straight to the stream
+				Align();
+				Put(data, size);
+			}
+			else
+			{
+				for (u32 i = 0; i < size; i++)
+					Write(((const unsigned char*)data)[i], 8);
+			}
+		}
+
+		// Writes any pending bits, padding to the next byte boundary
+		void Align()
+		{
+			while (m_NbBits)
+			{
+				unsigned char byte = (unsigned char)m_Bits;
+				Put(&byte, 1);
+				m_Bits >>= 8;
+				m_NbBits = m_NbBits > 8 ? m_NbBits - 8 : 0;
+			}
+			m_Bits = 0;
+		}
+
+	private:
+		void Put(const void* data, u32 size)
+		{
+			if (m_Stream.rdbuf()->sputn((const char*)data, size) != (std::streamsize)size)
+				m_Stream.setstate(std::ios_base::badbit);
+		}
+
+		std::ostream& m_Stream;
+		u64 m_Bits;
+		u32 m_NbBits;
+	};
+
+
+	// Reads bytes only as they're needed, so that the stream is never read beyond the last bit used
+	class BitReader
+	{
+	public:
+		BitReader(std::istream& stream)
+			: m_Stream(stream)
+			, m_Bits(0)
+			, m_NbBits(0)
+		{
+		}
+
+		u64 Read(u32 nb_bits)
+		{
+			if (nb_bits > 32)
+			{
+				u64 low = Read(32);
+				return low | (Read(nb_bits - 32) << 32);
+			}
+
+			while (m_NbBits < nb_bits)
+			{
+				int byte = m_Stream.rdbuf()->sbumpc();
+				if (byte == std::char_traits<char>::eof())
+				{
+					m_Stream.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+					byte = 0;
+				}
+				m_Bits |= (u64)(unsigned char)byte << m_NbBits;
+				m_NbBits += 8;
+			}
+
+			u64 value = m_Bits & GetMask(nb_bits);
+			m_Bits >>= nb_bits;
+			m_NbBits -= nb_bits;
+			return value;
+		}
+
+		void ReadBytes(void* data, u32 size)
+		{
+			// No bits left over means the reader is on a byte boundary
+			if (m_NbBits == 0)
+			{
+				if (m_Stream.rdbuf()->sgetn((char*)data, size) != (std::streamsize)size)
+					m_Stream.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+			}
+			else
+			{
+				for (u32 i = 0; i < size; i++)
+					((unsigned char*)data)[i] = (unsigned char)Read(8);
+			}
+		}
+
+		// Discards the padding bits of the current byte
+		void Align()
+		{
+			m_Bits = 0;
+			m_NbBits = 0;
+		}
+
+	private:
+		std::istream& m_Stream;
+		u64 m_Bits;
+		u32 m_NbBits;
+	};
+
+
+	template <typename TYPE> void WriteValues(BitWriter& writer, const TYPE* values, int count, NumericKind kind, const FieldPacking& packing)
+	{
+		u32 nb_bits = packing.m_NbBits;
+
+		if (kind == NUMERIC_FLOAT)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				// Round to the nearest step, with NaNs going to the minimum
+				double value = (double)values[i];
+				value = value > packing.m_Max ? packing.m_Max : value;
+				double steps = floor((value - packing.m_Min) / packing.m_Step + 0.5);
+				writer.Write(steps > 0 ? (u64)steps : 0, nb_bits);
+			}
+		}
+
+		else if (packing.m_Step == 0)
+		{
+			for (int i = 0; i < count; i++)
+				writer.Write((u64)(__int64)values[i], nb_bits);
+		}
+
+		else
+		{
+			__int64 min = packing.m_RangeMin;
+			__int64 max = packing.m_RangeMax;
+			for (int i = 0; i < count; i++)
+			{
+				__int64 value = (__int64)values[i];
+				value = value < min ? min : value > max ? max : value;
+				writer.Write((u64)(value - min), nb_bits);
+			}
+		}
+	}
+
+
+	template <typename TYPE> void ReadValues(BitReader& reader, TYPE* values, int count, NumericKind kind, const FieldPacking& packing)
+	{
+		u32 nb_bits = packing.m_NbBits;
+
+		if (kind == NUMERIC_FLOAT)
+		{
+			for (int i = 0; i < count; i++)
+				values[i] = (TYPE)(packing.m_Min + (double)reader.Read(nb_bits) * packing.m_Step);
+		}
+
+		else if (packing.m_Step == 0)
+		{
+			u64 sign_bit = (u64)1 << (nb_bits - 1);
+			for (int i = 0; i < count; i++)
+			{
+				u64 bits = reader.Read(nb_bits);
+				if (kind == NUMERIC_SIGNED && (bits & sign_bit))
+					bits |= ~GetMask(nb_bits);
+				values[i] = (TYPE)(__int64)bits;
+			}
+		}
+
+		else
+		{
+			__int64 min = packing.m_RangeMin;
+			for (int i = 0; i < count; i++)
+				values[i] = (TYPE)(min + (__int64)reader.Read(nb_bits));
+		}
+	}
+
+
+	// Dispatch to the kernel for the value type once for all values
+	void WritePacked(BitWriter& writer, const void* values, int count, const Type* type, const FieldPacking& packing)
+	{
+		NumericKind kind = type->GetNumericKind();
+		int size = type->GetSize();
+		RFLB_ASSERT(kind != NUMERIC_NONE);
+		RFLB_ASSERT(kind != NUMERIC_FLOAT || packing.m_Step > 0);
+
+		if (kind == NUMERIC_FLOAT)
+		{
+			if (size == sizeof(float))
+				WriteValues(writer, (const float*)values, count, kind, packing);
+			else
+				WriteValues(writer, (const double*)values, count, kind, packing);
+		}
+
+		else if (kind == NUMERIC_SIGNED)
+		{
+			switch (size)
+			{
+				case 1: WriteValues(writer, (const signed char*)values, count, kind, packing); break;
+				case 2: WriteValues(writer, (const short*)values, count, kind, packing); break;
+				case 4: WriteValues(writer, (const int*)values, count, kind, packing); break;
+				default: WriteValues(writer, (const __int64*)values, count, kind, packing); break;
+			}
+		}
+
+		else
+		{
+			switch (size)
+			{
+				case 1: WriteValues(writer, (const unsigned char*)values, count, kind, packing); break;
+				case 2: WriteValues(writer, (const unsigned short*)values, count, kind, packing); break;
+				case 4: WriteValues(writer, (const unsigned int*)values, count, kind, packing); break;
+				default: WriteValues(writer, (const unsigned __int64*)values, count, kind, packing); break;
+			}
+		}
+	}
+
+
+	void ReadPacked(BitReader& reader, void* values, int count, const Type* type, const FieldPacking& packing)
+	{
+		NumericKind kind = type->GetNumericKind();
+		int size = type->GetSize();
+		RFLB_ASSERT(kind != NUMERIC_NONE);
+
+		if (kind == NUMERIC_FLOAT)
+		{
+			if (size == sizeof(float))
+				ReadValues(reader, (float*)values, count, kind, packing);
+			else
+				ReadValues(reader, (double*)values, count, kind, packing);
+		}
+
+		else if (kind == NUMERIC_SIGNED)
+		{
+			switch (size)
+			{
+				case 1: ReadValues(reader, (signed char*)values, count, kind, packing); break;
+				case 2: ReadValues(reader, (short*)values, count, kind, packing); break;
+				case 4: ReadValues(reader, (int*)values, count, kind, packing); break;
+				default: ReadValues(reader, (__int64*)values, count, kind, packing); break;
+			}
+		}
+
+		else
+		{
+			switch (size)
+			{
+				case 1: ReadValues(reader, (unsigned char*)values, count, kind, packing); break;
+				case 2: ReadValues(reader, (unsigned short*)values, count, kind, packing); break;
+				case 4: ReadValues(reader, (unsigned int*)values, count, kind, packing); break;
+				default: ReadValues(reader, (unsigned __int64*)values, count, kind, packing); break;
+			}
+		}
+	}
+
+
+	// Containers with keys, pointers or custom serialised values are left to the binary serialiser
+	bool IsPackedContainer(const IContainerFactory* factory)
+	{
+		const Serialisers& serialisers = factory->m_ValueType->GetSerialisers();
+		return !factory->m_KeyType &&
+			!factory->m_ValueIsPointer &&
+			!serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY] &&
+			!serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY];
+	}
+
+
+	void SaveObject(BitWriter& writer, std::ostream& stream, const void* object, const Type* object_type, u32 profile);
+
+
+	void SaveValue(BitWriter& writer, std::ostream& stream, const void* object, const Type* object_type, u32 profile)
+	{
+		if (SerialiseSaveFunc save = object_type->GetSerialisers().m_SaveFuncs[SERIALISE_METHOD_BINARY])
+		{
+			writer.Align();
+			save(stream, 0, object);
+		}
+
+		else if (object_type->GetFields().empty())
+		{
+			// TODO: endian-ness
+			writer.WriteBytes(object, object_type->GetSize());
+		}
+
+		else
+		{
+			SaveObject(writer, stream, object, object_type, profile);
+		}
+	}
+
+
+	void SaveValues(BitWriter& writer, std::ostream& stream, const void* container, const Field& field, u32 profile)
+	{
+		IContainerFactory* factory = field.m_ContainerFactory;
+		const Type* value_type = factory->m_ValueType;
+		const FieldPacking& packing = field.m_Packing;
+
+		IReadIterator* iterator = RFLB_NEW_TEMP_READ_ITERATOR(factory, container);
+		int count = iterator->GetCount();
+
+		// Arrays always have the same length
+		if (!factory->m_IsInline)
+			writer.Write(count, 32);
+
+		if (count && factory->m_IsContiguous && packing.m_NbBits)
+		{
+			WritePacked(writer, iterator->GetValue(), count, value_type, packing);
+		}
+
+		else if (count && factory->m_IsContiguous && value_type->GetFields().empty())
+		{
+			writer.WriteBytes(iterator->GetValue(), count * value_type->GetSize());
+		}
+
+		else
+		{
+			for (; iterator->IsValid(); iterator->MoveNext())
+			{
+				if (packing.m_NbBits)
+					WritePacked(writer, iterator->GetValue(), 1, value_type, packing);
+				else
+					SaveValue(writer, stream, iterator->GetValue(), value_type, profile);
+			}
+		}
+
+		RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+	}
+
+
+	void SaveField(BitWriter& writer, std::ostream& stream, const void* object, const Field& field, u32 profile)
+	{
+		const void* field_data = (const char*)object + field.m_Offset;
+		IContainerFactory* factory = field.m_ContainerFactory;
+
+		// Pointers aren't written, the same as the binary serialiser
+		if (field.m_IsPointer)
+			return;
+
+		if (SerialiseSaveFunc save_func = field.m_Serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY])
+		{
+			writer.Align();
+			save_func(stream, 0, field_data);
+		}
+
+		else if (!factory || field.m_Type->GetSerialisers().m_SaveFuncs[SERIALISE_METHOD_BINARY])
+		{
+			if (field.m_Packing.m_NbBits)
+				WritePacked(writer, field_data, 1, field.m_Type, field.m_Packing);
+			else
+				SaveValue(writer, stream, field_data, field.m_Type, profile);
+		}
+
+		else if (IsPackedContainer(factory))
+		{
+			SaveValues(writer, stream, field_data, field, profile);
+		}
+
+		else
+		{
+			writer.Align();
+			serialise::SaveBinaryField(stream, object, field, 0, profile);
+		}
+	}
+
+
+	void SaveObject(BitWriter& writer, std::ostream& stream, const void* object, const Type* object_type, u32 profile)
+	{
+		const FieldList& fields = object_type->GetProfileFields(profile);
+		for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			SaveField(writer, stream, object, **i, profile);
+		}
+
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			SaveObject(writer, stream, (const char*)object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i), profile);
+		}
+	}
+
+
+	void LoadObject(BitReader& reader, std::istream& stream, void* object, const Type* object_type, u32 profile);
+
+
+	void LoadValue(BitReader& reader, std::istream& stream, void* object, const Type* object_type, u32 profile)
+	{
+		if (SerialiseLoadFunc load = object_type->GetSerialisers().m_LoadFuncs[SERIALISE_METHOD_BINARY])
+		{
+			reader.Align();
+			load(stream, 0, object);
+		}
+
+		else if (object_type->GetFields().empty())
+		{
+			reader.ReadBytes(object, object_type->GetSize());
+		}
+
+		else
+		{
+			LoadObject(reader, stream, object, object_type, profile);
+		}
+	}
+
+
+	void LoadValues(BitReader& reader, std::istream& stream, void* container, const Field& field, u32 profile)
+	{
+		IContainerFactory* factory = field.m_ContainerFactory;
+		const Type* value_type = factory->m_ValueType;
+		const FieldPacking& packing = field.m_Packing;
+
+		int count = factory->m_IsInline ?
+			field.m_Type->GetSize() / value_type->GetSize() :
+			(int)reader.Read(32);
+
+		IWriteIterator* iterator = RFLB_NEW_TEMP_WRITE_ITERATOR(factory, container);
+		iterator->Reserve(count);
+
+		if (count && factory->m_IsContiguous && (packing.m_NbBits || value_type->GetFields().empty()))
+		{
+			// Construct all values up front, which are contiguous once reserved
+			char* values = 0;
+			for (int i = 0; i < count; i++)
+			{
+				void* value_object = iterator->AddEmpty();
+				if (i == 0)
+					values = (char*)value_object;
+			}
+
+			if (packing.m_NbBits)
+				ReadPacked(reader, values, count, value_type, packing);
+			else
+				reader.ReadBytes(values, count * value_type->GetSize());
+		}
+
+		else
+		{
+			for (int i = 0; i < count; i++)
+			{
+				void* value_object = iterator->AddEmpty();
+				if (packing.m_NbBits)
+					ReadPacked(reader, value_object, 1, value_type, packing);
+				else
+					LoadValue(reader, stream, value_object, value_type, profile);
+			}
+		}
+
+		RFLB_DELETE_TEMP_ITERATOR(factory, iterator);
+	}
+
+
+	void LoadField(BitReader& reader, std::istream& stream, void* object, const Field& field, u32 profile)
+	{
+		void* field_data = (char*)object + field.m_Offset;
+		IContainerFactory* factory = field.m_ContainerFactory;
+
+		if (field.m_IsPointer)
+			return;
+
+		if (SerialiseLoadFunc load_func = field.m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY])
+		{
+			reader.Align();
+			load_func(stream, 0, field_data);
+		}
+
+		else if (!factory || field.m_Type->GetSerialisers().m_LoadFuncs[SERIALISE_METHOD_BINARY])
+		{
+			if (field.m_Packing.m_NbBits)
+				ReadPacked(reader, field_data, 1, field.m_Type, field.m_Packing);
+			else
+				LoadValue(reader, stream, field_data, field.m_Type, profile);
+		}
+
+		else if (IsPackedContainer(factory))
+		{
+			LoadValues(reader, stream, field_data, field, profile);
+		}
+
+		else
+		{
+			reader.Align();
+			serialise::LoadBinaryField(stream, object, field, 0, profile);
+		}
+	}
+
+
+	void LoadObject(BitReader& reader, std::istream& stream, void* object, const Type* object_type, u32 profile)
+	{
+		const FieldList& fields = object_type->GetProfileFields(profile);
+		for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+		{
+			LoadField(reader, stream, object, **i, profile);
+		}
+
+		for (int i = 0; i < object_type->GetNbBaseTypes(); i++)
+		{
+			LoadObject(reader, stream, (char*)object + object_type->GetBaseOffset(i), &object_type->GetBaseType(i), profile);
+		}
+	}
+}
+
+
+void serialise::LoadPacked(std::istream& stream, void* object, const rflb::Type* object_type, u32 profile)
+{
+	BitReader reader(stream);
+	LoadObject(reader, stream, object, object_type, profile);
+}
+
+
+void serialise::SavePacked(std::ostream& stream, const void* object, const rflb::Type* object_type, u32 profile)
+{
+	BitWriter writer(stream);
+	SaveObject(writer, stream, object, object_type, profile);
+	writer.Align();
+}
\ No newline at end of file
@@ -1,14 +1,88 @@
 
 #include <rflb/Type.h>
 #include <rflb/Field.h>
+#include <rflb/Copy.h>
 #include <rflb/Utils.h>
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+	struct FieldLess
+	{
+		bool operator () (const std::pair<u32, rflb::Field>& a, const std::pair<u32, rflb::Field>& b) const
+		{
+			return a.first < b.first;
+		}
+		bool operator () (const std::pair<u32, rflb::Field>& a, u32 crc) const
+		{
+			return a.first < crc;
+		}
+		bool operator () (u32 crc, const std::pair<u32, rflb::Field>& b) const
+		{
+			return crc < b.first;
+		}
+	};
+
+
+	// Copy plans flatten embedded types so any change to a type invalidates all of them
+	u32 g_CopyPlanGeneration = 0;
+
+
+	void AddFlattenedFields(std::vector<rflb::Field>& fields, const rflb::Type& type, u32 offset)
+	{
+		const rflb::Fields& type_fields = type.GetFields();
+		for (rflb::Fields::const_iterator i = type_fields.begin(); i != type_fields.end(); ++i)
+		{
+			fields.push_back(i->second);
+			fields.back().m_Offset += offset;
+		}
+
+		for (int i = 0; i < type.GetNbBaseTypes(); i++)
+		{
+			AddFlattenedFields(fields, type.GetBaseType(i), offset + type.GetBaseOffset(i));
+		}
+	}
+
+
+	const rflb::internal::CopyPlan& GetPlan(rflb::internal::CopyPlan*& plan, const rflb::Type& type, rflb::internal::PlanUse use, u32 profile = rflb::PROFILE_ALL)
+	{
+		if (plan == 0 || plan->m_Generation != g_CopyPlanGeneration)
+		{
+			delete plan;
+			plan = new rflb::internal::CopyPlan;
+			plan->m_Generation = g_CopyPlanGeneration;
+			rflb::internal::BuildCopyPlan(*plan, type, use, profile);
+		}
+
+		return *plan;
+	}
+}
 
 
 rflb::Type::Type(const TypeInfo& type_info) :
 	m_Name(type_info.m_Name),
 	m_Size(type_info.m_Size),
+	m_Alignment(type_info.m_Alignment),
 	m_Constructor(type_info.m_Constructor),
 	m_Destructor(type_info.m_Destructor),
+	m_Assign(type_info.m_Assign),
+	m_Swap(type_info.m_Swap),
+	m_ArrayConstructor(type_info.m_ArrayConstructor),
+	m_ArrayDestructor(type_info.m_ArrayDestructor),
+	m_IsPOD(type_info.m_IsPOD),
+	m_NumericKind(type_info.m_NumericKind),
+	m_CustomCopy(0),
+	m_CustomEqual(0),
+	m_CustomHash(0),
+	m_CustomMeasure(0),
+	m_CopyPlan(0),
+	m_ComparePlan(0),
+	m_DefaultObject(0),
+	m_FlattenedGeneration(g_CopyPlanGeneration - 1),
+	m_GeneratedLoad(0),
+	m_GeneratedSave(0),
 	m_NbBaseTypes(0)
 {
 }
@@ -16,16 +90,16 @@ rflb::Type::Type(const TypeInfo& type_info) :
 
 const rflb::Field& rflb::Type::GetField(const Name& name) const
 {
-	Fields::const_iterator it = m_Fields.find(name.m_CRC);
-	RFLB_ASSERT(it != m_Fields.end());
-	return it->second;
+	const Field* field = FindField(name);
+	RFLB_ASSERT(field != 0);
+	return *field;
 }
 
 
 const rflb::Field* rflb::Type::FindField(const Name& name) const
 {
-	Fields::const_iterator it = m_Fields.find(name.m_CRC);
-	if (it == m_Fields.end())
+	Fields::const_iterator it = std::lower_bound(m_Fields.begin(), m_Fields.end(), name.m_CRC, FieldLess());
+	if (it == m_Fields.end() || it->first != name.m_CRC)
 		return 0;
 	return &it->second;
 }
@@ -34,14 +108,118 @@ const rflb::Field* rflb::Type::FindField(const Name& name) const
 void rflb::Type::SetFields(const FieldInfo* fields, int nb_fields, TypeDatabase& type_db)
 {
 	m_Fields.clear();
+	m_Fields.reserve(nb_fields);
+	m_ProfileFields.clear();
+	ResetCopyPlan();
 
 	// Create each field from the field infos provided
 	for (int i = 0; i < nb_fields; i++)
 	{
-		const FieldInfo& field_info = fields[i];
-		Field field = Field(field_info, type_db);
-		m_Fields[field.m_Name.m_CRC] = field;
+		Field field(fields[i], type_db);
+		m_Fields.push_back(std::make_pair(field.m_Name.m_CRC, field));
+	}
+
+	SortFields();
+}
+
+
+void rflb::Type::SetFields(const StaticFieldInfo* fields, int nb_fields, TypeDatabase& type_db)
+{
+	m_Fields.clear();
+	m_Fields.reserve(nb_fields);
+	m_ProfileFields.clear();
+	ResetCopyPlan();
+
+	for (int i = 0; i < nb_fields; i++)
+	{
+		Field field(fields[i], type_db);
+		m_Fields.push_back(std::make_pair(field.m_Name.m_CRC, field));
+	}
+
+	SortFields();
+}
+
+
+void rflb::Type::SortFields()
+{
+	// Serialisers visit fields in this order so it can't depend on registration order
+	std::sort(m_Fields.begin(), m_Fields.end(), FieldLess());
+
+	// Two field names with the same CRC would be indistinguishable
+	for (size_t i = 1; i < m_Fields.size(); i++)
+	{
+		RFLB_ASSERT(m_Fields[i - 1].first != m_Fields[i].first);
+	}
+}
+
+
+const rflb::FieldList& rflb::Type::GetProfileFields(u32 profile) const
+{
+	std::map<u32, FieldList>::iterator it = m_ProfileFields.find(profile);
+	if (it != m_ProfileFields.end())
+		return it->second;
+
+	FieldList& fields = m_ProfileFields[profile];
+	for (Fields::const_iterator i = m_Fields.begin(); i != m_Fields.end(); ++i)
+	{
+		if (i->second.IsInProfile(profile))
+			fields.push_back(&i->second);
 	}
+	return fields;
+}
+
+
+const rflb::FieldList& rflb::Type::GetFlattenedFields(u32 profile) const
+{
+	// Base types can change after the list is built so it's rebuilt along with the copy plans
+	if (m_FlattenedGeneration != g_CopyPlanGeneration)
+	{
+		m_FlattenedFields.clear();
+		m_FlattenedProfileFields.clear();
+		m_MinBinarySizes.clear();
+		AddFlattenedFields(m_FlattenedFields, *this, 0);
+		m_FlattenedGeneration = g_CopyPlanGeneration;
+	}
+
+	std::map<u32, FieldList>::iterator it = m_FlattenedProfileFields.find(profile);
+	if (it != m_FlattenedProfileFields.end())
+		return it->second;
+
+	FieldList& fields = m_FlattenedProfileFields[profile];
+	for (std::vector<Field>::const_iterator i = m_FlattenedFields.begin(); i != m_FlattenedFields.end(); ++i)
+	{
+		if (i->IsInProfile(profile))
+			fields.push_back(&*i);
+	}
+	return fields;
+}
+
+
+u32 rflb::Type::GetMinBinarySize(u32 profile) const
+{
+	if (m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY])
+		return 0;
+	if (m_Fields.empty())
+		return m_Size;
+
+	// Getting the fields first clears the sizes if they're out of date
+	const FieldList& fields = GetFlattenedFields(profile);
+	std::map<u32, u32>::iterator it = m_MinBinarySizes.find(profile);
+	if (it != m_MinBinarySizes.end())
+		return it->second;
+
+	// Custom serialisers and pointers could write nothing
+	u32 size = 0;
+	for (FieldList::const_iterator i = fields.begin(); i != fields.end(); ++i)
+	{
+		const Field& field = **i;
+		if (field.m_IsPointer || field.m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY])
+			continue;
+		size += field.m_ContainerFactory ? sizeof(int) : field.m_Type->GetMinBinarySize(profile);
+	}
+
+	m_MinBinarySizes[profile] = size;
+	return size;
 }
 
 
@@ -49,6 +227,9 @@ rflb::Type& rflb::Type::LoadSaveBinary(SerialiseLoadFunc load, SerialiseSaveFunc
 {
 	m_Serialisers.m_LoadFuncs[SERIALISE_METHOD_BINARY] = load;
 	m_Serialisers.m_SaveFuncs[SERIALISE_METHOD_BINARY] = save;
+
+	// Presence plans depend on which types have binary serialisers
+	ResetCopyPlan();
 	return *this;
 }
 
@@ -69,21 +250,128 @@ rflb::Type& rflb::Type::LoadSaveTextXML(SerialiseLoadFunc load, SerialiseSaveFun
 }
 
 
-rflb::Type& rflb::Type::Inherits(Type& base)
+rflb::Type& rflb::Type::GeneratedBinary(SerialiseLoadFunc load, SerialiseSaveFunc save)
+{
+	m_GeneratedLoad = load;
+	m_GeneratedSave = save;
+	return *this;
+}
+
+
+rflb::Type& rflb::Type::CustomCopy(CustomCopyFunc copy)
+{
+	m_CustomCopy = copy;
+	ResetCopyPlan();
+	return *this;
+}
+
+
+rflb::Type& rflb::Type::CustomCompare(CustomEqualFunc equal, CustomHashFunc hash)
+{
+	m_CustomEqual = equal;
+	m_CustomHash = hash;
+	ResetCopyPlan();
+	return *this;
+}
+
+
+rflb::Type& rflb::Type::CustomMeasure(CustomMeasureFunc measure)
 {
+	m_CustomMeasure = measure;
+	return *this;
+}
+
+
+rflb::Type& rflb::Type::Inherits(Type& base, u32 offset)
+{
+	ResetCopyPlan();
 	RFLB_ASSERT(m_NbBaseTypes < MAX_BASE_TYPES);
-	m_BaseTypes[m_NbBaseTypes++] = &base;
+	m_BaseTypes[m_NbBaseTypes] = &base;
+	m_BaseOffsets[m_NbBaseTypes++] = offset;
 	return *this;
 }
 
 
-void rflb::Type::ConstructObject(void* object)
+void rflb::Type::ConstructObject(void* object) const
 {
 	m_Constructor(object);
 }
 
 
-void rflb::Type::DestructObject(void* object)
+void rflb::Type::DestructObject(void* object) const
 {
 	m_Destructor(object);
+}
+
+
+void rflb::Type::AssignObject(void* dst, const void* src) const
+{
+	m_Assign(dst, src);
+}
+
+
+void rflb::Type::SwapObjects(void* a, void* b) const
+{
+	m_Swap(a, b);
+}
+
+
+void rflb::Type::ConstructArray(void* objects, int count) const
+{
+	if (!m_IsPOD)
+		m_ArrayConstructor(objects, count);
+}
+
+
+void rflb::Type::DestructArray(void* objects, int count) const
+{
+	if (!m_IsPOD)
+		m_ArrayDestructor(objects, count);
+}
+
+
+const rflb::internal::CopyPlan& rflb::Type::GetCopyPlan() const
+{
+	return GetPlan(m_CopyPlan, *this, internal::PLAN_USE_COPY);
+}
+
+
+const rflb::internal::CopyPlan& rflb::Type::GetComparePlan() const
+{
+	return GetPlan(m_ComparePlan, *this, internal::PLAN_USE_COMPARE);
+}
+
+
+const rflb::internal::CopyPlan& rflb::Type::GetPresencePlan(u32 profile) const
+{
+	return GetPlan(m_PresencePlans[profile], *this, internal::PLAN_USE_PRESENCE, profile);
+}
+
+
+const void* rflb::Type::GetDefaultObject() const
+{
+	// Never destructed as types live for the lifetime of their database. Zeroed first so that
+	// anything the constructor doesn't initialise is the same in every process.
+	if (m_DefaultObject == 0)
+	{
+		m_DefaultObject = operator new(m_Size);
+		memset(m_DefaultObject, 0, m_Size);
+		ConstructObject(m_DefaultObject);
+	}
+	return m_DefaultObject;
+}
+
+
+void rflb::Type::ResetCopyPlan()
+{
+	delete m_CopyPlan;
+	delete m_ComparePlan;
+	m_CopyPlan = 0;
+	m_ComparePlan = 0;
+	for (std::map<u32, internal::CopyPlan*>::iterator i = m_PresencePlans.begin(); i != m_PresencePlans.end(); ++i)
+	{
+		delete i->second;
+	}
+	m_PresencePlans.clear();
+	g_CopyPlanGeneration++;
 }
\ No newline at end of file
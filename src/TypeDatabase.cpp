@@ -1,6 +1,7 @@
 
 #include <rflb/TypeDatabase.h>
 #include <rflb/Type.h>
+#include <rflb/Field.h>
 
 
 rflb::Type& rflb::TypeDatabase::GetType(const TypeInfo& type_info)
@@ -22,3 +23,35 @@ const rflb::Type& rflb::TypeDatabase::GetType(const TypeInfo& type_info) const
 	RFLB_ASSERT(it != m_Types.end());
 	return *it->second;
 }
+
+
+void rflb::TypeDatabase::GetTypes(std::vector<const Type*>& types) const
+{
+	for (std::map<u32, Type*>::const_iterator i = m_Types.begin(); i != m_Types.end(); ++i)
+	{
+		types.push_back(i->second);
+	}
+}
+
+
+
+rflb::IContainerFactory* rflb::TypeDatabase::GetContainerFactory(const TypeInfo& type_info, internal::CreateContainerFactoryFunc create)
+{
+	// Pointers to containers aren't treated as containers
+	if (type_info.m_IsPointer)
+		return 0;
+
+	std::map<u32, IContainerFactory*>::const_iterator it = m_ContainerFactories.find(type_info.m_Name.m_CRC);
+	if (it != m_ContainerFactories.end())
+		return it->second;
+
+	// Non-containers are also cached to skip the call next time
+	TypeInfo key_type, value_type;
+	IContainerFactory* factory = create(key_type, value_type);
+	if (factory)
+	{
+		internal::ResolveContainerTypes(factory, key_type, value_type, *this);
+	}
+	m_ContainerFactories[type_info.m_Name.m_CRC] = factory;
+	return factory;
+}
\ No newline at end of file
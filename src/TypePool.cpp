@@ -0,0 +1,109 @@
+
+#include <rflb/TypePool.h>
+#include <rflb/Type.h>
+
+
+rflb::TypePool::TypePool(const Type* type, int nb_objects_per_slab)
+	: m_Type(type)
+	, m_ObjectSize(0)
+	, m_Alignment(type->GetAlignment())
+	, m_NbObjectsPerSlab(nb_objects_per_slab > 0 ? nb_objects_per_slab : 1)
+	, m_Next(0)
+	, m_End(0)
+	, m_FreeList(0)
+{
+	// Freed objects store a pointer to the next so must be able to hold one
+	if (m_Alignment < (int)sizeof(void*))
+		m_Alignment = sizeof(void*);
+	int size = type->GetSize() > (int)sizeof(void*) ? type->GetSize() : (int)sizeof(void*);
+	m_ObjectSize = (size + m_Alignment - 1) & ~(m_Alignment - 1);
+}
+
+
+rflb::TypePool::~TypePool()
+{
+	for (size_t i = 0; i < m_Slabs.size(); i++)
+	{
+		operator delete(m_Slabs[i]);
+	}
+}
+
+
+void* rflb::TypePool::New()
+{
+	void* object;
+	if (m_FreeList)
+	{
+		object = m_FreeList;
+		m_FreeList = *(void**)object;
+	}
+	else
+	{
+		object = Allocate(1);
+	}
+
+	m_Type->ConstructObject(object);
+	return object;
+}
+
+
+void rflb::TypePool::Delete(void* object)
+{
+	m_Type->DestructObject(object);
+	*(void**)object = m_FreeList;
+	m_FreeList = object;
+}
+
+
+void* rflb::TypePool::NewArray(int count)
+{
+	// Freed objects aren't necessarily adjacent so arrays always come from slab space
+	char* objects = Allocate(GetNbSlots(count));
+	m_Type->ConstructArray(objects, count);
+	return objects;
+}
+
+
+void rflb::TypePool::DeleteArray(void* objects, int count)
+{
+	// Arrays of types smaller than a pointer are packed tighter than single objects
+	m_Type->DestructArray(objects, count);
+	for (int i = 0; i < GetNbSlots(count); i++)
+	{
+		void* object = (char*)objects + i * m_ObjectSize;
+		*(void**)object = m_FreeList;
+		m_FreeList = object;
+	}
+}
+
+
+int rflb::TypePool::GetNbSlots(int count) const
+{
+	return (count * m_Type->GetSize() + m_ObjectSize - 1) / m_ObjectSize;
+}
+
+
+char* rflb::TypePool::Allocate(int nb_slots)
+{
+	if (m_End - m_Next < nb_slots * m_ObjectSize)
+	{
+		// Any space left at the end of the current slab is kept for single objects
+		while (m_End - m_Next >= m_ObjectSize)
+		{
+			*(void**)m_Next = m_FreeList;
+			m_FreeList = m_Next;
+			m_Next += m_ObjectSize;
+		}
+
+		// Over-allocate so that the slab can be aligned beyond what the heap guarantees
+		int slab_size = nb_slots > m_NbObjectsPerSlab ? nb_slots : m_NbObjectsPerSlab;
+		char* slab = (char*)operator new(slab_size * m_ObjectSize + m_Alignment - 1);
+		m_Slabs.push_back(slab);
+		m_Next = (char*)(((size_t)slab + m_Alignment - 1) & ~(size_t)(m_Alignment - 1));
+		m_End = m_Next + slab_size * m_ObjectSize;
+	}
+
+	char* slots = m_Next;
+	m_Next += nb_slots * m_ObjectSize;
+	return slots;
+}
\ No newline at end of file